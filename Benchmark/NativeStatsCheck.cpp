@@ -0,0 +1,322 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Check of the native correlation tests, kernel density, LOESS and rounding against R
+//
+// Author: Francois Stelluti
+//
+
+#include <RInside.h>
+
+#include "Correlation.h"
+#include "Distribution.h"
+#include "Loess.h"
+#include "SteamCsvParser.h"
+#include "SummaryStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+//Number of checks made, and of those that failed
+int g_checks = 0;
+int g_failures = 0;
+
+const char *methodName(CorrelationMethod method)
+{
+    switch (method)
+    {
+        case CorrelationMethod::Pearson:
+            return "pearson";
+        case CorrelationMethod::Spearman:
+            return "spearman";
+        case CorrelationMethod::Kendall:
+            return "kendall";
+    }
+    return "";
+}
+
+//Both NaN (R's NA), or within the tolerance relative to the larger of 1 and the value from R
+bool close(double native, double fromR, double tolerance)
+{
+    if (std::isnan(native) || std::isnan(fromR))
+        return std::isnan(native) && std::isnan(fromR);
+    if (std::isinf(native) || std::isinf(fromR))
+        return native == fromR;
+    return std::fabs(native - fromR) <= tolerance * std::max(1.0, std::fabs(fromR));
+}
+
+void check(const std::string &name, double native, double fromR, double tolerance)
+{
+    ++g_checks;
+    if (close(native, fromR, tolerance))
+        return;
+
+    ++g_failures;
+    std::cout << "FAILED " << name << ": native " << native << ", R " << fromR << std::endl;
+}
+
+void checkTrue(const std::string &name, bool passed)
+{
+    ++g_checks;
+    if (passed)
+        return;
+
+    ++g_failures;
+    std::cout << "FAILED " << name << std::endl;
+}
+
+//Copy values into an R vector, NaN becoming NA
+void assign(RInside &R, const std::string &name, const std::vector<double> &values)
+{
+    Rcpp::NumericVector vector(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i)
+        vector[i] = std::isnan(values[i]) ? NA_REAL : values[i];
+    R[name] = vector;
+}
+
+std::vector<double> evaluate(RInside &R, const std::string &expression)
+{
+    Rcpp::NumericVector result = R.parseEval(expression);
+    return std::vector<double>(result.begin(), result.end());
+}
+
+//Estimate, statistic and p-value from R, or NA where R refuses to test (fewer than 3 complete pairs for
+//Pearson, 2 for the others).
+//Spearman's statistic is R's S rather than the native t, so only its estimate and p-value are compared.
+//exact=FALSE makes R use the same normal and t approximations as the native tests
+void checkCorrelation(RInside &R, const std::string &name, const std::vector<double> &x, const std::vector<double> &y,
+                      CorrelationMethod method)
+{
+    std::string label = name + " " + methodName(method);
+    CorrelationResult native = correlationTest(method, x.data(), y.data(), x.size());
+
+    assign(R, "x", x);
+    assign(R, "y", y);
+    std::vector<double> fromR = evaluate(R,
+        std::string("tryCatch({ ct <- suppressWarnings(cor.test(x, y, method='") + methodName(method) + "', exact=FALSE));"
+        " c(sum(complete.cases(x, y)), ct$estimate, ct$statistic, ct$p.value) },"
+        " error=function(e) c(sum(complete.cases(x, y)), NA, NA, NA))");
+
+    check(label + " n", static_cast<double>(native.n), fromR[0], 0.0);
+    check(label + " estimate", native.estimate, fromR[1], 1e-9);
+    if (method != CorrelationMethod::Spearman)
+        check(label + " statistic", native.statistic, fromR[2], 1e-6);
+    check(label + " p-value", native.pValue, fromR[3], 1e-6);
+}
+
+//Density at the native grid points, at the default bandwidth and a narrower and wider one. R's default
+//bandwidth is computed from the quantiles of the values, the native one from the grid, so they are only
+//compared on enough values to agree to a percent
+void checkDensity(RInside &R, const std::string &name, const std::vector<double> &values, bool logScale)
+{
+    std::string label = name + (logScale ? " density (log)" : " density");
+    Distribution distribution(values, logScale);
+
+    std::vector<double> scaled;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        double value = Distribution::toScale(values[i], logScale);
+        if (!std::isnan(value))
+            scaled.push_back(value);
+    }
+    checkTrue(label + " count", distribution.count() == scaled.size());
+    if (scaled.empty())
+        return;
+
+    assign(R, "v", scaled);
+    if (scaled.size() >= 100)
+        check(label + " bandwidth", distribution.defaultBandwidth(), evaluate(R, "bw.nrd0(v)")[0], 0.01);
+
+    const double factors[] = {0.3, 1.0, 3.0};
+    for (int f = 0; f < 3; ++f) {
+        double bandwidth = distribution.defaultBandwidth() * factors[f];
+        std::vector<double> native;
+        distribution.density(bandwidth, native);
+
+        std::ostringstream expression;
+        expression.precision(17);
+        expression << "density(v, bw=" << bandwidth << ", n=" << kDensityPoints
+                   << ", from=" << distribution.lo() << ", to=" << distribution.hi() << ")$y";
+        std::vector<double> fromR = evaluate(R, expression.str());
+
+        //Both bin the values linearly, on grids of different steps, so they are compared relative to the peak
+        double peak = *std::max_element(fromR.begin(), fromR.end());
+        double worst = 0.0;
+        for (std::size_t i = 0; i < native.size() && i < fromR.size(); ++i)
+            worst = std::max(worst, std::fabs(native[i] - fromR[i]));
+
+        std::ostringstream factor;
+        factor << " x" << factors[f];
+        checkTrue(label + factor.str() + " points", native.size() == fromR.size());
+        check(label + factor.str() + " worst difference / peak", worst / peak, 0.0, 0.01);
+    }
+}
+
+//Fit at evenly spaced points over the range of x, against R's loess with the same span and degree. R's
+//default surface interpolates between fits at the vertices of a k-d tree, surface='direct' fits at every
+//point as the native code does
+void checkLoess(RInside &R, const std::string &name, const std::vector<double> &xValues,
+                const std::vector<double> &yValues)
+{
+    std::vector<double> x, y;
+    for (std::size_t i = 0; i < xValues.size(); ++i) {
+        if (!std::isnan(xValues[i]) && !std::isnan(yValues[i])) {
+            x.push_back(xValues[i]);
+            y.push_back(yValues[i]);
+        }
+    }
+    if (x.size() < 5)
+        return;
+
+    double lo = *std::min_element(x.begin(), x.end()), hi = *std::max_element(x.begin(), x.end());
+    double yRange = *std::max_element(y.begin(), y.end()) - *std::min_element(y.begin(), y.end());
+    std::vector<double> at(50);
+    for (std::size_t i = 0; i < at.size(); ++i)
+        at[i] = lo + (hi - lo) * i / (at.size() - 1);
+
+    for (int degree = 1; degree <= 2; ++degree) {
+        std::vector<double> native = loessFit(x.data(), y.data(), x.size(), at.data(), at.size(), 0.75, degree);
+
+        assign(R, "x", x);
+        assign(R, "y", y);
+        assign(R, "at", at);
+        std::ostringstream expression;
+        expression << "suppressWarnings(predict(loess(y ~ x, span=0.75, degree=" << degree
+                   << ", family='gaussian', control=loess.control(surface='direct')), data.frame(x=at)))";
+        std::vector<double> fromR = evaluate(R, expression.str());
+
+        std::ostringstream label;
+        label << name << " loess degree " << degree;
+        double worst = 0.0;
+        for (std::size_t i = 0; i < at.size(); ++i)
+            worst = std::max(worst, std::isnan(native[i]) != std::isnan(fromR[i]) ? 1.0 : std::fabs(native[i] - fromR[i]));
+        check(label.str() + " worst difference / range of y", yRange > 0.0 ? worst / yRange : worst, 0.0, 1e-6);
+    }
+}
+
+//Rounding of the displayed values, against R's round(): ties of exact halves, and decimals that are stored a
+//little over or under a half
+void checkRounding(RInside &R)
+{
+    std::vector<double> values = {0.5, 1.5, 2.5, -2.5, 0.125, 0.375, 0.15, 0.25, 0.35, 0.45, 1.005, 1.115, 2.675,
+                                  5.015, 9.995, 0.285, 123.456, 125.0, 0.1234567, 1e300};
+    assign(R, "v", values);
+    for (int digits = -1; digits <= 3; ++digits) {
+        std::ostringstream expression;
+        expression << "round(v, " << digits << ")";
+        std::vector<double> fromR = evaluate(R, expression.str());
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            std::ostringstream name;
+            name.precision(17);
+            name << "round(" << values[i] << ", " << digits << ")";
+            check(name.str(), roundTo(values[i], digits), fromR[i], 0.0);
+        }
+    }
+}
+
+//Columns of a SteamSpy file, as the application reads them
+void checkFile(RInside &R, const std::string &file)
+{
+    SteamGameTable table;
+    SteamCsvParser parser;
+    parser.parseFile(file, table);
+    std::cout << file << ", " << table.size() << " rows" << std::endl;
+
+    std::vector<std::vector<double> > columns(kNumGameColumns, std::vector<double>(table.size()));
+    for (int c = 0; c < kNumGameColumns; ++c)
+        table.copyColumn(static_cast<GameColumn>(c), columns[c].data(), 1.0, kNaN);
+
+    //Every pair of columns, which has ties in all of them and N/A pairs wherever a score is missing
+    for (int a = 0; a < kNumGameColumns; ++a) {
+        for (int b = a + 1; b < kNumGameColumns; ++b) {
+            std::string name = file + " " + gameColumnName(static_cast<GameColumn>(a)) + "/"
+                             + gameColumnName(static_cast<GameColumn>(b));
+            checkCorrelation(R, name, columns[a], columns[b], CorrelationMethod::Pearson);
+            checkCorrelation(R, name, columns[a], columns[b], CorrelationMethod::Spearman);
+            checkCorrelation(R, name, columns[a], columns[b], CorrelationMethod::Kendall);
+        }
+    }
+
+    for (int c = 0; c < kNumGameColumns; ++c) {
+        std::string name = file + " " + gameColumnName(static_cast<GameColumn>(c));
+        checkDensity(R, name, columns[c], false);
+        checkDensity(R, name, columns[c], true);
+    }
+
+    checkLoess(R, file + " Price/Userscore", columns[static_cast<int>(GameColumn::Price)],
+               columns[static_cast<int>(GameColumn::Userscore)]);
+    checkLoess(R, file + " Userscore/Metascore", columns[static_cast<int>(GameColumn::Userscore)],
+               columns[static_cast<int>(GameColumn::Metascore)]);
+}
+
+//Small inputs made to hit the edge cases: ties in one or both variables, N/A pairs, and fewer than 3 pairs
+void checkEdgeCases(RInside &R)
+{
+    std::cout << "Edge cases" << std::endl;
+
+    std::vector<double> tiedX = {1, 2, 2, 3, 4, 4, 4, 5, 6, 6};
+    std::vector<double> tiedY = {2, 1, 3, 3, 5, 4, 5, 6, 6, 6};
+    std::vector<double> missingX = {1, kNaN, 3, 4, 5, 6, 7, 8, kNaN, 10};
+    std::vector<double> missingY = {3, 1, kNaN, 2, 5, 5, 8, 7, 9, kNaN};
+    std::vector<double> twoX = {1, 2, kNaN, 4};
+    std::vector<double> twoY = {2, 1, 3, kNaN};
+
+    const CorrelationMethod methods[] = {CorrelationMethod::Pearson, CorrelationMethod::Spearman, CorrelationMethod::Kendall};
+    for (int m = 0; m < 3; ++m) {
+        checkCorrelation(R, "ties", tiedX, tiedY, methods[m]);
+        checkCorrelation(R, "N/A pairs", missingX, missingY, methods[m]);
+        checkCorrelation(R, "two complete pairs", twoX, twoY, methods[m]);
+        checkCorrelation(R, "one pair", std::vector<double>(1, 1.0), std::vector<double>(1, 2.0), methods[m]);
+
+        //Every value tied: no correlation can be computed
+        checkCorrelation(R, "constant x", std::vector<double>(5, 1.0), tiedY, methods[m]);
+    }
+
+    checkDensity(R, "ties", tiedX, false);
+    checkDensity(R, "N/A", missingX, false);
+    checkDensity(R, "N/A", missingX, true);
+
+    //A single value is a single kernel, and no value no density
+    Distribution single(std::vector<double>(1, 5.0), false);
+    std::vector<double> density;
+    single.density(0.1, density);
+    checkTrue("one value density points", density.size() == kDensityPoints && single.count() == 1);
+    Distribution empty(std::vector<double>(3, kNaN), false);
+    empty.density(0.1, density);
+    checkTrue("no value density", empty.count() == 0 && density.empty());
+
+    checkLoess(R, "ties", tiedX, tiedY);
+    checkLoess(R, "N/A pairs", missingX, missingY);
+
+    //Too few points for R's loess, the native fit falls back to the mean of the points
+    double lineX[] = {1.0, 3.0}, lineY[] = {2.0, 6.0}, at[] = {2.0};
+    check("two point loess", loessFit(lineX, lineY, 2, at, 1)[0], 4.0, 1e-12);
+    checkTrue("no point loess", std::isnan(loessFit(lineX, lineY, 0, at, 1)[0]));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cout << "Usage: NativeStatsCheck <SteamSpy csv file>..." << std::endl;
+        return 1;
+    }
+
+    RInside R(argc, argv);
+
+    checkEdgeCases(R);
+    checkRounding(R);
+    for (int i = 1; i < argc; ++i)
+        checkFile(R, argv[i]);
+
+    std::cout << g_checks - g_failures << " of " << g_checks << " checks agree with R" << std::endl;
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+## -*- mode: Makefile; c-indent-level: 4; c-basic-offset: 4;  tab-width: 8; -*-
+##
+## Check of the native correlation tests, kernel density, LOESS and rounding against R
+##
+## Author: Francois Stelluti
+
+TEMPLATE = 		app
+TARGET = 		NativeStatsCheck
+CONFIG += 		console c++11
+CONFIG -= 		app_bundle
+QT -= 			gui
+
+INCLUDEPATH += 		../Source
+HEADERS = \
+    ../Source/SteamGameTable.h \
+    ../Source/SteamCsvParser.h \
+    ../Source/SummaryStats.h \
+    ../Source/GameFilter.h \
+    ../Source/Correlation.h \
+    ../Source/Distribution.h \
+    ../Source/Loess.h
+SOURCES = \
+    NativeStatsCheck.cpp \
+    ../Source/SteamGameTable.cpp \
+    ../Source/SteamCsvParser.cpp \
+    ../Source/SummaryStats.cpp \
+    ../Source/GameFilter.cpp \
+    ../Source/Correlation.cpp \
+    ../Source/Distribution.cpp \
+    ../Source/Loess.cpp
+
+## R, Rcpp and RInside settings, the same as for the application
+R_HOME = 		$$system(R RHOME)
+RCPPFLAGS = 		$$system($$R_HOME/bin/R CMD config --cppflags)
+RLDFLAGS = 		$$system($$R_HOME/bin/R CMD config --ldflags)
+RBLAS = 		$$system($$R_HOME/bin/R CMD config BLAS_LIBS)
+RLAPACK = 		$$system($$R_HOME/bin/R CMD config LAPACK_LIBS)
+RCPPINCL = 		$$system($$R_HOME/bin/Rscript -e \"Rcpp:::CxxFlags\(\)\")
+RCPPLIBS = 		$$system($$R_HOME/bin/Rscript -e \"Rcpp:::LdFlags\(\)\")
+RINSIDEINCL = 		$$system($$R_HOME/bin/Rscript -e \"RInside:::CxxFlags\(\)\")
+RINSIDELIBS = 		$$system($$R_HOME/bin/Rscript -e \"RInside:::LdFlags\(\)\")
+
+QMAKE_CXXFLAGS +=	$$RCPPFLAGS $$RCPPINCL $$RINSIDEINCL
+QMAKE_LIBS +=           $$RLDFLAGS $$RBLAS $$RLAPACK $$RINSIDELIBS $$RCPPLIBS
@@ -0,0 +1,393 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Benchmark of every stage of the application (ingest, statistics, indexes, correlation, rendering) on synthetic data
+//
+// Author: Francois Stelluti
+//
+
+#include "SyntheticData.h"
+
+#include "Bootstrap.h"
+#include "CatalogueLoader.h"
+#include "Correlation.h"
+#include "CorrelationMatrix.h"
+#include "Distribution.h"
+#include "GameIndex.h"
+#include "GameJoin.h"
+#include "GroupBy.h"
+#include "NameDictionary.h"
+#include "PlotData.h"
+#include "ScatterPlot.h"
+#include "SteamCsvParser.h"
+#include "SummaryStats.h"
+#include "TableSnapshot.h"
+#include "ThreadPool.h"
+#include "YearStats.h"
+
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//Timings of one stage at one size
+struct StageResult
+{
+    QString stage;
+    std::vector<double> milliseconds;       //One per iteration
+};
+
+//Run a stage the given number of times, timing each run on its own
+StageResult timeStage(const QString &stage, int iterations, const std::function<void()> &body)
+{
+    StageResult result;
+    result.stage = stage;
+    for (int i = 0; i < iterations; ++i) {
+        Clock::time_point start = Clock::now();
+        body();
+        result.milliseconds.push_back(millisecondsSince(start));
+    }
+    return result;
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    std::size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+QJsonObject toJson(const StageResult &result, std::size_t rows)
+{
+    QJsonArray runs;
+    for (std::size_t i = 0; i < result.milliseconds.size(); ++i)
+        runs.append(result.milliseconds[i]);
+
+    double best = *std::min_element(result.milliseconds.begin(), result.milliseconds.end());
+
+    QJsonObject object;
+    object["stage"] = result.stage;
+    object["min_ms"] = best;
+    object["median_ms"] = median(result.milliseconds);
+    object["rows_per_second"] = best > 0.0 ? rows / (best / 1000.0) : 0.0;
+    object["runs_ms"] = runs;
+    return object;
+}
+
+//Values are kept here after each stage, so that the compiler can't drop the work
+volatile double g_sink;
+
+//Each of the resamples of a bootstrap is a pass over every row. Fewer resamples are drawn of larger inputs,
+//but they are only timed up to a full catalogue
+const std::size_t kMaxBootstrapRows = 1000000;
+
+std::vector<StageResult> benchmarkSize(std::size_t rows, int iterations, uint64_t seed, const QDir &directory,
+                                       QJsonObject &checks)
+{
+    std::vector<StageResult> results;
+    std::string csv = directory.filePath(QString("%1_SteamStats.csv").arg(rows)).toStdString();
+    std::string snapshot = snapshotPath(csv);
+
+    //Generated once, it is the input of everything else
+    results.push_back(timeStage("generate", 1, [&]() { writeSyntheticCsv(csv, rows, seed); }));
+    checks["csv_bytes"] = static_cast<double>(QFileInfo(QString::fromStdString(csv)).size());
+
+    SteamGameTable table;
+    SteamCsvParser parser;
+    results.push_back(timeStage("ingest_csv", iterations, [&]() {
+        parser.reset();
+        parser.parseFile(csv, table);
+    }));
+
+    //Every synthetic row must be read, otherwise the timings aren't of the real work
+    if (table.size() != rows || parser.skippedRows() != 0)
+        throw std::runtime_error("Parsed " + std::to_string(table.size()) + " of " + std::to_string(rows) +
+                                 " rows, skipped " + std::to_string(parser.skippedRows()));
+
+    //The same file split into chunks and parsed on every thread, as a catalogue of exports is
+    results.push_back(timeStage("ingest_catalogue", iterations, [&]() {
+        std::shared_ptr<SteamGameTable> catalogue = loadCatalogue(std::vector<std::string>(1, csv), ThreadPool::global());
+        if (catalogue->size() != rows)
+            throw std::runtime_error("Loaded " + std::to_string(catalogue->size()) + " of " + std::to_string(rows) +
+                                     " rows as a catalogue");
+    }));
+
+    //The same with 1, 2, 4... threads up to the number of cores, to see how loading a catalogue scales
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        ThreadPool pool(threads - 1);
+        results.push_back(timeStage(QString("ingest_catalogue_%1_threads").arg(threads), iterations, [&]() {
+            if (loadCatalogue(std::vector<std::string>(1, csv), pool)->size() != rows)
+                throw std::runtime_error("Loaded a catalogue of the wrong size with " + std::to_string(threads) + " threads");
+        }));
+    }
+
+    SnapshotSource source;
+    if (!snapshotSource(csv, source))
+        throw std::runtime_error("Unable to read " + csv);
+    results.push_back(timeStage("snapshot_write", iterations, [&]() { writeSnapshot(snapshot, table, source); }));
+    results.push_back(timeStage("snapshot_map", iterations, [&]() {
+        std::shared_ptr<const SteamGameTable> mapped = mapSnapshot(snapshot, &source);
+        if (!mapped || mapped->size() != rows)
+            throw std::runtime_error("Unable to map " + snapshot);
+    }));
+
+    YearStats stats = computeYearStats(summarizeTable(table));
+    checks["avg_price"] = stats.avgPrice;
+    checks["max_price"] = stats.maxPrice;
+    checks["avg_metascore"] = stats.avgMetascore;
+    checks["total_playtime"] = stats.totalPlaytime;
+
+    results.push_back(timeStage("summary", iterations, [&]() {
+        g_sink = computeYearStats(summarizeTable(table)).avgPrice;
+    }));
+    results.push_back(timeStage("summary_scalar", iterations, [&]() {
+        g_sink = computeYearStats(summarizeTableScalar(table)).avgPrice;
+    }));
+
+    //Built once per year; the queries of the top games panel are then answered from it
+    std::shared_ptr<GameIndex> index;
+    results.push_back(timeStage("index_build", iterations, [&]() {
+        index = std::make_shared<GameIndex>(table, ThreadPool::global());
+    }));
+    std::vector<uint32_t> topRows;
+    results.push_back(timeStage("top_n", iterations, [&]() {
+        index->topRows(table, GameColumn::Owners, 50, true, 0, topRows);
+        g_sink = index->percentile(table, GameColumn::Price, 0.5, 0);
+    }));
+    results.push_back(timeStage("name_lookup", iterations, [&]() {
+        index->findName(table, "game 12", 50, 0, topRows);
+        g_sink = static_cast<double>(topRows.size());
+    }));
+
+    //Owners by release month, with each strategy
+    results.push_back(timeStage("group_by_hash", iterations, [&]() {
+        g_sink = groupBy(table, GroupKey::ReleaseMonth, GameColumn::Owners, 0, ThreadPool::global(),
+                         GroupStrategy::Hash).front().sum;
+    }));
+    results.push_back(timeStage("group_by_sort", iterations, [&]() {
+        g_sink = groupBy(table, GroupKey::ReleaseMonth, GameColumn::Owners, 0, ThreadPool::global(),
+                         GroupStrategy::Sort).front().sum;
+    }));
+
+    //Names interned into a new dictionary each time, so that every name is added rather than found
+    results.push_back(timeStage("intern_names", iterations, [&]() {
+        NameDictionary dictionary;
+        std::shared_ptr<std::vector<uint32_t> > ids = dictionary.internTable(table);
+        g_sink = static_cast<double>(dictionary.size());
+    }));
+    NameDictionary dictionary;
+    std::shared_ptr<const std::vector<uint32_t> > nameIds = dictionary.internTable(table);
+
+    //Four years of the same games, so that every game is in the cohort
+    std::vector<JoinYear> years;
+    std::shared_ptr<const SteamGameTable> joined = std::make_shared<SteamGameTable>(table);
+    for (int year = 2012; year <= 2015; ++year) {
+        JoinYear joinYear;
+        joinYear.year = year;
+        joinYear.table = joined;
+        joinYear.nameIds = nameIds;
+        years.push_back(joinYear);
+    }
+    std::vector<GameChange> changes;
+    results.push_back(timeStage("join_years", iterations, [&]() {
+        GameJoin join(years, ThreadPool::global());
+        join.changes(GameColumn::Owners, 0, years.size() - 1, changes);
+        g_sink = static_cast<double>(join.numGames() + changes.size());
+    }));
+
+    //The plot variables of the default plot, converted the same way as in the window
+    std::vector<double> x, y;
+    results.push_back(timeStage("plot_values", iterations, [&]() {
+        getPlotValues(table, GameColumn::Price, x);
+        getPlotValues(table, GameColumn::Playtime, y);
+    }));
+
+    //Binned once per variable and scale, then convolved again for every bandwidth
+    Distribution distribution;
+    results.push_back(timeStage("distribution_bin", iterations, [&]() { distribution = Distribution(x, true); }));
+    std::vector<double> density;
+    results.push_back(timeStage("distribution_density", iterations, [&]() {
+        distribution.density(distribution.defaultBandwidth(), density);
+        g_sink = density[0];
+    }));
+
+    const CorrelationMethod methods[] = {CorrelationMethod::Pearson, CorrelationMethod::Spearman, CorrelationMethod::Kendall};
+    const char *methodNames[] = {"correlation_pearson", "correlation_spearman", "correlation_kendall"};
+    for (int m = 0; m < 3; ++m) {
+        results.push_back(timeStage(methodNames[m], iterations, [&]() {
+            g_sink = correlationTest(methods[m], x.data(), y.data(), rows).estimate;
+        }));
+    }
+
+    //The intervals of the window: the correlation of the owners, drawn around their estimates, and playtime,
+    //by Pearson and by rank, and the total owners with only the estimates drawn, with the resamples the window
+    //draws for this many rows
+    if (rows <= kMaxBootstrapRows) {
+        std::vector<double> owners, ownerErrors;
+        getPlotValues(table, GameColumn::Owners, owners);
+        getPlotValues(table, GameColumn::OwnersError, ownerErrors);
+        results.push_back(timeStage("bootstrap", iterations, [&]() {
+            g_sink = bootstrapCorrelation(CorrelationMethod::Pearson, owners.data(), ownerErrors.data(), y.data(), 0,
+                                          rows, BootstrapOptions(), ThreadPool::global()).lower;
+        }));
+        results.push_back(timeStage("bootstrap_spearman", iterations, [&]() {
+            g_sink = bootstrapCorrelation(CorrelationMethod::Spearman, owners.data(), ownerErrors.data(), y.data(), 0,
+                                          rows, BootstrapOptions(), ThreadPool::global()).lower;
+        }));
+
+        BootstrapOptions ownerOptions;
+        ownerOptions.resampleRows = false;
+        results.push_back(timeStage("bootstrap_owners", iterations, [&]() {
+            g_sink = ownerIntervals(owners.data(), ownerErrors.data(), rows, ownerOptions, ThreadPool::global()).total.lower;
+        }));
+    }
+
+    YearTables tables;
+    tables.push_back(std::make_pair(2015, std::make_shared<SteamGameTable>(table)));
+    std::vector<GameColumn> columns;
+    for (int c = 0; c <= static_cast<int>(GameColumn::OwnersError); ++c)
+        columns.push_back(static_cast<GameColumn>(c));
+    results.push_back(timeStage("correlation_matrix", iterations, [&]() {
+        g_sink = CorrelationMatrix::compute(tables, columns, ThreadPool::global()).at(0, 0, 1).estimate;
+    }));
+
+    //Preparing the plot includes the LOESS curve; drawing is what every repaint costs
+    ScatterPlotData plot;
+    results.push_back(timeStage("render_prepare", iterations, [&]() {
+        plot = makeScatterPlot(x, y, "price", "playtime");
+    }));
+
+    QImage image(600, 500, QImage::Format_ARGB32_Premultiplied);
+    results.push_back(timeStage("render_draw", iterations, [&]() {
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        drawScatterPlot(painter, image.rect(), plot);
+    }));
+
+    QFile::remove(QString::fromStdString(snapshot));
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    //Rendering needs a GUI application, but not a display
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times every stage of SteamStats on synthetic SteamSpy data");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("rows", "Comma separated numbers of rows (up to 10000000).", "list",
+                                        "1000,10000,100000,1000000"));
+    parser.addOption(QCommandLineOption("iterations", "Runs of each stage, the minimum and median are reported.",
+                                        "n", "5"));
+    parser.addOption(QCommandLineOption("seed", "Seed of the synthetic data.", "n", "2015"));
+    parser.addOption(QCommandLineOption("label", "Name of this run in the results, e.g. a commit.", "name"));
+    parser.addOption(QCommandLineOption("output", "Write the JSON results to a file instead of stdout.", "file"));
+    parser.addOption(QCommandLineOption("keep", "Write the generated CSV files to a directory and keep them.", "dir"));
+    parser.process(app);
+
+    std::vector<std::size_t> sizes;
+    QStringList rowList = parser.value("rows").split(',', QString::SkipEmptyParts);
+    for (int i = 0; i < rowList.size(); ++i) {
+        bool ok = false;
+        qulonglong rows = rowList[i].trimmed().toULongLong(&ok);
+        if (!ok || rows == 0 || rows > 10000000) {
+            std::cerr << "Invalid number of rows: " << rowList[i].toStdString() << std::endl;
+            return 1;
+        }
+        sizes.push_back(static_cast<std::size_t>(rows));
+    }
+
+    int iterations = std::max(1, parser.value("iterations").toInt());
+    uint64_t seed = parser.value("seed").toULongLong();
+
+    QTemporaryDir temporary;
+    QDir directory(parser.isSet("keep") ? parser.value("keep") : temporary.path());
+    if (!directory.mkpath(".")) {
+        std::cerr << "Unable to create " << directory.path().toStdString() << std::endl;
+        return 1;
+    }
+
+    QJsonArray runs;
+    for (std::size_t s = 0; s < sizes.size(); ++s) {
+        QJsonObject checks;
+        std::vector<StageResult> results;
+        try {
+            results = benchmarkSize(sizes[s], iterations, seed, directory, checks);
+        }
+        catch (std::exception &e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+            return 2;
+        }
+
+        QJsonArray stages;
+        std::cerr << sizes[s] << " rows" << std::endl;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            stages.append(toJson(results[i], sizes[s]));
+            std::cerr << "  " << results[i].stage.toStdString() << ": "
+                      << *std::min_element(results[i].milliseconds.begin(), results[i].milliseconds.end())
+                      << " ms (median " << median(results[i].milliseconds) << " ms)" << std::endl;
+        }
+
+        QJsonObject run;
+        run["rows"] = static_cast<double>(sizes[s]);
+        run["checks"] = checks;
+        run["stages"] = stages;
+        runs.append(run);
+    }
+
+    //Enough about the machine and the run to compare results between commits
+    QJsonObject report;
+    report["benchmark"] = QString("SteamStatsBench");
+    report["label"] = parser.value("label");
+    report["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["cpu"] = QSysInfo::currentCpuArchitecture();
+    report["os"] = QSysInfo::prettyProductName();
+    report["threads"] = static_cast<int>(ThreadPool::global().size());
+    report["iterations"] = iterations;
+    report["seed"] = QString::number(seed);
+    report["runs"] = runs;
+
+    QByteArray json = QJsonDocument(report).toJson();
+    if (!parser.isSet("output")) {
+        std::cout << json.constData();
+        return 0;
+    }
+
+    QFile output(parser.value("output"));
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate) || output.write(json) != json.size()) {
+        std::cerr << "Unable to write " << parser.value("output").toStdString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+## -*- mode: Makefile; c-indent-level: 4; c-basic-offset: 4;  tab-width: 8; -*-
+##
+## Benchmark of every stage of the application on synthetic SteamSpy data, without R
+##
+## Author: Francois Stelluti
+
+TEMPLATE = 		app
+TARGET = 		SteamStatsBench
+CONFIG += 		console c++11
+CONFIG -= 		app_bundle
+QT += 			gui widgets
+
+INCLUDEPATH += 		../Source
+HEADERS = \
+    SyntheticData.h \
+    ../Source/SteamGameTable.h \
+    ../Source/SteamCsvParser.h \
+    ../Source/SummaryStats.h \
+    ../Source/YearStats.h \
+    ../Source/TableSnapshot.h \
+    ../Source/CatalogueLoader.h \
+    ../Source/NameDictionary.h \
+    ../Source/GameJoin.h \
+    ../Source/Correlation.h \
+    ../Source/Bootstrap.h \
+    ../Source/CorrelationMatrix.h \
+    ../Source/ThreadPool.h \
+    ../Source/PlotData.h \
+    ../Source/Loess.h \
+    ../Source/PointDecimation.h \
+    ../Source/ScatterPlot.h \
+    ../Source/Distribution.h \
+    ../Source/PerfTrace.h \
+    ../Source/GameFilter.h \
+    ../Source/GameIndex.h \
+    ../Source/GroupBy.h
+SOURCES = \
+    SteamStatsBench.cpp \
+    SyntheticData.cpp \
+    ../Source/SteamGameTable.cpp \
+    ../Source/SteamCsvParser.cpp \
+    ../Source/SummaryStats.cpp \
+    ../Source/YearStats.cpp \
+    ../Source/TableSnapshot.cpp \
+    ../Source/CatalogueLoader.cpp \
+    ../Source/NameDictionary.cpp \
+    ../Source/GameJoin.cpp \
+    ../Source/Correlation.cpp \
+    ../Source/Bootstrap.cpp \
+    ../Source/CorrelationMatrix.cpp \
+    ../Source/ThreadPool.cpp \
+    ../Source/PlotData.cpp \
+    ../Source/Loess.cpp \
+    ../Source/PointDecimation.cpp \
+    ../Source/ScatterPlot.cpp \
+    ../Source/Distribution.cpp \
+    ../Source/PerfTrace.cpp \
+    ../Source/AllocationCounter.cpp \
+    ../Source/GameFilter.cpp \
+    ../Source/GameIndex.cpp \
+    ../Source/GroupBy.cpp
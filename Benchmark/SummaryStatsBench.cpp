@@ -0,0 +1,137 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Microbenchmark of the single pass statistics kernel against the original R statistics code
+//
+// Author: Francois Stelluti
+//
+
+#include <RInside.h>
+
+#include "SteamCsvParser.h"
+#include "SummaryStats.h"
+#include "YearStats.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//The R code previously run by SteamGameStats::getStatsByYear, one parseEval per statistic
+const std::string kPrice =
+    "SD2 <- SD; SD2$Price <- sub('$','',as.character(SD2$Price), fixed=TRUE);"
+    "SD2$Price <- sub('Free','0',as.character(SD2$Price), fixed=TRUE);"
+    "price <- as.numeric(SD2$Price); ";
+
+std::string selectElementsOfSet(const std::string &column, bool isFirst)
+{
+    std::string elementSelect = isFirst ? "TRUE,FALSE" : "FALSE,TRUE";
+    return "SD3 <- SD; SD3 <- unlist(strsplit(as.character(SD3$" + column + "), ' '));"
+           "SD3 <- SD3[c(" + elementSelect + ")];"
+           + column + " <- gsub(',','',SD3,fixed=TRUE);";
+}
+
+const std::string kNumHoursPlayed =
+    "splitPlayTimes <-unlist(strsplit(as.character(Playtime..Median.), ':'));"
+    "splitPlayTimesHour <- splitPlayTimes[c(TRUE,FALSE)];"
+    "splitPlayTimesMin <- splitPlayTimes[c(FALSE,TRUE)];"
+    "totalPlayTimesMin <- strptime(splitPlayTimesMin,'%M');"
+    "totalPlayTimes <- round((sum(totalPlayTimesMin$min)/60) + sum(as.numeric(splitPlayTimesHour)),2);";
+
+YearStats rStats(RInside &R)
+{
+    YearStats stats;
+    stats.numGames = Rcpp::as<int>(R.parseEval("nrow(SD)"));
+    stats.avgPrice = R.parseEval(kPrice + "avgPrice <- mean(price); avgPrice <- round(avgPrice, digits=2)");
+    stats.maxPrice = R.parseEval(kPrice + "maxPrice <- max(price); maxPrice <- round(maxPrice, digits=2)");
+    stats.avgMetascore = R.parseEval(selectElementsOfSet("Userscore..Metascore.", false) +
+            "avgMetascore <- gsub('\\\\(|\\\\)|\\\\%', '', Userscore..Metascore.);"
+            "avgMetascore <- round(mean(as.numeric(avgMetascore),na.rm=TRUE),2);");
+    stats.totalPlaytime = R.parseEval(selectElementsOfSet("Playtime..Median.", true) + kNumHoursPlayed);
+    return stats;
+}
+
+bool sameToDisplayedPrecision(double a, double b)
+{
+    return std::fabs(a - b) < 0.005;
+}
+
+void printStats(const char *name, const YearStats &stats, double milliseconds)
+{
+    std::cout << name << ": " << milliseconds << " ms per run"
+              << " (games " << stats.numGames << ", avg price " << stats.avgPrice
+              << ", max price " << stats.maxPrice << ", avg metascore " << stats.avgMetascore
+              << ", total playtime " << stats.totalPlaytime << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cout << "Usage: SummaryStatsBench <SteamSpy csv file> [iterations]" << std::endl;
+        return 1;
+    }
+
+    std::string file = argv[1];
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (iterations < 1)
+        iterations = 1;
+
+    RInside R(argc, argv);
+
+    //Both sides read the file once, only the statistics are timed
+    R.parseEvalQ("SD <- read.csv(\"" + file + "\", header=TRUE)");
+    SteamGameTable table;
+    SteamCsvParser parser;
+    parser.parseFile(file, table);
+
+    YearStats fromR = rStats(R);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fromR = rStats(R);
+    double rTime = millisecondsSince(start) / iterations;
+
+    //Run the native kernels enough times to get a measurable duration
+    int nativeIterations = iterations * 1000;
+    YearStats scalar = computeYearStats(summarizeTableScalar(table));
+    start = Clock::now();
+    for (int i = 0; i < nativeIterations; ++i)
+        scalar = computeYearStats(summarizeTableScalar(table));
+    double scalarTime = millisecondsSince(start) / nativeIterations;
+
+    YearStats native = computeYearStats(summarizeTable(table));
+    start = Clock::now();
+    for (int i = 0; i < nativeIterations; ++i)
+        native = computeYearStats(summarizeTable(table));
+    double nativeTime = millisecondsSince(start) / nativeIterations;
+
+    std::cout << file << ", " << table.size() << " rows" << std::endl;
+    printStats("R", fromR, rTime);
+    printStats("Scalar", scalar, scalarTime);
+    printStats("Native", native, nativeTime);
+    std::cout << "Speedup over R: " << rTime / nativeTime << "x" << std::endl;
+
+    //The displayed values must agree with the R code
+    bool same = fromR.numGames == native.numGames
+             && sameToDisplayedPrecision(fromR.avgPrice, native.avgPrice)
+             && sameToDisplayedPrecision(fromR.maxPrice, native.maxPrice)
+             && sameToDisplayedPrecision(fromR.avgMetascore, native.avgMetascore)
+             && sameToDisplayedPrecision(fromR.totalPlaytime, native.totalPlaytime);
+
+    if (!same) {
+        std::cout << "Results differ from R" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Generator of synthetic SteamSpy CSV files, for benchmarks at any size
+//
+// Author: Francois Stelluti
+//
+
+#include "SyntheticData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+const char *kMonths[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+//Append a number with thousands separators, e.g. 217,241
+void appendThousands(std::string &out, uint64_t value)
+{
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%llu", static_cast<unsigned long long>(value));
+    for (int i = 0; i < length; ++i) {
+        if (i > 0 && (length - i) % 3 == 0)
+            out += ',';
+        out += digits[i];
+    }
+}
+
+void appendScore(std::string &out, bool present, int score)
+{
+    if (!present) {
+        out += "N/A";
+        return;
+    }
+
+    char buffer[8];
+    std::snprintf(buffer, sizeof(buffer), "%d%%", score);
+    out += buffer;
+}
+
+void appendPlaytime(std::string &out, uint32_t minutes)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02u:%02u", minutes / 60, minutes % 60);
+    out += buffer;
+}
+
+} // namespace
+
+void writeSyntheticCsv(const std::string &path, std::size_t rows, uint64_t seed)
+{
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("Unable to write " + path);
+
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::lognormal_distribution<double> price(2.0, 0.8);
+    std::lognormal_distribution<double> owners(10.5, 1.6);
+    std::lognormal_distribution<double> playtime(4.5, 1.5);
+    std::normal_distribution<double> score(72.0, 12.0);
+
+    std::string out = "\"#\",\"Game\",\"Release date\",\"Price\",\"Userscore (Metascore)\",\"Owners\",\"Playtime (Median)\"";
+    out.reserve(1 << 20);
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        char buffer[64];
+        out += "\n\"";
+        std::snprintf(buffer, sizeof(buffer), "%zu", row + 1);
+        out += buffer;
+
+        //Some names need quoting: a comma, or a quote written as two
+        out += "\",\"";
+        double nameKind = uniform(random);
+        if (nameKind < 0.02)
+            out += "Game, The ";
+        else if (nameKind < 0.03)
+            out += "\"\"Quoted\"\" Game ";
+        else
+            out += "Game ";
+        std::snprintf(buffer, sizeof(buffer), "%zu", row + 1);
+        out += buffer;
+
+        out += "\",\"";
+        std::snprintf(buffer, sizeof(buffer), "%s %d, %d", kMonths[random() % 12], static_cast<int>(random() % 28 + 1),
+                      2012 + static_cast<int>(random() % 4));
+        out += buffer;
+
+        //About 6.5% of games are free, prices are capped like the most expensive real ones
+        out += "\",\"";
+        if (uniform(random) < 0.065) {
+            out += "Free";
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "$%.2f", std::min(std::floor(price(random) * 100.0) / 100.0 + 0.49, 449.99));
+            out += buffer;
+        }
+
+        //Two thirds have no score at all, the rest have one or both
+        out += "\",\"";
+        double scores = uniform(random);
+        bool hasUserscore = scores >= 0.67 && scores < 0.88;
+        bool hasMetascore = scores >= 0.80;
+        appendScore(out, hasUserscore, std::max(10, std::min(100, static_cast<int>(score(random) + 8.0))));
+        out += " (";
+        appendScore(out, hasMetascore, std::max(10, std::min(100, static_cast<int>(score(random)))));
+        out += ")";
+
+        //Owners with the sampling error after a UTF-8 '±'
+        out += "\",\"";
+        uint64_t ownerCount = static_cast<uint64_t>(std::min(owners(random), 6.0e7)) + 500;
+        appendThousands(out, ownerCount);
+        out += " \xC2\xB1";
+        appendThousands(out, static_cast<uint64_t>(std::sqrt(static_cast<double>(ownerCount)) * 30.0 + 500.0));
+
+        //Average playtime, sometimes far over 1000 hours, then the median
+        out += "\",\"";
+        uint32_t average = static_cast<uint32_t>(std::min(playtime(random), 120000.0));
+        if (uniform(random) < 0.15)
+            average = 0;
+        appendPlaytime(out, average);
+        out += " (";
+        appendPlaytime(out, static_cast<uint32_t>(average * uniform(random)));
+        out += ")\"";
+
+        //Write in large blocks
+        if (out.size() > (1 << 20) - 256) {
+            if (std::fwrite(out.data(), 1, out.size(), file) != out.size()) {
+                std::fclose(file);
+                throw std::runtime_error("Unable to write " + path);
+            }
+            out.clear();
+        }
+    }
+
+    //Like the real files, the last row has no newline
+    bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+        throw std::runtime_error("Unable to write " + path);
+}
@@ -0,0 +1,22 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Generator of synthetic SteamSpy CSV files, for benchmarks at any size
+//
+// Author: Francois Stelluti
+//
+
+#ifndef SyntheticData_H
+#define SyntheticData_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+//Write a CSV file with the same header and quirks as the files in Data/: 'Free' and '$9.89' prices,
+//'98% (N/A)' scores, '217,241 ±15,231' owners, '12:38 (04:00)' playtimes (sometimes over 1000 hours),
+//quoted names with commas and doubled quotes, and no newline after the last row.
+//The proportions of free games and missing scores follow the 2014 data. The same seed gives the same file.
+//Throws std::runtime_error if the file can't be written
+void writeSyntheticCsv(const std::string &path, std::size_t rows, uint64_t seed);
+
+#endif
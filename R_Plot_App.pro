@@ -15,10 +15,79 @@
 ## build an app based on the one headers and two source files
 TEMPLATE = 		app
 HEADERS = \
-    Source/SteamGameStats.h
+    Source/SteamGameStats.h \
+    Source/SteamGameTable.h \
+    Source/SteamCsvParser.h \
+    Source/SummaryStats.h \
+    Source/YearStats.h \
+    Source/DatasetCache.h \
+    Source/CsvFollower.h \
+    Source/Correlation.h \
+    Source/ThreadPool.h \
+    Source/CorrelationMatrix.h \
+    Source/CorrelationMatrixView.h \
+    Source/RWorker.h \
+    Source/RHelpers.h \
+    Source/Loess.h \
+    Source/ScatterPlot.h \
+    Source/Distribution.h \
+    Source/DistributionView.h \
+    Source/PointDecimation.h \
+    Source/TableSnapshot.h \
+    Source/CatalogueLoader.h \
+    Source/NameDictionary.h \
+    Source/GameJoin.h \
+    Source/YearTrends.h \
+    Source/TrendsView.h \
+    Source/GameHistoryView.h \
+    Source/PlotData.h \
+    Source/BatchMode.h \
+    Source/PerfTrace.h \
+    Source/GameFilter.h \
+    Source/FilterPanel.h \
+    Source/GameIndex.h \
+    Source/GroupBy.h \
+    Source/TopGamesPanel.h \
+    Source/GroupByPanel.h \
+    Source/Bootstrap.h
 SOURCES = \
     Source/main.cpp \
-    Source/SteamGameStats.cpp
+    Source/SteamGameStats.cpp \
+    Source/SteamGameTable.cpp \
+    Source/SteamCsvParser.cpp \
+    Source/SummaryStats.cpp \
+    Source/YearStats.cpp \
+    Source/DatasetCache.cpp \
+    Source/CsvFollower.cpp \
+    Source/Correlation.cpp \
+    Source/ThreadPool.cpp \
+    Source/CorrelationMatrix.cpp \
+    Source/CorrelationMatrixView.cpp \
+    Source/RWorker.cpp \
+    Source/RHelpers.cpp \
+    Source/Loess.cpp \
+    Source/ScatterPlot.cpp \
+    Source/Distribution.cpp \
+    Source/DistributionView.cpp \
+    Source/PointDecimation.cpp \
+    Source/TableSnapshot.cpp \
+    Source/CatalogueLoader.cpp \
+    Source/NameDictionary.cpp \
+    Source/GameJoin.cpp \
+    Source/YearTrends.cpp \
+    Source/TrendsView.cpp \
+    Source/GameHistoryView.cpp \
+    Source/PlotData.cpp \
+    Source/BatchMode.cpp \
+    Source/PerfTrace.cpp \
+    Source/AllocationCounter.cpp \
+    Source/GameFilter.cpp \
+    Source/FilterPanel.cpp \
+    Source/GameIndex.cpp \
+    Source/GroupBy.cpp \
+    Source/TopGamesPanel.cpp \
+    Source/GroupByPanel.cpp \
+    Source/Bootstrap.cpp
 
 ## beyond the default configuration, also use SVG graphics
 QT += 			svg
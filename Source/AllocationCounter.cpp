@@ -0,0 +1,53 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Replacement operator new counting the allocations of the application, for the performance counters
+//
+// Author: Francois Stelluti
+//
+
+#include "PerfTrace.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+//Constant initialized, so it can be used by allocations made before main
+std::atomic<int64_t> g_allocations(0);
+
+} // namespace
+
+int64_t countedAllocations()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+//Kept in its own file, so that the compiler never sees these inlined next to the standard library allocators
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    while (true) {
+        if (void *p = std::malloc(size ? size : 1))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
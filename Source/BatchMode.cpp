@@ -0,0 +1,449 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Headless batch mode: statistics, correlations and plots of data files from the command line
+//
+// Author: Francois Stelluti
+//
+
+#include "BatchMode.h"
+#include "Bootstrap.h"
+#include "Correlation.h"
+#include "PlotData.h"
+#include "ScatterPlot.h"
+#include "SummaryStats.h"
+#include "TableSnapshot.h"
+#include "ThreadPool.h"
+#include "YearStats.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QTextStream>
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct CorrelationRequest
+{
+    GameColumn x, y;
+    CorrelationMethod method;
+};
+
+struct PlotRequest
+{
+    GameColumn x, y;
+};
+
+struct BatchOptions
+{
+    QStringList files;
+    bool stats;
+    std::vector<CorrelationRequest> correlations;
+    std::vector<PlotRequest> plots;
+    QString format;             //json or csv
+    QString output;             //Empty for the standard output
+    QString plotDir;
+    QString plotFormat;         //svg or png
+    QSize plotSize;
+    int threads;                //0 for one per core
+    int bootstrap;              //Resamples of the confidence interval of each correlation, 0 for none
+};
+
+struct CorrelationOutput
+{
+    CorrelationRequest request;
+    CorrelationResult result;
+    ConfidenceInterval interval;    //Only computed with --bootstrap
+};
+
+//Everything computed for one file
+struct FileResult
+{
+    QString file;
+    int year;
+    bool ok;
+    QString error;
+    YearStats stats;
+    std::vector<CorrelationOutput> correlations;
+    QStringList plotFiles;
+    double milliseconds;
+};
+
+const char *methodName(CorrelationMethod method)
+{
+    switch (method)
+    {
+        case CorrelationMethod::Pearson:
+            return "pearson";
+        case CorrelationMethod::Spearman:
+            return "spearman";
+        case CorrelationMethod::Kendall:
+            return "kendall";
+    }
+
+    return "";
+}
+
+//Parse 'x:y' or 'x:y:method'. Throws std::runtime_error if it isn't valid
+void parseVariables(const QString &spec, GameColumn &x, GameColumn &y, CorrelationMethod *method)
+{
+    QStringList parts = spec.split(':');
+    if (parts.size() < 2 || parts.size() > (method ? 3 : 2) ||
+        !findPlotVariable(parts[0].toUtf8().constData(), x) ||
+        !findPlotVariable(parts[1].toUtf8().constData(), y))
+        throw std::runtime_error("Invalid variables: " + spec.toStdString());
+
+    if (!method)
+        return;
+
+    *method = CorrelationMethod::Pearson;
+    if (parts.size() == 3) {
+        QString name = parts[2].toLower();
+        if (name == "spearman")
+            *method = CorrelationMethod::Spearman;
+        else if (name == "kendall")
+            *method = CorrelationMethod::Kendall;
+        else if (name != "pearson")
+            throw std::runtime_error("Invalid correlation method: " + parts[2].toStdString());
+    }
+}
+
+BatchOptions parseOptions(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Statistics of SteamSpy data files, without a window");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("batch", "Run in batch mode."));
+    parser.addOption(QCommandLineOption("stats", "Summary statistics of each file (the default)."));
+    parser.addOption(QCommandLineOption("correlation", "Correlation test, e.g. price:userscore:kendall.", "x:y[:method]"));
+    parser.addOption(QCommandLineOption("plot", "Scatter plot, e.g. price:userscore.", "x:y"));
+    parser.addOption(QCommandLineOption("format", "Output format, json or csv.", "format", "json"));
+    parser.addOption(QCommandLineOption("output", "Output file, instead of the standard output.", "file"));
+    parser.addOption(QCommandLineOption("plot-dir", "Directory for the plots.", "dir", "."));
+    parser.addOption(QCommandLineOption("plot-format", "Plot format, svg or png.", "format", "svg"));
+    parser.addOption(QCommandLineOption("plot-size", "Plot size in pixels.", "WxH", "600x500"));
+    parser.addOption(QCommandLineOption("threads", "Number of threads, one per core by default.", "n", "0"));
+    parser.addOption(QCommandLineOption("bootstrap", "Resamples of a 95% confidence interval of each correlation, "
+                                        "including the error of the owner estimates.", "n", "0"));
+    parser.addPositionalArgument("files", "SteamSpy CSV files, or directories or wildcard patterns of exports to merge.", "<files>...");
+    parser.process(arguments);      //Exits on --help or an unknown option
+
+    BatchOptions options;
+    options.files = parser.positionalArguments();
+    options.format = parser.value("format").toLower();
+    options.output = parser.value("output");
+    options.plotDir = parser.value("plot-dir");
+    options.plotFormat = parser.value("plot-format").toLower();
+    options.threads = parser.value("threads").toInt();
+    options.bootstrap = parser.value("bootstrap").toInt();
+
+    QStringList size = parser.value("plot-size").split('x');
+    options.plotSize = size.size() == 2 ? QSize(size[0].toInt(), size[1].toInt()) : QSize();
+
+    if (options.files.isEmpty())
+        throw std::runtime_error("No data files given");
+    if (options.format != "json" && options.format != "csv")
+        throw std::runtime_error("Invalid format: " + options.format.toStdString());
+    if (options.plotFormat != "svg" && options.plotFormat != "png")
+        throw std::runtime_error("Invalid plot format: " + options.plotFormat.toStdString());
+    if (options.bootstrap < 0)
+        throw std::runtime_error("Invalid number of resamples: " + parser.value("bootstrap").toStdString());
+    if (options.plotSize.width() <= 0 || options.plotSize.height() <= 0)
+        throw std::runtime_error("Invalid plot size: " + parser.value("plot-size").toStdString());
+
+    foreach (const QString &spec, parser.values("correlation")) {
+        CorrelationRequest request;
+        parseVariables(spec, request.x, request.y, &request.method);
+        options.correlations.push_back(request);
+    }
+    foreach (const QString &spec, parser.values("plot")) {
+        PlotRequest request;
+        parseVariables(spec, request.x, request.y, 0);
+        options.plots.push_back(request);
+    }
+
+    //With nothing else asked for, give the statistics
+    options.stats = parser.isSet("stats") || (options.correlations.empty() && options.plots.empty());
+    return options;
+}
+
+//Draw a plot with the same renderer as the window, into an SVG or PNG file
+void savePlot(const ScatterPlotData &plot, const QString &path, const BatchOptions &options)
+{
+    QRect rect(QPoint(0, 0), options.plotSize);
+
+    if (options.plotFormat == "svg") {
+        QSvgGenerator generator;
+        generator.setFileName(path);
+        generator.setSize(options.plotSize);
+        generator.setViewBox(rect);
+        generator.setTitle(plot.title);
+
+        QPainter painter(&generator);
+        drawScatterPlot(painter, rect, plot);
+        if (!painter.end())
+            throw std::runtime_error("Unable to write " + path.toStdString());
+        return;
+    }
+
+    QImage image(options.plotSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    drawScatterPlot(painter, rect, plot);
+    painter.end();
+
+    if (!image.save(path, "PNG"))
+        throw std::runtime_error("Unable to write " + path.toStdString());
+}
+
+FileResult processFile(const QString &file, const BatchOptions &options, ThreadPool &pool)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    FileResult result;
+    result.file = file;
+    result.year = QFileInfo(file).fileName().section('_', 0, 0).toInt();
+    result.ok = false;
+
+    try {
+        //The same steps as the window: load (from the snapshot if possible), then summarize
+        std::shared_ptr<const SteamGameTable> table = loadTable(file.toStdString());
+        result.stats = computeYearStats(summarizeTable(*table));
+
+        std::vector<double> x, y;
+        for (std::size_t i = 0; i < options.correlations.size(); ++i) {
+            const CorrelationRequest &request = options.correlations[i];
+            getPlotValues(*table, request.x, x);
+            getPlotValues(*table, request.y, y);
+
+            CorrelationOutput output;
+            output.request = request;
+            output.result = correlationTest(request.method, x.data(), y.data(), table->size());
+
+            //Owner estimates are drawn around their value with the '±' error as well as resampled
+            if (options.bootstrap > 0) {
+                std::vector<double> xError, yError;
+                if (request.x == GameColumn::Owners)
+                    getPlotValues(*table, GameColumn::OwnersError, xError);
+                if (request.y == GameColumn::Owners)
+                    getPlotValues(*table, GameColumn::OwnersError, yError);
+
+                BootstrapOptions bootstrap;
+                bootstrap.resamples = static_cast<std::size_t>(options.bootstrap);
+                bootstrap.adaptResamples = false;
+                output.interval = bootstrapCorrelation(request.method, x.data(), xError.empty() ? 0 : xError.data(),
+                                                       y.data(), yError.empty() ? 0 : yError.data(), table->size(),
+                                                       bootstrap, pool);
+            }
+            result.correlations.push_back(output);
+        }
+
+        for (std::size_t i = 0; i < options.plots.size(); ++i) {
+            const PlotRequest &request = options.plots[i];
+            getPlotValues(*table, request.x, x);
+            getPlotValues(*table, request.y, y);
+
+            QString xName = plotVariableName(request.x);
+            QString yName = plotVariableName(request.y);
+            QString path = QDir(options.plotDir).filePath(QFileInfo(file).completeBaseName() + "_" + xName + "_" +
+                                                          yName + "." + options.plotFormat);
+
+            savePlot(makeScatterPlot(x, y, xName, yName), path, options);
+            result.plotFiles.append(path);
+        }
+
+        result.ok = true;
+    }
+    catch (std::exception &e) {
+        result.error = QString::fromStdString(e.what());
+    }
+
+    result.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return result;
+}
+
+QByteArray toJson(const std::vector<FileResult> &results, const BatchOptions &options)
+{
+    QJsonArray files;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const FileResult &result = results[i];
+        QJsonObject object;
+        object["file"] = result.file;
+        object["year"] = result.year;
+        object["milliseconds"] = result.milliseconds;
+
+        if (!result.ok) {
+            object["error"] = result.error;
+            files.append(object);
+            continue;
+        }
+
+        if (options.stats) {
+            QJsonObject stats;
+            stats["numGames"] = result.stats.numGames;
+            stats["avgPrice"] = result.stats.avgPrice;
+            stats["maxPrice"] = result.stats.maxPrice;
+            stats["avgMetascore"] = result.stats.avgMetascore;
+            stats["totalPlaytime"] = result.stats.totalPlaytime;
+            object["stats"] = stats;
+        }
+
+        QJsonArray correlations;
+        for (std::size_t c = 0; c < result.correlations.size(); ++c) {
+            const CorrelationOutput &output = result.correlations[c];
+            QJsonObject correlation;
+            correlation["x"] = QString(plotVariableName(output.request.x));
+            correlation["y"] = QString(plotVariableName(output.request.y));
+            correlation["method"] = QString(methodName(output.request.method));
+            correlation["n"] = static_cast<double>(output.result.n);
+            correlation["estimate"] = output.result.estimate;
+            correlation["statistic"] = output.result.statistic;
+            correlation["pValue"] = output.result.pValue;
+            if (options.bootstrap > 0) {
+                correlation["ciLower"] = output.interval.lower;
+                correlation["ciUpper"] = output.interval.upper;
+            }
+            correlations.append(correlation);
+        }
+        if (!correlations.isEmpty())
+            object["correlations"] = correlations;
+        if (!result.plotFiles.isEmpty())
+            object["plots"] = QJsonArray::fromStringList(result.plotFiles);
+
+        files.append(object);
+    }
+
+    return QJsonDocument(files).toJson();
+}
+
+QString csvField(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n'))
+        return value;
+
+    QString quoted = value;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+//One line per value: file,year,statistic,value
+QByteArray toCsv(const std::vector<FileResult> &results, const BatchOptions &options)
+{
+    QString csv;
+    QTextStream out(&csv);
+    out << "file,year,statistic,value\n";
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const FileResult &result = results[i];
+        QString prefix = csvField(result.file) + "," + QString::number(result.year) + ",";
+
+        if (!result.ok) {
+            out << prefix << "error," << csvField(result.error) << "\n";
+            continue;
+        }
+
+        if (options.stats) {
+            out << prefix << "numGames," << result.stats.numGames << "\n";
+            out << prefix << "avgPrice," << QString::number(result.stats.avgPrice, 'f', 2) << "\n";
+            out << prefix << "maxPrice," << QString::number(result.stats.maxPrice, 'f', 2) << "\n";
+            out << prefix << "avgMetascore," << QString::number(result.stats.avgMetascore, 'f', 2) << "\n";
+            out << prefix << "totalPlaytime," << QString::number(result.stats.totalPlaytime, 'f', 2) << "\n";
+        }
+
+        for (std::size_t c = 0; c < result.correlations.size(); ++c) {
+            const CorrelationOutput &output = result.correlations[c];
+            QString name = QString("%1_%2_%3_").arg(plotVariableName(output.request.x))
+                           .arg(plotVariableName(output.request.y)).arg(methodName(output.request.method));
+            out << prefix << name << "estimate," << QString::number(output.result.estimate, 'g', 10) << "\n";
+            out << prefix << name << "pValue," << QString::number(output.result.pValue, 'g', 10) << "\n";
+            if (options.bootstrap > 0) {
+                out << prefix << name << "ciLower," << QString::number(output.interval.lower, 'g', 10) << "\n";
+                out << prefix << name << "ciUpper," << QString::number(output.interval.upper, 'g', 10) << "\n";
+            }
+        }
+
+        foreach (const QString &plot, result.plotFiles)
+            out << prefix << "plot," << csvField(plot) << "\n";
+    }
+
+    out.flush();
+    return csv.toUtf8();
+}
+
+} // namespace
+
+bool isBatchMode(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--batch") == 0)
+            return true;
+    return false;
+}
+
+int runBatch(int argc, char *argv[])
+{
+    //Text and images are drawn with QPainter, which needs a GUI application but not a display
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    BatchOptions options;
+    try {
+        options = parseOptions(app.arguments());
+    }
+    catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!options.plots.empty() && !QDir().mkpath(options.plotDir)) {
+        std::cerr << "Unable to create " << options.plotDir.toStdString() << std::endl;
+        return 1;
+    }
+
+    //Each file is independent, process them in parallel
+    std::vector<FileResult> results(options.files.size());
+    std::unique_ptr<ThreadPool> ownPool;
+    if (options.threads > 0)
+        ownPool.reset(new ThreadPool(options.threads - 1));     //The calling thread works too
+    ThreadPool &pool = ownPool ? *ownPool : ThreadPool::global();
+
+    pool.parallelFor(results.size(), [&](std::size_t i) {
+        results[i] = processFile(options.files[static_cast<int>(i)], options, pool);
+    });
+
+    QByteArray output = options.format == "csv" ? toCsv(results, options) : toJson(results, options);
+
+    if (options.output.isEmpty()) {
+        std::cout.write(output.constData(), output.size());
+        std::cout.flush();
+    } else {
+        QFile file(options.output);
+        if (!file.open(QIODevice::WriteOnly) || file.write(output) != output.size()) {
+            std::cerr << "Unable to write " << options.output.toStdString() << std::endl;
+            return 1;
+        }
+    }
+
+    //Non-zero if any file failed
+    for (std::size_t i = 0; i < results.size(); ++i)
+        if (!results[i].ok)
+            return 2;
+    return 0;
+}
@@ -0,0 +1,25 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Headless batch mode: statistics, correlations and plots of data files from the command line
+//
+// Author: Francois Stelluti
+//
+
+#ifndef BatchMode_H
+#define BatchMode_H
+
+//True if the command line asks for batch mode (--batch)
+bool isBatchMode(int argc, char *argv[]);
+
+//Run the computations given on the command line, without a window, R or a display server,
+//and return the exit code of the application:
+//
+//  R_Plot_App --batch [--stats] [--correlation x:y[:method]]... [--plot x:y]...
+//             [--format json|csv] [--output file] [--plot-dir dir] [--plot-format svg|png]
+//             [--plot-size WxH] [--threads n] <year csv files>...
+//
+//Variables are the plot variable names (price, userscore, owners, playtime, metascore, ownersError)
+//and methods are pearson, spearman or kendall. Files are processed in parallel
+int runBatch(int argc, char *argv[]);
+
+#endif
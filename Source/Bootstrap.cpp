@@ -0,0 +1,429 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Bootstrap and Monte-Carlo confidence intervals, propagating the sampling error of the owner estimates
+//
+// Author: Francois Stelluti
+//
+
+#include "Bootstrap.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+//Resamples are drawn in blocks, each from its own random stream seeded with the seed and the block number.
+//The blocks are shared out between the threads, so the values don't depend on which thread drew them
+const std::size_t kResamplesPerBlock = 32;
+
+//Rows drawn over all the resamples of an interval, beyond which fewer resamples are drawn to bound the time it
+//takes: 2000 resamples up to 50k rows. A rank test sorts the values of every resample, which costs about as
+//much as 100 rows of Pearson each, so it draws 2000 resamples up to 1k rows. No interval has fewer than
+//kMinResamples
+const std::size_t kRowBudget = 100000000;
+const std::size_t kRankRowBudget = 2000000;
+const std::size_t kMinResamples = 100;
+
+//Ziggurat of 128 layers covering the standard normal density (Marsaglia and Tsang, 2000). Most draws fall
+//inside a layer and cost one random number and a multiplication
+struct Ziggurat
+{
+    Ziggurat();
+
+    static const double kTailStart;
+    uint32_t k[128];            //Draws below k[i] are inside layer i
+    double w[128];              //Width of layer i, per unit of a draw
+    double f[128];              //Density at the right edge of layer i
+};
+
+const double Ziggurat::kTailStart = 3.442619855899;
+
+Ziggurat::Ziggurat()
+{
+    const double m = 2147483648.0;
+    const double area = 9.91256303526217e-3;
+    double d = kTailStart, t = d;
+    double q = area / std::exp(-0.5 * d * d);
+
+    k[0] = static_cast<uint32_t>(d / q * m);
+    k[1] = 0;
+    w[0] = q / m;
+    w[127] = d / m;
+    f[0] = 1.0;
+    f[127] = std::exp(-0.5 * d * d);
+    for (int i = 126; i >= 1; --i) {
+        d = std::sqrt(-2.0 * std::log(area / d + std::exp(-0.5 * d * d)));
+        k[i + 1] = static_cast<uint32_t>(d / t * m);
+        t = d;
+        f[i] = std::exp(-0.5 * d * d);
+        w[i] = d / m;
+    }
+}
+
+//Random stream of a block of resamples: splitmix64, a few operations per number where mt19937_64 spent most
+//of the time of a resample, with rows and normal values drawn from it directly
+class Random
+{
+public:
+    Random(uint64_t seed, uint64_t block) : m_state(seed)
+    {
+        //Start each block at an unrelated point of the sequence
+        m_state = next() ^ (block * 0xd1b54a32d192ed03ULL);
+        m_state = next();
+    }
+
+    uint64_t next()
+    {
+        uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    //Row in [0, n), by multiplying rather than dividing
+    uint32_t row(std::size_t n)
+    {
+        return static_cast<uint32_t>(((next() >> 32) * static_cast<uint64_t>(n)) >> 32);
+    }
+
+    //Uniform value in (0, 1)
+    double uniform()
+    {
+        return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+    double normal()
+    {
+        static const Ziggurat zig;
+
+        while (true) {
+            //The layer and the position in it come from separate bits of the number
+            uint64_t bits = next();
+            int layer = static_cast<int>(bits & 127);
+            int32_t draw = static_cast<int32_t>(bits >> 32);
+            uint32_t size = draw < 0 ? 0u - static_cast<uint32_t>(draw) : static_cast<uint32_t>(draw);
+            double x = draw * zig.w[layer];
+            if (size < zig.k[layer])
+                return x;
+
+            //The base layer ends in the tail of the density, beyond kTailStart
+            if (layer == 0) {
+                double tail, y;
+                do {
+                    tail = -std::log(uniform()) / Ziggurat::kTailStart;
+                    y = -std::log(uniform());
+                } while (y + y < tail * tail);
+                return draw > 0 ? Ziggurat::kTailStart + tail : -Ziggurat::kTailStart - tail;
+            }
+
+            //Between the layer and the density, keep the draw if it is under the curve
+            if (zig.f[layer] + uniform() * (zig.f[layer - 1] - zig.f[layer]) < std::exp(-0.5 * x * x))
+                return x;
+        }
+    }
+
+private:
+    uint64_t m_state;
+};
+
+//Buffers of one block, reused by each of its resamples
+struct Scratch
+{
+    std::vector<uint32_t> counts;
+    std::vector<double> x, y;
+};
+
+//Call draw(row) for each row of a resample: every row once, or as many times as it is drawn with replacement.
+//The rows are all drawn first and then gone over in order, so that the columns, larger than the caches for a
+//full catalogue, are read one after the other rather than at random
+template <typename Draw>
+void forEachRow(Random &random, std::size_t n, bool resampleRows, Scratch &scratch, Draw draw)
+{
+    if (!resampleRows) {
+        for (std::size_t row = 0; row < n; ++row)
+            draw(static_cast<uint32_t>(row));
+        return;
+    }
+
+    scratch.counts.assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+        ++scratch.counts[random.row(n)];
+    for (std::size_t row = 0; row < n; ++row)
+        for (uint32_t copy = 0; copy < scratch.counts[row]; ++copy)
+            draw(static_cast<uint32_t>(row));
+}
+
+//Value of a row of a resample. With errors, it is drawn around the estimate and truncated at 0
+inline double drawValue(Random &random, const double *values, const double *errors, uint32_t row)
+{
+    double value = values[row];
+    if (!errors || std::isnan(value))
+        return value;
+    return std::max(0.0, value + errors[row] * random.normal());
+}
+
+//Values of the rows of a resample, for the tests that need all of them at once
+void gatherValues(Random &random, const double *x, const double *xError, const double *y, const double *yError,
+                  std::size_t n, bool resampleRows, Scratch &scratch)
+{
+    scratch.x.resize(n);
+    scratch.y.resize(n);
+    std::size_t i = 0;
+    forEachRow(random, n, resampleRows, scratch, [&](uint32_t row) {
+        scratch.x[i] = drawValue(random, x, xError, row);
+        scratch.y[i++] = drawValue(random, y, yError, row);
+    });
+}
+
+//Mean of the values that aren't NaN where the other variable isn't either, to centre the sums on
+void completeMeans(const double *x, const double *y, std::size_t n, double &meanX, double &meanY)
+{
+    std::size_t count = 0;
+    meanX = meanY = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!std::isnan(x[i]) && !std::isnan(y[i])) {
+            meanX += x[i];
+            meanY += y[i];
+            ++count;
+        }
+    }
+    if (count > 0) {
+        meanX /= count;
+        meanY /= count;
+    }
+}
+
+//Number of resamples of an interval of n rows, fewer than asked for if it is beyond the budget of its test
+std::size_t resampleCount(const BootstrapOptions &options, std::size_t n, std::size_t budget)
+{
+    if (!options.adaptResamples || n == 0)
+        return options.resamples;
+    return std::min(options.resamples, std::max(kMinResamples, budget / n));
+}
+
+//Value of statistic(random, scratch) for each of the resamples, in parallel
+template <typename Statistic>
+std::vector<double> resampleValues(std::size_t resamples, uint64_t seed, ThreadPool &pool, Statistic statistic)
+{
+    std::vector<double> values(resamples);
+    std::size_t blocks = (resamples + kResamplesPerBlock - 1) / kResamplesPerBlock;
+
+    pool.parallelFor(blocks, [&](std::size_t block) {
+        Random random(seed, block);
+        Scratch scratch;
+
+        std::size_t end = std::min(resamples, (block + 1) * kResamplesPerBlock);
+        for (std::size_t r = block * kResamplesPerBlock; r < end; ++r)
+            values[r] = statistic(random, scratch);
+    });
+
+    return values;
+}
+
+//Percentile interval of the resampled values, interpolated as R's quantile() does by default
+ConfidenceInterval percentileInterval(double estimate, std::vector<double> values, double level)
+{
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return !std::isfinite(v); }),
+                 values.end());
+    std::sort(values.begin(), values.end());
+
+    ConfidenceInterval interval;
+    interval.estimate = estimate;
+    interval.resamples = values.size();
+    interval.lower = interval.upper = std::numeric_limits<double>::quiet_NaN();
+    if (values.empty())
+        return interval;
+
+    double tail = (1.0 - level) / 2.0;
+    double fractions[2] = {tail, 1.0 - tail};
+    double *bounds[2] = {&interval.lower, &interval.upper};
+    for (int b = 0; b < 2; ++b) {
+        double h = (values.size() - 1) * std::min(std::max(fractions[b], 0.0), 1.0);
+        std::size_t lower = static_cast<std::size_t>(std::floor(h));
+        std::size_t upper = std::min(lower + 1, values.size() - 1);
+        *bounds[b] = values[lower] + (h - lower) * (values[upper] - values[lower]);
+    }
+    return interval;
+}
+
+} // namespace
+
+BootstrapOptions::BootstrapOptions() :
+    resamples(2000), level(0.95), seed(2015), resampleRows(true), perturbOwners(true), adaptResamples(true)
+{
+}
+
+ConfidenceInterval bootstrapCorrelation(CorrelationMethod method, const double *x, const double *xError,
+                                        const double *y, const double *yError, std::size_t n,
+                                        const BootstrapOptions &options, ThreadPool &pool)
+{
+    double estimate = correlationTest(method, x, y, n).estimate;
+    if (n == 0)
+        return percentileInterval(estimate, std::vector<double>(), options.level);
+
+    if (!options.perturbOwners)
+        xError = yError = 0;
+
+    //Pearson's coefficient only needs sums over the rows, taken as they are drawn, around the means of the data
+    //so that they don't lose precision
+    std::vector<double> values;
+    if (method == CorrelationMethod::Pearson) {
+        double meanX, meanY;
+        completeMeans(x, y, n, meanX, meanY);
+
+        values = resampleValues(resampleCount(options, n, kRowBudget), options.seed, pool,
+                                [&](Random &random, Scratch &scratch) {
+            std::size_t count = 0;
+            double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumYY = 0.0, sumXY = 0.0;
+            forEachRow(random, n, options.resampleRows, scratch, [&](uint32_t row) {
+                double dx = drawValue(random, x, xError, row) - meanX;
+                double dy = drawValue(random, y, yError, row) - meanY;
+                if (std::isnan(dx) || std::isnan(dy))
+                    return;
+
+                ++count;
+                sumX += dx;
+                sumY += dy;
+                sumXX += dx * dx;
+                sumYY += dy * dy;
+                sumXY += dx * dy;
+            });
+            if (count == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+            return pearsonResult(count, sumXX - sumX * sumX / count, sumYY - sumY * sumY / count,
+                                 sumXY - sumX * sumY / count).estimate;
+        });
+    } else {
+        values = resampleValues(resampleCount(options, n, kRankRowBudget), options.seed, pool,
+                                [&](Random &random, Scratch &scratch) {
+            gatherValues(random, x, xError, y, yError, n, options.resampleRows, scratch);
+            return correlationTest(method, scratch.x.data(), scratch.y.data(), n).estimate;
+        });
+    }
+
+    return percentileInterval(estimate, values, options.level);
+}
+
+OwnerIntervals ownerIntervals(const double *owners, const double *errors, std::size_t n,
+                              const BootstrapOptions &options, ThreadPool &pool)
+{
+    double total = 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+        total += owners[i];
+
+    std::vector<double> totals;
+    if (n > 0) {
+        const double *ownerErrors = options.perturbOwners ? errors : 0;
+        totals = resampleValues(resampleCount(options, n, kRowBudget), options.seed, pool,
+                                [&](Random &random, Scratch &scratch) {
+            double sum = 0.0;
+            forEachRow(random, n, options.resampleRows, scratch, [&](uint32_t row) {
+                sum += drawValue(random, owners, ownerErrors, row);
+            });
+            return sum;
+        });
+    }
+
+    //Every resample has n games, so the mean is the total divided by n
+    OwnerIntervals intervals;
+    intervals.total = percentileInterval(total, totals, options.level);
+    intervals.mean = intervals.total;
+    if (n > 0) {
+        intervals.mean.estimate /= n;
+        intervals.mean.lower /= n;
+        intervals.mean.upper /= n;
+    } else {
+        intervals.mean.estimate = std::numeric_limits<double>::quiet_NaN();
+    }
+    return intervals;
+}
+
+IntervalCache::IntervalCache() : m_filterVersion(0), m_generation(0)
+{
+}
+
+unsigned IntervalCache::generation() const
+{
+    return m_generation;
+}
+
+const ConfidenceInterval *IntervalCache::findCorrelation(int year, unsigned filterVersion, GameColumn x, GameColumn y,
+                                                         CorrelationMethod method) const
+{
+    std::map<Key, ConfidenceInterval>::const_iterator it = m_correlations.find(Key(year, filterVersion, x, y, method));
+    return it != m_correlations.end() ? &it->second : 0;
+}
+
+const OwnerIntervals *IntervalCache::findOwners(int year, unsigned filterVersion) const
+{
+    std::map<OwnersKey, OwnerIntervals>::const_iterator it = m_owners.find(OwnersKey(year, filterVersion));
+    return it != m_owners.end() ? &it->second : 0;
+}
+
+void IntervalCache::storeCorrelation(unsigned generation, int year, unsigned filterVersion, GameColumn x, GameColumn y,
+                                     CorrelationMethod method, const ConfidenceInterval &interval)
+{
+    if (generation != m_generation || (filterVersion != 0 && filterVersion < m_filterVersion))
+        return;
+
+    keepFilterVersion(filterVersion);
+    m_correlations[Key(year, filterVersion, x, y, method)] = interval;
+}
+
+void IntervalCache::storeOwners(unsigned generation, int year, unsigned filterVersion, const OwnerIntervals &intervals)
+{
+    if (generation != m_generation || (filterVersion != 0 && filterVersion < m_filterVersion))
+        return;
+
+    keepFilterVersion(filterVersion);
+    m_owners[OwnersKey(year, filterVersion)] = intervals;
+}
+
+void IntervalCache::keepFilterVersion(unsigned filterVersion)
+{
+    //Drop the intervals of the previous filter
+    if (filterVersion == 0 || filterVersion == m_filterVersion)
+        return;
+
+    for (std::map<Key, ConfidenceInterval>::iterator it = m_correlations.begin(); it != m_correlations.end(); ) {
+        if (std::get<1>(it->first) != 0)
+            it = m_correlations.erase(it);
+        else
+            ++it;
+    }
+    for (std::map<OwnersKey, OwnerIntervals>::iterator it = m_owners.begin(); it != m_owners.end(); ) {
+        if (it->first.second != 0)
+            it = m_owners.erase(it);
+        else
+            ++it;
+    }
+    m_filterVersion = filterVersion;
+}
+
+void IntervalCache::dropYear(int year)
+{
+    for (std::map<Key, ConfidenceInterval>::iterator it = m_correlations.begin(); it != m_correlations.end(); ) {
+        if (std::get<0>(it->first) == year)
+            it = m_correlations.erase(it);
+        else
+            ++it;
+    }
+    for (std::map<OwnersKey, OwnerIntervals>::iterator it = m_owners.begin(); it != m_owners.end(); ) {
+        if (it->first.first == year)
+            it = m_owners.erase(it);
+        else
+            ++it;
+    }
+    ++m_generation;
+}
+
+void IntervalCache::clear()
+{
+    m_correlations.clear();
+    m_owners.clear();
+    m_filterVersion = 0;
+    ++m_generation;
+}
@@ -0,0 +1,96 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Bootstrap and Monte-Carlo confidence intervals, propagating the sampling error of the owner estimates
+//
+// Author: Francois Stelluti
+//
+
+#ifndef Bootstrap_H
+#define Bootstrap_H
+
+#include "Correlation.h"
+
+#include <cstddef>
+#include <map>
+#include <stdint.h>
+#include <tuple>
+#include <utility>
+
+class ThreadPool;
+
+struct BootstrapOptions
+{
+    BootstrapOptions();
+
+    std::size_t resamples;      //Number of resampled values the interval is taken from
+    double level;               //e.g. 0.95 for a 95% interval
+    uint64_t seed;              //The same seed gives the same interval, whatever the number of threads
+    bool resampleRows;          //Draw the rows with replacement (bootstrap)
+
+    //Draw each owner estimate from a normal distribution around it, with its '±' error as the
+    //standard deviation, truncated at 0 (Monte-Carlo propagation of the SteamSpy sampling error)
+    bool perturbOwners;
+
+    //Draw fewer resamples of large inputs, down to 100, to bound the time an interval takes.
+    //Spearman and Kendall sort every resample and are cut down first
+    bool adaptResamples;
+};
+
+struct ConfidenceInterval
+{
+    double estimate;            //Value of the data as given
+    double lower, upper;        //Percentiles of the resampled values, NaN if there are none
+    std::size_t resamples;      //Resamples that gave a value, fewer than asked for if they were adapted
+};
+
+//Interval of the estimate of a correlation test. xError and yError are the '±' errors of a variable
+//that is an owner estimate, or null for the other variables
+ConfidenceInterval bootstrapCorrelation(CorrelationMethod method, const double *x, const double *xError,
+                                        const double *y, const double *yError, std::size_t n,
+                                        const BootstrapOptions &options, ThreadPool &pool);
+
+struct OwnerIntervals
+{
+    ConfidenceInterval total;   //Total owners of the games
+    ConfidenceInterval mean;    //Average owners per game
+};
+
+//Intervals of the owner aggregates of n games with the given owner estimates and '±' errors
+OwnerIntervals ownerIntervals(const double *owners, const double *errors, std::size_t n,
+                              const BootstrapOptions &options, ThreadPool &pool);
+
+//Intervals already computed, keyed like the tests of CorrelationCache by the year, the version of the filter
+//(0 for the whole table), the variables and the method, and for the owners by the year and filter version.
+//Only the latest filter version is kept. Intervals are computed away from the cache, so each one is stored
+//with the generation of the cache it was asked for in: one asked for before rows were appended is dropped
+class IntervalCache
+{
+public:
+    IntervalCache();
+
+    unsigned generation() const;        //Changes whenever intervals are dropped
+
+    const ConfidenceInterval *findCorrelation(int year, unsigned filterVersion, GameColumn x, GameColumn y,
+                                              CorrelationMethod method) const;
+    const OwnerIntervals *findOwners(int year, unsigned filterVersion) const;
+
+    void storeCorrelation(unsigned generation, int year, unsigned filterVersion, GameColumn x, GameColumn y,
+                          CorrelationMethod method, const ConfidenceInterval &interval);
+    void storeOwners(unsigned generation, int year, unsigned filterVersion, const OwnerIntervals &intervals);
+
+    void dropYear(int year);            //Rows were appended to the table of the year
+    void clear();
+
+private:
+    typedef std::tuple<int, unsigned, GameColumn, GameColumn, CorrelationMethod> Key;
+    typedef std::pair<int, unsigned> OwnersKey;
+
+    void keepFilterVersion(unsigned filterVersion);
+
+    std::map<Key, ConfidenceInterval> m_correlations;
+    std::map<OwnersKey, OwnerIntervals> m_owners;
+    unsigned m_filterVersion;           //Filter version of the filtered intervals kept
+    unsigned m_generation;
+};
+
+#endif
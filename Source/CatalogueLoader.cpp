@@ -0,0 +1,372 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Parallel loading of a catalogue split across many SteamSpy exports into one table
+//
+// Author: Francois Stelluti
+//
+
+#include "CatalogueLoader.h"
+#include "NameDictionary.h"
+#include "SteamCsvParser.h"
+#include "ThreadPool.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+//Size of the chunks files are split into. Large enough that finding the boundaries costs nothing,
+//small enough that a few large files still keep every thread busy
+const std::size_t kChunkBytes = 4 * 1024 * 1024;
+
+//Files are read and parsed in batches of about this many bytes, and their contents released before the
+//next batch is read. A file larger than this is a batch of its own
+const std::size_t kBatchBytes = 256 * 1024 * 1024;
+
+//Rows of the merged table written by one task, a whole number of words of the score bitmaps
+const std::size_t kMergeRows = 64 * 1024;
+
+//Contents of a file, and the parser that read its header
+struct CatalogueFile
+{
+    std::string path;
+    std::vector<char> data;
+    std::size_t headerBytes;
+    SteamCsvParser parser;
+};
+
+//Piece of a file, parsed into its own table
+struct Chunk
+{
+    std::size_t file;               //In the batch of files being parsed
+    std::size_t begin, end;         //Offsets into the data of the file
+    std::size_t quotes;             //Quotes in the nominal piece, before it is moved to a record boundary
+    SteamGameTable table;
+    std::size_t skippedRows;
+    std::vector<uint64_t> nameHashes;
+    std::vector<char> keep;         //Rows that are the last record of their game
+};
+
+void readWholeFile(CatalogueFile &file)
+{
+    std::ifstream in(file.path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    if (!in)
+        throw std::runtime_error("Unable to open " + file.path);
+
+    std::streamoff size = in.tellg();
+    file.data.resize(static_cast<std::size_t>(size));
+    in.seekg(0);
+    if (size > 0 && !in.read(&file.data[0], size))
+        throw std::runtime_error("Unable to read " + file.path);
+}
+
+//Offset of the start of the first record at or after offset, given whether offset is inside quotes.
+//A newline only ends a record outside of quotes; doubled quotes leave it unchanged
+std::size_t nextRecord(const std::vector<char> &data, std::size_t offset, bool inQuotes)
+{
+    for (std::size_t i = offset; i < data.size(); ++i) {
+        if (data[i] == '"')
+            inQuotes = !inQuotes;
+        else if (data[i] == '\n' && !inQuotes)
+            return i + 1;
+    }
+    return data.size();
+}
+
+//Set of the names of one partition, with open addressing: a slot holds the table and row a name was first
+//seen in, so the names themselves are never copied. The set is sized for the names of its partition
+class NameSet
+{
+public:
+    NameSet(const std::vector<const SteamGameTable *> &tables, std::size_t names) : m_tables(tables)
+    {
+        std::size_t slots = 16;
+        while (slots < names * 2)
+            slots *= 2;
+        m_slots.assign(slots, Slot());
+        m_mask = slots - 1;
+    }
+
+    //Add the name of a row, returns false if it is already in the set
+    bool insert(uint32_t table, uint32_t row, uint64_t hash)
+    {
+        const char *name = nameOf(table, row);
+        std::size_t length = lengthOf(table, row);
+
+        for (std::size_t i = static_cast<std::size_t>(hash >> 16) & m_mask;; i = (i + 1) & m_mask) {
+            Slot &slot = m_slots[i];
+            if (slot.table == kEmptySlot) {
+                slot.table = table;
+                slot.row = row;
+                slot.hash = static_cast<uint32_t>(hash);
+                return true;
+            }
+            if (slot.hash == static_cast<uint32_t>(hash) && lengthOf(slot.table, slot.row) == length &&
+                std::memcmp(nameOf(slot.table, slot.row), name, length) == 0)
+                return false;
+        }
+    }
+
+private:
+    //Only the low bits of the hash are kept, to compare names that land in the same slot. An empty slot has
+    //no table
+    static const uint32_t kEmptySlot = 0xffffffff;
+    struct Slot {
+        Slot() : hash(0), table(kEmptySlot), row(0) {}
+        uint32_t hash;
+        uint32_t table, row;
+    };
+
+    const char *nameOf(uint32_t table, uint32_t row) const
+    {
+        const SteamGameColumns &columns = m_tables[table]->columns();
+        return columns.names + columns.nameOffsets[row];
+    }
+
+    std::size_t lengthOf(uint32_t table, uint32_t row) const
+    {
+        const SteamGameColumns &columns = m_tables[table]->columns();
+        return columns.nameOffsets[row + 1] - columns.nameOffsets[row];
+    }
+
+    const std::vector<const SteamGameTable *> &m_tables;
+    std::vector<Slot> m_slots;
+    std::size_t m_mask;
+};
+
+//Parse a batch of files into chunks added to the end of chunks. Only the tables of the chunks are kept
+void parseBatch(const std::vector<std::string> &paths, ThreadPool &pool, std::vector<Chunk> &chunks)
+{
+    //Read every file and its header
+    std::vector<CatalogueFile> files(paths.size());
+    pool.parallelFor(files.size(), [&](std::size_t f) {
+        CatalogueFile &file = files[f];
+        file.path = paths[f];
+        readWholeFile(file);
+        file.headerBytes = file.data.empty() ? 0 : file.parser.parseHeader(&file.data[0], &file.data[0] + file.data.size());
+    });
+
+    //Split each file into pieces of about kChunkBytes, and count the quotes of every piece
+    std::size_t first = chunks.size();
+    for (std::size_t f = 0; f < files.size(); ++f) {
+        for (std::size_t offset = files[f].headerBytes; offset < files[f].data.size(); offset += kChunkBytes) {
+            chunks.push_back(Chunk());
+            chunks.back().file = f;
+            chunks.back().begin = offset;
+            chunks.back().end = std::min(offset + kChunkBytes, files[f].data.size());
+        }
+    }
+    std::size_t count = chunks.size() - first;
+    Chunk *batch = count > 0 ? &chunks[first] : 0;
+
+    pool.parallelFor(count, [&](std::size_t c) {
+        const std::vector<char> &data = files[batch[c].file].data;
+        batch[c].quotes = std::count(data.begin() + batch[c].begin, data.begin() + batch[c].end, '"');
+    });
+
+    //Whether a piece starts inside quotes follows from the quotes before it, then every piece but the first
+    //of a file is moved to the start of its first whole record, and ends where the next piece starts
+    std::vector<bool> startsInQuotes(count, false);
+    for (std::size_t c = 1; c < count; ++c)
+        if (batch[c].file == batch[c - 1].file)
+            startsInQuotes[c] = startsInQuotes[c - 1] != (batch[c - 1].quotes % 2 == 1);
+
+    std::vector<std::size_t> starts(count);
+    pool.parallelFor(count, [&](std::size_t c) {
+        bool first = c == 0 || batch[c].file != batch[c - 1].file;
+        starts[c] = first ? batch[c].begin : nextRecord(files[batch[c].file].data, batch[c].begin, startsInQuotes[c]);
+    });
+
+    //Parse the chunks, each with a copy of the parser that read the header of its file
+    pool.parallelFor(count, [&](std::size_t c) {
+        Chunk &chunk = batch[c];
+        const CatalogueFile &file = files[chunk.file];
+        bool last = c + 1 == count || batch[c + 1].file != chunk.file;
+        chunk.begin = starts[c];
+        chunk.end = last ? file.data.size() : std::max(starts[c], starts[c + 1]);
+
+        SteamCsvParser parser = file.parser;
+        if (chunk.end > chunk.begin)
+            parser.parseBuffer(&file.data[chunk.begin], &file.data[0] + chunk.end, chunk.table, true);
+        chunk.skippedRows = parser.skippedRows();
+
+        chunk.nameHashes.resize(chunk.table.size());
+        const SteamGameColumns &columns = chunk.table.columns();
+        for (std::size_t row = 0; row < chunk.table.size(); ++row)
+            chunk.nameHashes[row] = hashName(columns.names + columns.nameOffsets[row],
+                                             columns.nameOffsets[row + 1] - columns.nameOffsets[row]);
+        chunk.keep.assign(chunk.table.size(), 0);
+    });
+}
+
+//Without helper threads, the files are parsed one after the other into one table, as parseFile would, and the
+//rows are only copied again if a game appears more than once
+std::shared_ptr<SteamGameTable> loadSerially(const std::vector<std::string> &paths, CatalogueStats &counts)
+{
+    std::shared_ptr<SteamGameTable> table = std::make_shared<SteamGameTable>();
+    SteamCsvParser parser;
+    for (std::size_t f = 0; f < paths.size(); ++f) {
+        parser.appendFile(paths[f], *table);
+        counts.skippedRows += parser.skippedRows();
+    }
+    counts.files = paths.size();
+    counts.chunks = paths.size();
+    counts.records = table->size();
+
+    //Keep the last record of every game, going backwards
+    std::vector<const SteamGameTable *> tables(1, table.get());
+    NameSet seen(tables, table->size());
+    const SteamGameColumns &columns = table->columns();
+    std::vector<char> keep(table->size(), 0);
+    for (std::size_t row = table->size(); row-- > 0;) {
+        const char *name = columns.names + columns.nameOffsets[row];
+        std::size_t length = columns.nameOffsets[row + 1] - columns.nameOffsets[row];
+        keep[row] = seen.insert(0, static_cast<uint32_t>(row), hashName(name, length));
+        counts.duplicates += !keep[row];
+    }
+    if (counts.duplicates == 0)
+        return table;
+
+    std::shared_ptr<SteamGameTable> kept = std::make_shared<SteamGameTable>();
+    kept->reserve(table->size() - counts.duplicates, table->nameBytes());
+    for (std::size_t row = 0; row < table->size(); ++row)
+        if (keep[row])
+            kept->appendRow(table->row(row));
+    return kept;
+}
+
+} // namespace
+
+bool isCataloguePath(const std::string &path)
+{
+    QString name = QString::fromStdString(path);
+    return QFileInfo(name).isDir() || name.contains('*') || name.contains('?') || name.contains('[');
+}
+
+std::vector<std::string> catalogueFiles(const std::string &path)
+{
+    QFileInfo info(QString::fromStdString(path));
+
+    //A directory holds the exports, otherwise the file name is a pattern matched in its directory
+    QDir dir = info.isDir() ? QDir(info.filePath()) : info.dir();
+    QString pattern = info.isDir() ? QString("*.csv") : info.fileName();
+    if (!info.isDir() && !isCataloguePath(path))
+        return std::vector<std::string>(1, path);
+
+    std::vector<std::string> files;
+    foreach (const QString &file, dir.entryList(QStringList(pattern), QDir::Files, QDir::Name))
+        files.push_back(dir.filePath(file).toStdString());
+    return files;
+}
+
+std::shared_ptr<SteamGameTable> loadCatalogue(const std::vector<std::string> &paths, ThreadPool &pool,
+                                              CatalogueStats *stats)
+{
+    //A single core gains nothing from splitting the files, only the cost of merging the pieces again
+    if (pool.size() == 0 || std::thread::hardware_concurrency() == 1) {
+        CatalogueStats counts = CatalogueStats();
+        std::shared_ptr<SteamGameTable> table = loadSerially(paths, counts);
+        if (stats)
+            *stats = counts;
+        return table;
+    }
+
+    //Parse the files in batches, so that only the contents of one batch are in memory at a time
+    std::vector<Chunk> chunks;
+    for (std::size_t first = 0; first < paths.size(); ) {
+        std::size_t end = first, bytes = 0;
+        while (end < paths.size() && (end == first || bytes < kBatchBytes)) {
+            QFileInfo info(QString::fromStdString(paths[end++]));
+            bytes += static_cast<std::size_t>(info.size());
+        }
+        parseBatch(std::vector<std::string>(paths.begin() + first, paths.begin() + end), pool, chunks);
+        first = end;
+    }
+
+    //Keep the last record of every game: going backwards, a name seen for the first time is kept.
+    //The names are split between the threads by their hash, so each set of names is only used by one thread
+    std::vector<const SteamGameTable *> tables(chunks.size());
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+        tables[c] = &chunks[c].table;
+
+    std::size_t partitions = pool.size() + 1;
+    pool.parallelFor(partitions, [&](std::size_t partition) {
+        std::size_t names = 0;
+        for (std::size_t c = 0; c < chunks.size(); ++c)
+            for (std::size_t row = 0; row < chunks[c].nameHashes.size(); ++row)
+                names += chunks[c].nameHashes[row] % partitions == partition;
+
+        NameSet seen(tables, names);
+        for (std::size_t c = chunks.size(); c-- > 0;) {
+            Chunk &chunk = chunks[c];
+            for (std::size_t row = chunk.nameHashes.size(); row-- > 0;) {
+                if (chunk.nameHashes[row] % partitions == partition)
+                    chunk.keep[row] = seen.insert(static_cast<uint32_t>(c), static_cast<uint32_t>(row),
+                                                  chunk.nameHashes[row]);
+            }
+        }
+    });
+
+    //Rows and name bytes kept by each chunk, then where the kept rows of each chunk start in the merged table
+    std::vector<std::size_t> firstRow(chunks.size() + 1, 0), firstNameByte(chunks.size() + 1, 0);
+    pool.parallelFor(chunks.size(), [&](std::size_t c) {
+        const SteamGameColumns &columns = chunks[c].table.columns();
+        for (std::size_t row = 0; row < chunks[c].table.size(); ++row) {
+            if (chunks[c].keep[row]) {
+                ++firstRow[c + 1];
+                firstNameByte[c + 1] += columns.nameOffsets[row + 1] - columns.nameOffsets[row];
+            }
+        }
+    });
+
+    CatalogueStats counts = CatalogueStats();
+    counts.files = paths.size();
+    counts.chunks = chunks.size();
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        counts.records += chunks[c].table.size();
+        counts.skippedRows += chunks[c].skippedRows;
+        firstRow[c + 1] += firstRow[c];
+        firstNameByte[c + 1] += firstNameByte[c];
+    }
+    std::size_t kept = firstRow[chunks.size()];
+    counts.duplicates = counts.records - kept;
+
+    //Copy the kept rows in the order of the files. Each task writes a block of rows of the merged table,
+    //starting in the chunk whose kept rows include the first row of the block
+    std::shared_ptr<SteamGameTable> table = std::make_shared<SteamGameTable>();
+    table->resize(kept, firstNameByte[chunks.size()]);
+    pool.parallelFor((kept + kMergeRows - 1) / kMergeRows, [&](std::size_t block) {
+        std::size_t row = block * kMergeRows, end = std::min(kept, row + kMergeRows);
+        std::size_t c = std::upper_bound(firstRow.begin(), firstRow.end(), row) - firstRow.begin() - 1;
+        std::size_t skip = row - firstRow[c], source = 0, nameOffset = firstNameByte[c];
+
+        while (row < end) {
+            if (source == chunks[c].table.size()) {
+                ++c;
+                source = 0;
+                continue;
+            }
+            if (chunks[c].keep[source]) {
+                const SteamGameColumns &columns = chunks[c].table.columns();
+                if (skip > 0)
+                    --skip;
+                else
+                    table->setRow(row++, nameOffset, chunks[c].table.row(source));
+                nameOffset += columns.nameOffsets[source + 1] - columns.nameOffsets[source];
+            }
+            ++source;
+        }
+    });
+
+    if (stats)
+        *stats = counts;
+    return table;
+}
@@ -0,0 +1,43 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Parallel loading of a catalogue split across many SteamSpy exports into one table
+//
+// Author: Francois Stelluti
+//
+
+#ifndef CatalogueLoader_H
+#define CatalogueLoader_H
+
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//True for a directory, or a path whose file name has wildcards (e.g. dumps/2015-*.csv)
+bool isCataloguePath(const std::string &path);
+
+//Files of a catalogue: every CSV of a directory, or the files matching the wildcards of the file name,
+//sorted by name. loadCatalogue keeps the record of a game from the last file, so the names of dated exports
+//must sort by date, e.g. 2015-03-01.csv rather than 1-3-2015.csv. A plain file is returned as is
+std::vector<std::string> catalogueFiles(const std::string &path);
+
+struct CatalogueStats
+{
+    std::size_t files;
+    std::size_t chunks;             //Pieces of the files parsed separately
+    std::size_t records;            //Rows read from every file
+    std::size_t duplicates;         //Rows replaced by a later record of the same game
+    std::size_t skippedRows;        //Malformed records that were ignored
+};
+
+//Parse the files and merge them into one table. Each file is split into chunks at record boundaries,
+//and the chunks of every file are parsed in parallel on the pool. A game (by name) appearing more than once
+//keeps its last record, from the last file in the list. Throws std::runtime_error if a file can't be read
+std::shared_ptr<SteamGameTable> loadCatalogue(const std::vector<std::string> &files, ThreadPool &pool,
+                                              CatalogueStats *stats = 0);
+
+#endif
@@ -0,0 +1,449 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Native correlation tests (Pearson, Spearman and Kendall), replacing R's cor.test
+//
+// Author: Francois Stelluti
+//
+
+#include "Correlation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+//Continued fraction for the incomplete beta function (modified Lentz's method)
+double betaContinuedFraction(double a, double b, double x)
+{
+    const int maxIterations = 300;
+    const double epsilon = 1e-15;
+    const double tiny = 1e-300;
+
+    double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 - qab * x / qap;
+    if (std::fabs(d) < tiny)
+        d = tiny;
+    d = 1.0 / d;
+    double h = d;
+
+    for (int m = 1; m <= maxIterations; ++m) {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < tiny)
+            d = tiny;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < tiny)
+            c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < tiny)
+            d = tiny;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < tiny)
+            c = tiny;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+
+        if (std::fabs(delta - 1.0) < epsilon)
+            break;
+    }
+
+    return h;
+}
+
+//Regularized incomplete beta function I_x(a, b)
+double regularizedBeta(double x, double a, double b)
+{
+    if (x <= 0.0)
+        return 0.0;
+    if (x >= 1.0)
+        return 1.0;
+
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b)
+                            + a * std::log(x) + b * std::log(1.0 - x));
+
+    //The continued fraction converges quickly on one side of the mean, use the symmetry otherwise
+    if (x < (a + 1.0) / (a + b + 2.0))
+        return front * betaContinuedFraction(a, b, x) / a;
+    return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+}
+
+CorrelationResult emptyResult(CorrelationMethod method, std::size_t n)
+{
+    CorrelationResult result;
+    result.method = method;
+    result.n = n;
+    result.estimate = result.statistic = result.pValue = kNaN;
+    return result;
+}
+
+//Keep only the pairs where both values are present
+void completePairs(const double *x, const double *y, std::size_t n, std::vector<double> &cx, std::vector<double> &cy)
+{
+    cx.clear();
+    cy.clear();
+    cx.reserve(n);
+    cy.reserve(n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!std::isnan(x[i]) && !std::isnan(y[i])) {
+            cx.push_back(x[i]);
+            cy.push_back(y[i]);
+        }
+    }
+}
+
+//Replace values by their ranks, tied values get the average of their ranks
+void rank(std::vector<double> &values)
+{
+    std::vector<std::size_t> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values](std::size_t a, std::size_t b) { return values[a] < values[b]; });
+
+    std::vector<double> ranks(values.size());
+    std::size_t i = 0;
+    while (i < order.size()) {
+        std::size_t j = i + 1;
+        while (j < order.size() && values[order[j]] == values[order[i]])
+            ++j;
+
+        double averageRank = (i + j + 1) / 2.0;      //Ranks start at 1
+        for (std::size_t k = i; k < j; ++k)
+            ranks[order[k]] = averageRank;
+        i = j;
+    }
+
+    values.swap(ranks);
+}
+
+//Sum of f(t) over the sizes t of every group of equal values in a sorted range
+template <typename Iterator, typename Equal, typename Function>
+double sumOverTies(Iterator begin, Iterator end, Equal equal, Function f)
+{
+    double total = 0.0;
+    Iterator i = begin;
+    while (i != end) {
+        Iterator j = i + 1;
+        while (j != end && equal(*i, *j))
+            ++j;
+        double t = static_cast<double>(j - i);
+        if (t > 1)
+            total += f(t);
+        i = j;
+    }
+    return total;
+}
+
+//Merge sort by y, counting the number of swaps needed (Knight's algorithm)
+double sortCountingSwaps(std::vector<std::pair<double, double> > &pairs, std::size_t begin, std::size_t end,
+                         std::vector<std::pair<double, double> > &buffer)
+{
+    if (end - begin < 2)
+        return 0.0;
+
+    std::size_t middle = begin + (end - begin) / 2;
+    double swaps = sortCountingSwaps(pairs, begin, middle, buffer) + sortCountingSwaps(pairs, middle, end, buffer);
+
+    std::size_t left = begin, right = middle, out = begin;
+    while (left < middle && right < end) {
+        if (pairs[right].second < pairs[left].second) {
+            swaps += static_cast<double>(middle - left);
+            buffer[out++] = pairs[right++];
+        }
+        else {
+            buffer[out++] = pairs[left++];
+        }
+    }
+    while (left < middle)
+        buffer[out++] = pairs[left++];
+    while (right < end)
+        buffer[out++] = pairs[right++];
+
+    std::copy(buffer.begin() + begin, buffer.begin() + end, pairs.begin() + begin);
+    return swaps;
+}
+
+} // namespace
+
+PearsonAccumulator::PearsonAccumulator() :
+    m_n(0), m_meanX(0.0), m_meanY(0.0), m_m2X(0.0), m_m2Y(0.0), m_coMoment(0.0)
+{
+}
+
+void PearsonAccumulator::add(double x, double y)
+{
+    if (std::isnan(x) || std::isnan(y))
+        return;
+
+    //Welford's update of the means and co-moments
+    ++m_n;
+    double dx = x - m_meanX;
+    double dy = y - m_meanY;
+    m_meanX += dx / m_n;
+    m_meanY += dy / m_n;
+    m_m2X += dx * (x - m_meanX);
+    m_m2Y += dy * (y - m_meanY);
+    m_coMoment += dx * (y - m_meanY);
+}
+
+void PearsonAccumulator::merge(const PearsonAccumulator &other)
+{
+    if (other.m_n == 0)
+        return;
+    if (m_n == 0) {
+        *this = other;
+        return;
+    }
+
+    double n = static_cast<double>(m_n + other.m_n);
+    double dx = other.m_meanX - m_meanX;
+    double dy = other.m_meanY - m_meanY;
+    double weight = static_cast<double>(m_n) * other.m_n / n;
+
+    m_m2X += other.m_m2X + dx * dx * weight;
+    m_m2Y += other.m_m2Y + dy * dy * weight;
+    m_coMoment += other.m_coMoment + dx * dy * weight;
+    m_meanX += dx * other.m_n / n;
+    m_meanY += dy * other.m_n / n;
+    m_n += other.m_n;
+}
+
+CorrelationResult PearsonAccumulator::result() const
+{
+    return pearsonResult(m_n, m_m2X, m_m2Y, m_coMoment);
+}
+
+CorrelationResult pearsonResult(std::size_t n, double m2X, double m2Y, double coMoment)
+{
+    CorrelationResult result = emptyResult(CorrelationMethod::Pearson, n);
+    if (n < 3 || m2X <= 0.0 || m2Y <= 0.0)
+        return result;
+
+    double r = coMoment / std::sqrt(m2X * m2Y);
+    r = std::max(-1.0, std::min(1.0, r));
+    double df = static_cast<double>(n) - 2.0;
+
+    result.estimate = r;
+    if (std::fabs(r) == 1.0) {
+        result.statistic = r > 0 ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+        result.pValue = 0.0;
+    }
+    else {
+        result.statistic = r * std::sqrt(df / (1.0 - r * r));
+        result.pValue = studentTPValue(result.statistic, df);
+    }
+
+    return result;
+}
+
+double studentTPValue(double t, double degreesOfFreedom)
+{
+    if (std::isnan(t))
+        return kNaN;
+    return regularizedBeta(degreesOfFreedom / (degreesOfFreedom + t * t), degreesOfFreedom / 2.0, 0.5);
+}
+
+double normalPValue(double z)
+{
+    if (std::isnan(z))
+        return kNaN;
+    return std::erfc(std::fabs(z) / std::sqrt(2.0));
+}
+
+CorrelationResult pearsonTest(const double *x, const double *y, std::size_t n)
+{
+    PearsonAccumulator accumulator;
+    for (std::size_t i = 0; i < n; ++i)
+        accumulator.add(x[i], y[i]);
+    return accumulator.result();
+}
+
+CorrelationResult spearmanTest(const double *x, const double *y, std::size_t n)
+{
+    //Pearson's coefficient of the ranks. The p-value uses the t approximation,
+    //as R does when exact=FALSE or when there are ties
+    std::vector<double> cx, cy;
+    completePairs(x, y, n, cx, cy);
+    rank(cx);
+    rank(cy);
+
+    CorrelationResult result = pearsonTest(cx.data(), cy.data(), cx.size());
+    result.method = CorrelationMethod::Spearman;
+    return result;
+}
+
+CorrelationResult kendallTest(const double *x, const double *y, std::size_t n)
+{
+    std::vector<double> cx, cy;
+    completePairs(x, y, n, cx, cy);
+    double count = static_cast<double>(cx.size());
+
+    CorrelationResult result = emptyResult(CorrelationMethod::Kendall, cx.size());
+    if (cx.size() < 3)
+        return result;
+
+    std::vector<std::pair<double, double> > pairs(cx.size());
+    for (std::size_t i = 0; i < cx.size(); ++i)
+        pairs[i] = std::make_pair(cx[i], cy[i]);
+
+    //Sort by x then y to count the ties in x, and the pairs tied in both
+    std::sort(pairs.begin(), pairs.end());
+    typedef std::pair<double, double> Pair;
+    auto sameX = [](const Pair &a, const Pair &b) { return a.first == b.first; };
+    auto sameY = [](const Pair &a, const Pair &b) { return a.second == b.second; };
+    auto samePair = [](const Pair &a, const Pair &b) { return a == b; };
+    auto tiedPairs = [](double t) { return t * (t - 1) / 2; };
+    auto tieVariance = [](double t) { return t * (t - 1) * (2 * t + 5); };
+    auto tieProduct1 = [](double t) { return t * (t - 1); };
+    auto tieProduct2 = [](double t) { return t * (t - 1) * (t - 2); };
+
+    double n0 = count * (count - 1) / 2;
+    double n1 = sumOverTies(pairs.begin(), pairs.end(), sameX, tiedPairs);
+    double n3 = sumOverTies(pairs.begin(), pairs.end(), samePair, tiedPairs);
+    double vt = sumOverTies(pairs.begin(), pairs.end(), sameX, tieVariance);
+    double x1 = sumOverTies(pairs.begin(), pairs.end(), sameX, tieProduct1);
+    double x2 = sumOverTies(pairs.begin(), pairs.end(), sameX, tieProduct2);
+
+    //Then sort by y, the number of swaps is the number of discordant pairs
+    std::vector<Pair> buffer(pairs.size());
+    double swaps = sortCountingSwaps(pairs, 0, pairs.size(), buffer);
+    double n2 = sumOverTies(pairs.begin(), pairs.end(), sameY, tiedPairs);
+    double vu = sumOverTies(pairs.begin(), pairs.end(), sameY, tieVariance);
+    double y1 = sumOverTies(pairs.begin(), pairs.end(), sameY, tieProduct1);
+    double y2 = sumOverTies(pairs.begin(), pairs.end(), sameY, tieProduct2);
+
+    //Concordant minus discordant pairs, and tau-b
+    double s = n0 - n1 - n2 + n3 - 2 * swaps;
+    double denominator = std::sqrt((n0 - n1) * (n0 - n2));
+    if (denominator <= 0.0)
+        return result;
+    result.estimate = s / denominator;
+
+    //Normal approximation with the variance corrected for ties, as in R's cor.test
+    double varS = (count * (count - 1) * (2 * count + 5) - vt - vu) / 18
+                + x1 * y1 / (2 * count * (count - 1))
+                + x2 * y2 / (9 * count * (count - 1) * (count - 2));
+    result.statistic = s / std::sqrt(varS);
+    result.pValue = normalPValue(result.statistic);
+
+    return result;
+}
+
+CorrelationResult correlationTest(CorrelationMethod method, const double *x, const double *y, std::size_t n)
+{
+    switch (method)
+    {
+        case CorrelationMethod::Pearson:
+            return pearsonTest(x, y, n);
+        case CorrelationMethod::Spearman:
+            return spearmanTest(x, y, n);
+        case CorrelationMethod::Kendall:
+            return kendallTest(x, y, n);
+    }
+
+    return emptyResult(method, 0);
+}
+
+CorrelationCache::CorrelationCache() : m_filterVersion(0)
+{
+}
+
+const CorrelationResult &CorrelationCache::get(int year, GameColumn x, GameColumn y, CorrelationMethod method,
+                                               const SteamGameTable &table)
+{
+    Key key(year, 0, x, y, method);
+    std::map<Key, CorrelationResult>::const_iterator it = m_results.find(key);
+    if (it != m_results.end())
+        return it->second;
+
+    //Not tested yet, copy both columns out of the table and run the test
+    std::vector<double> xValues(table.size()), yValues(table.size());
+    table.copyColumn(x, xValues.data(), 1.0, kNaN);
+    table.copyColumn(y, yValues.data(), 1.0, kNaN);
+
+    return m_results[key] = correlationTest(method, xValues.data(), yValues.data(), table.size());
+}
+
+const CorrelationResult &CorrelationCache::get(int year, GameColumn x, GameColumn y, CorrelationMethod method,
+                                               const SteamGameTable &table, const RowSelection &selection,
+                                               unsigned filterVersion)
+{
+    if (filterVersion == 0)
+        return get(year, x, y, method, table);
+
+    //Drop the results of the previous filter
+    if (filterVersion != m_filterVersion) {
+        for (std::map<Key, CorrelationResult>::iterator it = m_results.begin(); it != m_results.end(); ) {
+            if (std::get<1>(it->first) != 0)
+                it = m_results.erase(it);
+            else
+                ++it;
+        }
+        m_filterVersion = filterVersion;
+    }
+
+    Key key(year, filterVersion, x, y, method);
+    std::map<Key, CorrelationResult>::const_iterator it = m_results.find(key);
+    if (it != m_results.end())
+        return it->second;
+
+    //Copy both columns, then keep the selected rows at the front
+    std::vector<double> xValues(table.size()), yValues(table.size());
+    table.copyColumn(x, xValues.data(), 1.0, kNaN);
+    table.copyColumn(y, yValues.data(), 1.0, kNaN);
+    std::size_t n = selection.compact(xValues.data());
+    selection.compact(yValues.data());
+
+    return m_results[key] = correlationTest(method, xValues.data(), yValues.data(), n);
+}
+
+void CorrelationCache::append(int year, const SteamGameTable &table, std::size_t firstRow)
+{
+    for (std::map<Key, CorrelationResult>::iterator it = m_results.begin(); it != m_results.end(); ) {
+        const Key &key = it->first;
+        if (std::get<0>(key) != year) {
+            ++it;
+            continue;
+        }
+
+        //Ranks depend on every value, and selections change with the rows, so those are tested again
+        if (std::get<1>(key) != 0 || std::get<4>(key) != CorrelationMethod::Pearson) {
+            m_pearson.erase(key);
+            it = m_results.erase(it);
+            continue;
+        }
+
+        //The sums of a Pearson test only need the new rows, once they have been made for the others
+        GameColumn x = std::get<2>(key), y = std::get<3>(key);
+        std::map<Key, PearsonAccumulator>::iterator sums = m_pearson.find(key);
+        std::size_t first = firstRow;
+        if (sums == m_pearson.end()) {
+            sums = m_pearson.insert(std::make_pair(key, PearsonAccumulator())).first;
+            first = 0;
+        }
+        for (std::size_t row = first; row < table.size(); ++row)
+            sums->second.add(table.value(x, row), table.value(y, row));
+
+        it->second = sums->second.result();
+        ++it;
+    }
+}
+
+void CorrelationCache::clear()
+{
+    m_results.clear();
+    m_pearson.clear();
+    m_filterVersion = 0;
+}
@@ -0,0 +1,90 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Native correlation tests (Pearson, Spearman and Kendall), replacing R's cor.test
+//
+// Author: Francois Stelluti
+//
+
+#ifndef Correlation_H
+#define Correlation_H
+
+#include "GameFilter.h"
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <map>
+#include <tuple>
+
+enum class CorrelationMethod {
+    Pearson,
+    Spearman,
+    Kendall
+};
+
+//Result of a correlation test, with the same meaning as the fields of R's cor.test
+struct CorrelationResult
+{
+    CorrelationMethod method;
+    std::size_t n;          //Number of complete observations
+    double estimate;        //r, rho or tau
+    double statistic;       //t for Pearson and Spearman, z for Kendall
+    double pValue;          //Two-sided p-value
+};
+
+//Streaming Pearson correlation. Keeps the means and co-moments, updated one pair at a time,
+//so that it never needs a second pass and two accumulators can be merged
+class PearsonAccumulator
+{
+public:
+    PearsonAccumulator();
+
+    void add(double x, double y);                   //Pairs with a NaN are ignored
+    void merge(const PearsonAccumulator &other);
+    CorrelationResult result() const;
+
+private:
+    std::size_t m_n;
+    double m_meanX, m_meanY;
+    double m_m2X, m_m2Y, m_coMoment;
+};
+
+//Pearson test from the number of complete pairs, the sums of squared deviations of x and y,
+//and the sum of the products of their deviations
+CorrelationResult pearsonResult(std::size_t n, double m2X, double m2Y, double coMoment);
+
+//Each test only uses the pairs where neither value is NaN, like use='complete.obs'
+CorrelationResult pearsonTest(const double *x, const double *y, std::size_t n);
+CorrelationResult spearmanTest(const double *x, const double *y, std::size_t n);
+CorrelationResult kendallTest(const double *x, const double *y, std::size_t n);
+CorrelationResult correlationTest(CorrelationMethod method, const double *x, const double *y, std::size_t n);
+
+//Two-sided p-value of a Student t statistic, and of a standard normal statistic
+double studentTPValue(double t, double degreesOfFreedom);
+double normalPValue(double z);
+
+//Results of correlation tests on the columns of each year, computed the first time they are asked for.
+//Tests on a selection of the rows are keyed by the version of the filter that made it (0 for the whole
+//table). Only the latest filter version is kept, as the previous ones won't be seen again
+class CorrelationCache
+{
+public:
+    CorrelationCache();
+
+    const CorrelationResult &get(int year, GameColumn x, GameColumn y, CorrelationMethod method,
+                                 const SteamGameTable &table);
+    const CorrelationResult &get(int year, GameColumn x, GameColumn y, CorrelationMethod method,
+                                 const SteamGameTable &table, const RowSelection &selection, unsigned filterVersion);
+
+    //Rows from firstRow on have been appended to the table of a year. Pearson tests of the whole table
+    //are updated from running sums, which only go through the new rows; the other tests are dropped
+    void append(int year, const SteamGameTable &table, std::size_t firstRow);
+    void clear();
+
+private:
+    typedef std::tuple<int, unsigned, GameColumn, GameColumn, CorrelationMethod> Key;
+    std::map<Key, CorrelationResult> m_results;
+    std::map<Key, PearsonAccumulator> m_pearson;    //Sums of the Pearson tests updated by append()
+    unsigned m_filterVersion;               //Filter version of the filtered results kept
+};
+
+#endif
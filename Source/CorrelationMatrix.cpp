@@ -0,0 +1,153 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Pearson correlation of every pair of columns, for every year, computed in parallel
+//
+// Author: Francois Stelluti
+//
+
+#include "CorrelationMatrix.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+//A column with its mean removed. Missing values are stored as 0 and flagged in valid
+struct CenteredColumn {
+    std::vector<double> values;
+    std::vector<unsigned char> valid;
+    bool complete;              //True if no value is missing
+};
+
+void centerColumn(const SteamGameTable &table, GameColumn column, CenteredColumn &centered)
+{
+    std::size_t n = table.size();
+    centered.values.resize(n);
+    centered.valid.resize(n);
+    table.copyColumn(column, centered.values.data(), 1.0, std::numeric_limits<double>::quiet_NaN());
+
+    double sum = 0.0;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        centered.valid[i] = !std::isnan(centered.values[i]);
+        if (centered.valid[i]) {
+            sum += centered.values[i];
+            ++count;
+        }
+    }
+
+    double mean = count > 0 ? sum / count : 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+        centered.values[i] = centered.valid[i] ? centered.values[i] - mean : 0.0;
+    centered.complete = count == n;
+}
+
+//Pearson test of two centered columns over the rows where both are present.
+//The co-moments don't depend on the shift, so centering on the whole column is fine
+CorrelationResult correlateCentered(const CenteredColumn &x, const CenteredColumn &y)
+{
+    const double *a = x.values.data();
+    const double *b = y.values.data();
+    std::size_t rows = x.values.size();
+
+    double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+    std::size_t n = 0;
+
+    if (x.complete && y.complete) {
+        for (std::size_t i = 0; i < rows; ++i) {
+            sumA += a[i];
+            sumB += b[i];
+            sumAA += a[i] * a[i];
+            sumBB += b[i] * b[i];
+            sumAB += a[i] * b[i];
+        }
+        n = rows;
+    }
+    else {
+        for (std::size_t i = 0; i < rows; ++i) {
+            if (x.valid[i] && y.valid[i]) {
+                sumA += a[i];
+                sumB += b[i];
+                sumAA += a[i] * a[i];
+                sumBB += b[i] * b[i];
+                sumAB += a[i] * b[i];
+                ++n;
+            }
+        }
+    }
+
+    if (n == 0)
+        return pearsonResult(0, 0.0, 0.0, 0.0);
+
+    return pearsonResult(n, sumAA - sumA * sumA / n, sumBB - sumB * sumB / n, sumAB - sumA * sumB / n);
+}
+
+} // namespace
+
+const std::vector<int> &CorrelationMatrix::years() const
+{
+    return m_years;
+}
+
+const std::vector<GameColumn> &CorrelationMatrix::columns() const
+{
+    return m_columns;
+}
+
+const CorrelationResult &CorrelationMatrix::at(std::size_t yearIndex, std::size_t i, std::size_t j) const
+{
+    std::size_t k = m_columns.size();
+    return m_results[(yearIndex * k + i) * k + j];
+}
+
+void CorrelationMatrix::writeCsv(std::ostream &out) const
+{
+    out << "\"Year\",\"X\",\"Y\",\"n\",\"r\",\"t\",\"p-value\"\n";
+
+    for (std::size_t year = 0; year < m_years.size(); ++year) {
+        for (std::size_t i = 0; i < m_columns.size(); ++i) {
+            for (std::size_t j = 0; j < m_columns.size(); ++j) {
+                const CorrelationResult &result = at(year, i, j);
+                out << m_years[year] << ",\"" << gameColumnName(m_columns[i]) << "\",\""
+                    << gameColumnName(m_columns[j]) << "\"," << result.n << ","
+                    << result.estimate << "," << result.statistic << "," << result.pValue << "\n";
+            }
+        }
+    }
+}
+
+CorrelationMatrix CorrelationMatrix::compute(const YearTables &tables, const std::vector<GameColumn> &columns, ThreadPool &pool)
+{
+    CorrelationMatrix matrix;
+    matrix.m_columns = columns;
+
+    std::size_t numYears = tables.size();
+    std::size_t k = columns.size();
+    for (std::size_t year = 0; year < numYears; ++year)
+        matrix.m_years.push_back(tables[year].first);
+
+    //First pass: center every column of every year once
+    std::vector<CenteredColumn> centered(numYears * k);
+    pool.parallelFor(numYears * k, [&](std::size_t task) {
+        centerColumn(*tables[task / k].second, columns[task % k], centered[task]);
+    });
+
+    //Second pass: one task per pair of columns in the upper triangle, diagonal included
+    std::vector<std::pair<std::size_t, std::size_t> > pairs;
+    for (std::size_t i = 0; i < k; ++i)
+        for (std::size_t j = i; j < k; ++j)
+            pairs.push_back(std::make_pair(i, j));
+
+    matrix.m_results.resize(numYears * k * k);
+    pool.parallelFor(numYears * pairs.size(), [&](std::size_t task) {
+        std::size_t year = task / pairs.size();
+        std::size_t i = pairs[task % pairs.size()].first;
+        std::size_t j = pairs[task % pairs.size()].second;
+
+        CorrelationResult result = correlateCentered(centered[year * k + i], centered[year * k + j]);
+        matrix.m_results[(year * k + i) * k + j] = result;
+        matrix.m_results[(year * k + j) * k + i] = result;
+    });
+
+    return matrix;
+}
@@ -0,0 +1,46 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Pearson correlation of every pair of columns, for every year, computed in parallel
+//
+// Author: Francois Stelluti
+//
+
+#ifndef CorrelationMatrix_H
+#define CorrelationMatrix_H
+
+#include "Correlation.h"
+#include "SteamGameTable.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<int, std::shared_ptr<const SteamGameTable> > > YearTables;
+
+//Correlation of every pair of columns for each year. The matrix of a year is symmetric
+class CorrelationMatrix
+{
+public:
+    const std::vector<int> &years() const;
+    const std::vector<GameColumn> &columns() const;
+
+    //Result for the columns at positions i and j of columns(), in the year at position yearIndex of years()
+    const CorrelationResult &at(std::size_t yearIndex, std::size_t i, std::size_t j) const;
+
+    //Write one line per year and pair of columns: year, x, y, n, r, t and p-value
+    void writeCsv(std::ostream &out) const;
+
+    //Compute the matrix of the given columns for every year on the thread pool.
+    //Each column is centered once, and the centered values are shared by all of its pairs
+    static CorrelationMatrix compute(const YearTables &tables, const std::vector<GameColumn> &columns, ThreadPool &pool);
+
+private:
+    std::vector<int> m_years;
+    std::vector<GameColumn> m_columns;
+    std::vector<CorrelationResult> m_results;     //Year major, then row and column
+};
+
+#endif
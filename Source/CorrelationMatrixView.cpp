@@ -0,0 +1,136 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window showing the correlation matrix of each year as a heatmap, with CSV export
+//
+// Author: Francois Stelluti
+//
+
+#include "CorrelationMatrixView.h"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QVBoxLayout>
+
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+//White for no correlation, fading to red for +1 and blue for -1
+QColor heatmapColour(double r)
+{
+    if (std::isnan(r))
+        return QColor(200, 200, 200);
+
+    int fade = static_cast<int>(255 * (1.0 - std::fabs(r)));
+    return r > 0 ? QColor(255, fade, fade) : QColor(fade, fade, 255);
+}
+
+} // namespace
+
+CorrelationHeatmap::CorrelationHeatmap(QWidget *parent) : QWidget(parent), m_matrix(0), m_yearIndex(0)
+{
+    setMinimumSize(480, 400);
+}
+
+void CorrelationHeatmap::setMatrix(const CorrelationMatrix *matrix, int yearIndex)
+{
+    m_matrix = matrix;
+    m_yearIndex = yearIndex;
+    update();
+}
+
+void CorrelationHeatmap::paintEvent(QPaintEvent *)
+{
+    if (!m_matrix || m_yearIndex < 0 || m_yearIndex >= static_cast<int>(m_matrix->years().size()))
+        return;
+
+    QPainter painter(this);
+    const std::vector<GameColumn> &columns = m_matrix->columns();
+    int k = static_cast<int>(columns.size());
+
+    //Leave room for the column names on the left and at the top
+    const int labelWidth = 90, labelHeight = 30;
+    int cellWidth = (width() - labelWidth) / k;
+    int cellHeight = (height() - labelHeight) / k;
+
+    for (int i = 0; i < k; ++i) {
+        QString name = gameColumnName(columns[i]);
+        painter.drawText(QRect(0, labelHeight + i * cellHeight, labelWidth - 5, cellHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, name);
+        painter.drawText(QRect(labelWidth + i * cellWidth, 0, cellWidth, labelHeight),
+                         Qt::AlignCenter | Qt::TextWordWrap, name);
+    }
+
+    for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < k; ++j) {
+            double r = m_matrix->at(m_yearIndex, i, j).estimate;
+            QRect cell(labelWidth + j * cellWidth, labelHeight + i * cellHeight, cellWidth, cellHeight);
+
+            painter.fillRect(cell, heatmapColour(r));
+            painter.setPen(Qt::darkGray);
+            painter.drawRect(cell);
+            painter.setPen(Qt::black);
+            painter.drawText(cell, Qt::AlignCenter, std::isnan(r) ? QString("N/A") : QString::number(r, 'f', 2));
+        }
+    }
+}
+
+CorrelationMatrixView::CorrelationMatrixView(QWidget *parent) : QWidget(parent)
+{
+    setWindowTitle("Correlation Matrix");
+
+    m_heatmap = new CorrelationHeatmap();
+    yearCombo = new QComboBox();
+    yearCombo->setFixedWidth(75);
+    exportButton = new QPushButton("Export CSV");
+    exportButton->setToolTip("Save the coefficients and p-values of every year to a CSV file");
+    exportButton->setMaximumWidth(120);
+
+    QObject::connect(yearCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(showYear(int)));
+    QObject::connect(exportButton, SIGNAL(released()), this, SLOT(exportCsv()));
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->addWidget(new QLabel(tr("Year:")));
+    controls->addWidget(yearCombo);
+    controls->addStretch();
+    controls->addWidget(exportButton);
+
+    QVBoxLayout *outer = new QVBoxLayout();
+    outer->addLayout(controls);
+    outer->addWidget(m_heatmap);
+    setLayout(outer);
+}
+
+void CorrelationMatrixView::setMatrix(const CorrelationMatrix &matrix)
+{
+    m_matrix = matrix;
+
+    //Refill the year selection without redrawing for every item
+    yearCombo->blockSignals(true);
+    yearCombo->clear();
+    for (std::size_t i = 0; i < m_matrix.years().size(); ++i)
+        yearCombo->addItem(QString::number(m_matrix.years()[i]));
+    yearCombo->setCurrentIndex(0);
+    yearCombo->blockSignals(false);
+
+    showYear(0);
+}
+
+void CorrelationMatrixView::showYear(int index)
+{
+    m_heatmap->setMatrix(&m_matrix, index);
+}
+
+void CorrelationMatrixView::exportCsv(void)
+{
+    QString file = QFileDialog::getSaveFileName(this, tr("Export correlation matrix"), "correlations.csv",
+                                                tr("CSV files (*.csv)"));
+    if (file.isEmpty())
+        return;
+
+    std::ofstream out(file.toStdString().c_str());
+    m_matrix.writeCsv(out);
+}
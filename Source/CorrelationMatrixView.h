@@ -0,0 +1,55 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window showing the correlation matrix of each year as a heatmap, with CSV export
+//
+// Author: Francois Stelluti
+//
+
+#ifndef CorrelationMatrixView_H
+#define CorrelationMatrixView_H
+
+#include "CorrelationMatrix.h"
+
+#include <QWidget>
+#include <QComboBox>
+#include <QPushButton>
+
+//Draws the matrix of one year, red for positive and blue for negative coefficients
+class CorrelationHeatmap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CorrelationHeatmap(QWidget *parent = 0);
+
+    void setMatrix(const CorrelationMatrix *matrix, int yearIndex);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    const CorrelationMatrix *m_matrix;
+    int m_yearIndex;
+};
+
+class CorrelationMatrixView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CorrelationMatrixView(QWidget *parent = 0);
+
+    void setMatrix(const CorrelationMatrix &matrix);
+
+private slots:
+    void showYear(int index);       //Display the matrix of the year selected in yearCombo
+    void exportCsv(void);           //Save the whole matrix to a CSV file
+
+private:
+    CorrelationMatrix m_matrix;
+    CorrelationHeatmap *m_heatmap;
+    QComboBox *yearCombo;
+    QPushButton *exportButton;
+};
+
+#endif
@@ -0,0 +1,128 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Reads the records appended to a SteamSpy CSV file since it was last read, like tail -f
+//
+// Author: Francois Stelluti
+//
+
+#include "CsvFollower.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace {
+
+//Enough for the header of a SteamSpy export
+const uint64_t kHeaderBytes = 64 * 1024;
+
+//Bytes before the offset that must be unchanged for the file to have been appended to
+const uint64_t kCheckedBytes = 64;
+
+} // namespace
+
+CsvFollower::CsvFollower() : m_offset(0), m_needsNewline(false)
+{
+    m_source.size = 0;
+    m_source.modified = 0;
+}
+
+bool CsvFollower::start(const std::string &path, const SnapshotSource &source)
+{
+    m_path = path;
+    m_source = source;
+    m_offset = 0;
+    m_lastBytes.clear();
+    m_parser.reset();
+
+    std::string header;
+    if (source.size == 0 || !readRange(0, std::min(source.size, kHeaderBytes), header))
+        return false;
+    m_parser.parseHeader(header.data(), header.data() + header.size());
+
+    //Exports often don't end with a newline: the last record was read as complete, so what is appended
+    //has to start with one
+    std::string lastBytes;
+    if (!readRange(source.size - std::min(source.size, kCheckedBytes), source.size, lastBytes) || lastBytes.empty())
+        return false;
+
+    m_lastBytes = lastBytes;
+    m_needsNewline = lastBytes[lastBytes.size() - 1] != '\n';
+    m_offset = source.size;
+    return true;
+}
+
+CsvFollower::Change CsvFollower::poll(SteamGameTable &rows)
+{
+    rows.clear();
+
+    //A file that is missing for now is being replaced, it will be seen again when it is back
+    SnapshotSource source;
+    if (!snapshotSource(m_path, source))
+        return Unchanged;
+    if (source.size == m_source.size && source.modified == m_source.modified)
+        return Unchanged;
+    if (!isFollowing() || source.size < m_offset)
+        return Rewritten;
+
+    //Read from just before the offset, so that the bytes that were already there can be checked
+    std::string bytes;
+    uint64_t from = m_offset - m_lastBytes.size();
+    if (!readRange(from, source.size, bytes) || bytes.compare(0, m_lastBytes.size(), m_lastBytes) != 0)
+        return Rewritten;
+
+    //Only touched
+    std::size_t start = m_lastBytes.size();
+    if (bytes.size() == start) {
+        m_source = source;
+        return Unchanged;
+    }
+
+    //Anything else than a newline after a record read as the last one changes that record
+    std::size_t consumed = 0;
+    if (m_needsNewline) {
+        std::string next = bytes.substr(start, 2);
+        if (next == "\r")
+            return Unchanged;
+        if (next[0] == '\n')
+            consumed = 1;
+        else if (next == "\r\n")
+            consumed = 2;
+        else
+            return Rewritten;
+        m_needsNewline = false;
+    }
+
+    consumed += m_parser.parseBuffer(bytes.data() + start + consumed, bytes.data() + bytes.size(), rows, false);
+
+    if (consumed > 0) {
+        m_offset += consumed;
+        std::size_t read = start + consumed;
+        std::size_t kept = static_cast<std::size_t>(std::min<uint64_t>(read, kCheckedBytes));
+        m_lastBytes.assign(bytes, read - kept, kept);
+    }
+    m_source = source;
+
+    return rows.size() > 0 ? Appended : Unchanged;
+}
+
+bool CsvFollower::isFollowing() const
+{
+    return m_offset > 0;
+}
+
+uint64_t CsvFollower::offset() const
+{
+    return m_offset;
+}
+
+bool CsvFollower::readRange(uint64_t from, uint64_t to, std::string &bytes) const
+{
+    std::ifstream in(m_path.c_str(), std::ios::in | std::ios::binary);
+    if (!in || !in.seekg(static_cast<std::streamoff>(from)))
+        return false;
+
+    bytes.resize(static_cast<std::size_t>(to - from));
+    if (!bytes.empty() && !in.read(&bytes[0], static_cast<std::streamsize>(bytes.size())))
+        return false;
+    return true;
+}
@@ -0,0 +1,53 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Reads the records appended to a SteamSpy CSV file since it was last read, like tail -f
+//
+// Author: Francois Stelluti
+//
+
+#ifndef CsvFollower_H
+#define CsvFollower_H
+
+#include "SteamCsvParser.h"
+#include "SteamGameTable.h"
+#include "TableSnapshot.h"
+
+#include <stdint.h>
+#include <string>
+
+//Follows a CSV file whose start has already been parsed into a table. Appends are told apart from rewrites
+//by the size of the file and the last bytes that were read, which must still be in the same place
+class CsvFollower
+{
+public:
+    enum Change {
+        Unchanged,          //Nothing new, or only part of a record
+        Appended,           //New records were read
+        Rewritten           //The file was replaced, truncated or edited: it has to be read again
+    };
+
+    CsvFollower();
+
+    //Follow a file, of which the complete records in the bytes of source (its stamp when it was read)
+    //have been parsed. Returns false, and follows nothing, if the file can't be followed from there
+    bool start(const std::string &path, const SnapshotSource &source);
+
+    //Parse the complete records appended since the last call into rows, which is cleared first.
+    //A record that is still being written is left for the next call
+    Change poll(SteamGameTable &rows);
+
+    bool isFollowing() const;
+    uint64_t offset() const;                //Bytes of the file read so far
+
+private:
+    bool readRange(uint64_t from, uint64_t to, std::string &bytes) const;
+
+    std::string m_path;
+    SnapshotSource m_source;                //Stamp of the file when it was last read
+    uint64_t m_offset;
+    std::string m_lastBytes;                //The bytes just before m_offset
+    bool m_needsNewline;                    //The last record read had no newline after it
+    SteamCsvParser m_parser;                //Holds the header of the file
+};
+
+#endif
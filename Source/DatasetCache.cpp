@@ -0,0 +1,335 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// LRU cache of parsed years of data, with background preloading
+//
+// Author: Francois Stelluti
+//
+
+#include "DatasetCache.h"
+#include "NameDictionary.h"
+#include "TableSnapshot.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace {
+
+//Rows appended to a table are left out of its index, and looked at by every query, until there are this many
+//or a sixteenth of the table. Reindexing is then spread over enough appends to cost little
+const std::size_t kMinUnindexedRows = 4096;
+
+//Memory of a view of a table that rows are still appended to: the table, and a copy of its score bitmaps
+struct GrowingRows {
+    std::shared_ptr<const SteamGameTable> table;
+    std::vector<uint64_t> userscoreMask, metascoreMask;
+};
+
+//View of the rows a table has so far. The other columns aren't written to while the table grows within its
+//capacity, but the last word of each score bitmap is
+std::shared_ptr<const SteamGameTable> viewRows(const std::shared_ptr<const SteamGameTable> &table)
+{
+    std::shared_ptr<GrowingRows> storage = std::make_shared<GrowingRows>();
+    std::size_t words = (table->size() + 63) / 64;
+    storage->table = table;
+    storage->userscoreMask.assign(table->userscoreMask(), table->userscoreMask() + words);
+    storage->metascoreMask.assign(table->metascoreMask(), table->metascoreMask() + words);
+
+    SteamGameColumns columns = table->columns();
+    columns.userscoreMask = storage->userscoreMask.data();
+    columns.metascoreMask = storage->metascoreMask.data();
+    return std::make_shared<const SteamGameTable>(table->size(), columns, storage);
+}
+
+//Copy of the name ids of a growing table, holding on to their references until it is destroyed
+std::shared_ptr<const std::vector<uint32_t> > copyIds(const std::shared_ptr<std::vector<uint32_t> > &ids)
+{
+    std::shared_ptr<const std::vector<uint32_t> > held = ids;
+    return std::shared_ptr<const std::vector<uint32_t> >(new std::vector<uint32_t>(*ids),
+                                                         [held](const std::vector<uint32_t> *copy) { delete copy; });
+}
+
+} // namespace
+
+DatasetCache::DatasetCache(std::size_t memoryBudget) :
+    m_memoryBudget(memoryBudget), m_memoryUsage(0), m_stopPreload(false)
+{
+}
+
+DatasetCache::~DatasetCache()
+{
+    stopPreload();
+}
+
+YearDataset DatasetCache::get(const std::string &path)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    //Wait if another thread is already parsing this file, rather than parsing it twice
+    while (true) {
+        std::map<std::string, Entry>::iterator it = m_entries.find(path);
+        if (it != m_entries.end()) {
+            touch(it->second);
+            return it->second.dataset;
+        }
+        if (m_loading.count(path) == 0)
+            break;
+        m_loaded.wait(lock);
+    }
+
+    m_loading.insert(path);
+    lock.unlock();
+
+    //Load the file (from its snapshot if possible), compute its statistics and index it without holding the lock
+    YearDataset dataset;
+    CsvFollower follower;
+    try {
+        //Follow the CSV from where it was read. A catalogue, or a CSV that changed while it was read,
+        //is only read again when it changes
+        SnapshotSource source;
+        dataset.table = loadTable(path, &source);
+        if (source.size == 0)
+            snapshotSource(path, source);
+        follower.start(path, source);
+
+        dataset.summary = summarizeTable(*dataset.table);
+        dataset.stats = computeYearStats(dataset.summary);
+        dataset.index = std::make_shared<const GameIndex>(*dataset.table, ThreadPool::global());
+
+        dataset.nameIds = NameDictionary::global().internTable(*dataset.table);
+    }
+    catch (...) {
+        lock.lock();
+        m_loading.erase(path);
+        m_loaded.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    m_loading.erase(path);
+
+    Entry &entry = m_entries[path];
+    entry.dataset = dataset;
+    entry.appends = std::make_shared<Appends>();
+    entry.appends->follower = follower;
+    entry.bytes = dataset.table->memoryUsage() + dataset.index->memoryUsage() +
+                  dataset.nameIds->capacity() * sizeof(uint32_t);
+    m_lru.push_front(path);
+    entry.lruPosition = m_lru.begin();
+    m_memoryUsage += entry.bytes;
+
+    evict();
+    m_loaded.notify_all();
+
+    return dataset;
+}
+
+DatasetChange DatasetCache::refresh(const std::string &path, YearDataset &dataset)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(path);
+    if (it == m_entries.end()) {
+        lock.unlock();
+        dataset = get(path);
+        return DatasetChange::Reloaded;
+    }
+
+    std::shared_ptr<Appends> appends = it->second.appends;
+    lock.unlock();
+
+    DatasetChange change;
+    {
+        std::lock_guard<std::mutex> appendsLock(appends->mutex);
+        change = appendRows(path, *appends, dataset);
+    }
+
+    //A file that was rewritten or evicted is loaded again without the lock of the file, as get() can wait
+    //for another thread loading it
+    if (change == DatasetChange::Reloaded)
+        dataset = get(path);
+    return change;
+}
+
+DatasetChange DatasetCache::appendRows(const std::string &path, Appends &appends, YearDataset &dataset)
+{
+    SteamGameTable rows;
+    CsvFollower::Change change = appends.follower.poll(rows);
+    if (change == CsvFollower::Unchanged)
+        return DatasetChange::Unchanged;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::map<std::string, Entry>::iterator it = m_entries.find(path);
+    bool current = it != m_entries.end() && it->second.appends.get() == &appends;
+    if (change == CsvFollower::Rewritten) {
+        if (current)
+            remove(it);
+        return DatasetChange::Reloaded;
+    }
+    if (!current)
+        return DatasetChange::Reloaded;
+
+    //The dataset as published by the previous refresh, or by get() if there was none
+    YearDataset updated = it->second.dataset;
+    lock.unlock();
+
+    //The rows are added to a table of the file's own, published as a view of the rows it has so far: the columns
+    //only move when the table outgrows its capacity, and it is then copied into a new table with room for as many
+    //rows again, leaving the old one to the views of it
+    std::size_t nameBytes = rows.nameBytes();
+    if (!appends.growing || !appends.growing->fitsInCapacity(rows.size(), nameBytes)) {
+        const SteamGameTable &table = appends.growing ? *appends.growing : *updated.table;
+        std::shared_ptr<SteamGameTable> grown = std::make_shared<SteamGameTable>(table);
+        grown->reserve(2 * (table.size() + rows.size()), 2 * (table.nameBytes() + nameBytes));
+        appends.growing = grown;
+    }
+    if (!appends.growingIds)
+        appends.growingIds = NameDictionary::global().copyIds(*updated.nameIds);
+
+    for (std::size_t row = 0; row < rows.size(); ++row)
+        appends.growing->appendRow(rows.row(row));
+    NameDictionary::global().internNames(rows, 0, *appends.growingIds);
+    updated.table = viewRows(appends.growing);
+    updated.nameIds = copyIds(appends.growingIds);
+
+    //Only the summary of the new rows is computed, and merged into the one of the others
+    updated.summary.merge(summarizeTable(rows));
+    updated.stats = computeYearStats(updated.summary);
+
+    std::size_t unindexed = appends.growing->size() - updated.index->rows();
+    if (unindexed >= std::max(kMinUnindexedRows, updated.index->rows() / 16))
+        updated.index = std::make_shared<const GameIndex>(*updated.table, ThreadPool::global());
+
+    std::size_t bytes = appends.growing->memoryUsage() + updated.index->memoryUsage() +
+                        appends.growingIds->capacity() * sizeof(uint32_t) + updated.nameIds->size() * sizeof(uint32_t);
+
+    //Publish the dataset, unless the file was evicted in the meantime
+    lock.lock();
+    it = m_entries.find(path);
+    if (it != m_entries.end() && it->second.appends.get() == &appends) {
+        Entry &entry = it->second;
+        entry.dataset = updated;
+
+        //The plots no longer show every game
+        m_memoryUsage -= entry.bytes;
+        entry.plots.clear();
+        entry.bytes = bytes;
+        m_memoryUsage += entry.bytes;
+
+        touch(entry);
+        evict();
+    }
+
+    dataset = updated;
+    return DatasetChange::Appended;
+}
+
+bool DatasetCache::findPlot(const std::string &path, int xVariable, int yVariable, QByteArray &svg)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(path);
+    if (it == m_entries.end())
+        return false;
+
+    std::map<PlotKey, QByteArray>::const_iterator plot = it->second.plots.find(PlotKey(xVariable, yVariable));
+    if (plot == it->second.plots.end())
+        return false;
+
+    touch(it->second);
+    svg = plot->second;
+    return true;
+}
+
+void DatasetCache::storePlot(const std::string &path, int xVariable, int yVariable, const QByteArray &svg)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //Plots are only kept alongside their data file
+    std::map<std::string, Entry>::iterator it = m_entries.find(path);
+    if (it == m_entries.end())
+        return;
+
+    Entry &entry = it->second;
+    QByteArray &stored = entry.plots[PlotKey(xVariable, yVariable)];
+    entry.bytes -= stored.size();
+    m_memoryUsage -= stored.size();
+
+    stored = svg;
+    entry.bytes += svg.size();
+    m_memoryUsage += svg.size();
+
+    touch(entry);
+    evict();
+}
+
+void DatasetCache::preload(const std::vector<std::string> &paths)
+{
+    stopPreload();
+    m_stopPreload = false;
+
+    m_preloadThread = std::thread([this, paths]() {
+        for (std::size_t i = 0; i < paths.size() && !m_stopPreload; ++i) {
+            try {
+                get(paths[i]);
+            }
+            catch (std::exception &e) {
+                std::cout << "Unable to preload " << paths[i] << ": " << e.what() << std::endl;
+            }
+        }
+    });
+}
+
+void DatasetCache::setMemoryBudget(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryBudget = bytes;
+    evict();
+}
+
+std::size_t DatasetCache::memoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryBudget;
+}
+
+std::size_t DatasetCache::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage + NameDictionary::global().memoryUsage();
+}
+
+void DatasetCache::touch(Entry &entry)
+{
+    m_lru.splice(m_lru.begin(), m_lru, entry.lruPosition);
+}
+
+void DatasetCache::remove(std::map<std::string, Entry>::iterator it)
+{
+    m_memoryUsage -= it->second.bytes;
+    m_lru.erase(it->second.lruPosition);
+    m_entries.erase(it);
+}
+
+void DatasetCache::evict()
+{
+    //Always keep the most recently used file, even if it is larger than the budget on its own.
+    //The names of the files are interned in NameDictionary::global(), which shrinks as they are evicted
+    while (m_memoryUsage + NameDictionary::global().memoryUsage() > m_memoryBudget && m_lru.size() > 1) {
+        std::map<std::string, Entry>::iterator it = m_entries.find(m_lru.back());
+        m_memoryUsage -= it->second.bytes;
+        m_entries.erase(it);
+        m_lru.pop_back();
+
+        //The table may have held names still used by the other files
+        NameDictionary::global().prune();
+    }
+}
+
+void DatasetCache::stopPreload()
+{
+    m_stopPreload = true;
+    if (m_preloadThread.joinable())
+        m_preloadThread.join();
+}
@@ -0,0 +1,120 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// LRU cache of parsed years of data, with background preloading
+//
+// Author: Francois Stelluti
+//
+
+#ifndef DatasetCache_H
+#define DatasetCache_H
+
+#include "CsvFollower.h"
+#include "GameIndex.h"
+#include "SteamGameTable.h"
+#include "YearStats.h"
+
+#include <QByteArray>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//A parsed data file and the statistics computed from it
+struct YearDataset
+{
+    std::shared_ptr<const SteamGameTable> table;
+    TableSummary summary;       //Statistics of every column
+    YearStats stats;            //Statistics displayed in the window
+    std::shared_ptr<const GameIndex> index;     //Sorted columns and name trigrams, for the top games
+    std::shared_ptr<const std::vector<uint32_t> > nameIds;     //Id of the name of every row in NameDictionary::global()
+};
+
+//What refresh() found out about a data file
+enum class DatasetChange {
+    Unchanged,
+    Appended,       //Rows were appended to the file, the dataset has them
+    Reloaded        //The file was replaced, the dataset is a new one
+};
+
+//Keeps the most recently used data files in memory, along with their rendered plots.
+//Files are evicted in least recently used order once the memory budget is exceeded.
+//All member functions are thread-safe. Files are read, parsed and indexed without holding the lock, and
+//the datasets handed out are never modified
+class DatasetCache
+{
+public:
+    explicit DatasetCache(std::size_t memoryBudget);
+    ~DatasetCache();
+
+    //Get a data file, loading it if it isn't cached. Throws std::runtime_error if the file can't be read
+    YearDataset get(const std::string &path);
+
+    //Bring a data file up to date with its CSV: the records appended to it since it was read are parsed
+    //and added to the table, its summary and its index, and a file that was rewritten is loaded again.
+    //Plots of the file are dropped when it changes. dataset is set to the data file if it changed
+    DatasetChange refresh(const std::string &path, YearDataset &dataset);
+
+    //Look up or store the SVG plot of two plot variables for a cached data file
+    bool findPlot(const std::string &path, int xVariable, int yVariable, QByteArray &svg);
+    void storePlot(const std::string &path, int xVariable, int yVariable, const QByteArray &svg);
+
+    //Load the given files on a background thread, so that later calls to get() are lookups
+    void preload(const std::vector<std::string> &paths);
+
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t memoryBudget() const;
+    std::size_t memoryUsage() const;        //Bytes used by all cached files, indexes, plots and interned names
+
+private:
+    typedef std::pair<int, int> PlotKey;
+
+    //What refresh() needs to add the rows appended to a data file. It has its own lock, held while the CSV
+    //is read and the new rows are added, so that only one refresh of the file runs at a time. The lock of the
+    //cache may be taken while holding it, never the other way round
+    struct Appends {
+        std::mutex mutex;
+        CsvFollower follower;                       //Reads what is appended to the CSV
+        std::shared_ptr<SteamGameTable> growing;    //The rows so far, once some were appended. Only views are published
+        std::shared_ptr<std::vector<uint32_t> > growingIds;     //Their name ids, only copies are published
+    };
+
+    struct Entry {
+        YearDataset dataset;
+        std::shared_ptr<Appends> appends;
+        std::map<PlotKey, QByteArray> plots;
+        std::size_t bytes;                          //Memory used by the table, its index, name ids and the plots
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    //Add the rows appended to the file to its dataset, holding the lock of the file. Reloaded if it must
+    //be loaded again
+    DatasetChange appendRows(const std::string &path, Appends &appends, YearDataset &dataset);
+
+    void touch(Entry &entry);                       //Mark an entry as the most recently used
+    void remove(std::map<std::string, Entry>::iterator it);
+    void evict();                                   //Remove old entries until within the budget
+    void stopPreload();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_loaded;               //Signalled whenever a file finishes loading
+    std::map<std::string, Entry> m_entries;
+    std::list<std::string> m_lru;                   //Most recently used first
+    std::set<std::string> m_loading;                //Files currently being parsed
+    std::size_t m_memoryBudget;
+    std::size_t m_memoryUsage;
+
+    std::thread m_preloadThread;
+    std::atomic<bool> m_stopPreload;
+};
+
+#endif
@@ -0,0 +1,224 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Histogram and kernel density estimate of one variable, from bins computed once
+//
+// Author: Francois Stelluti
+//
+
+#include "Distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+//Points of the grid padded with zeros, so that the circular convolution of the transforms doesn't wrap
+//the density of one end of the range around to the other
+const std::size_t kTransformSize = 2 * kDensityPoints;
+
+//In place radix-2 Fourier transform, the size must be a power of two. The inverse is scaled by 1/size
+void fft(std::vector<std::complex<double> > &a, bool inverse)
+{
+    std::size_t n = a.size();
+    for (std::size_t i = 1, j = 0; i < n; ++i) {
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(a[i], a[j]);
+    }
+
+    for (std::size_t length = 2; length <= n; length <<= 1) {
+        double angle = (inverse ? 2.0 : -2.0) * kPi / length;
+        std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (std::size_t start = 0; start < n; start += length) {
+            std::complex<double> twiddle(1.0, 0.0);
+            for (std::size_t k = 0; k < length / 2; ++k) {
+                std::complex<double> even = a[start + k];
+                std::complex<double> odd = a[start + k + length / 2] * twiddle;
+                a[start + k] = even + odd;
+                a[start + k + length / 2] = even - odd;
+                twiddle *= step;
+            }
+        }
+    }
+
+    if (inverse)
+        for (std::size_t i = 0; i < n; ++i)
+            a[i] /= static_cast<double>(n);
+}
+
+//Quantile of the binned values, interpolated between grid points
+double gridQuantile(const std::vector<double> &grid, double total, double lo, double delta, double q)
+{
+    double target = q * total, cumulative = 0.0;
+    for (std::size_t i = 0; i < grid.size(); ++i) {
+        if (cumulative + grid[i] >= target && grid[i] > 0.0)
+            return lo + delta * (i == 0 ? 0.0 : i - 1 + (target - cumulative) / grid[i]);
+        cumulative += grid[i];
+    }
+    return lo + delta * (grid.size() - 1);
+}
+
+} // namespace
+
+Distribution::Distribution() : m_logScale(false), m_count(0), m_lo(0.0), m_hi(1.0), m_sd(0.0)
+{
+}
+
+Distribution::Distribution(const std::vector<double> &values, bool logScale) :
+    m_logScale(logScale), m_count(0), m_lo(0.0), m_hi(1.0), m_sd(0.0)
+{
+    //Range of the values, then on the scale of the bins, which keeps their order
+    double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[i]) || (logScale && values[i] <= -1.0))
+            continue;
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    if (!(lo <= hi))
+        return;
+    lo = toScale(lo, logScale);
+    hi = toScale(hi, logScale);
+    if (hi == lo) {
+        lo -= 0.5;
+        hi += 0.5;
+    }
+    m_lo = lo;
+    m_hi = hi;
+
+    //The only pass over the values: each one is added to its bar, and split between the two grid points
+    //around it in proportion to how close it is to each
+    m_histogram.assign(kHistogramBins, 0.0);
+    m_grid.assign(kDensityPoints, 0.0);
+    double delta = (hi - lo) / (kDensityPoints - 1);
+    double sum = 0.0, sumSquares = 0.0;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        double x = toScale(values[i], logScale);
+        if (std::isnan(x))
+            continue;
+
+        double offset = x - lo;
+        std::size_t bar = std::min(static_cast<std::size_t>(offset / (hi - lo) * kHistogramBins), kHistogramBins - 1);
+        m_histogram[bar] += 1.0;
+
+        double position = offset / delta;
+        std::size_t point = std::min(static_cast<std::size_t>(position), kDensityPoints - 2);
+        double fraction = position - point;
+        m_grid[point] += 1.0 - fraction;
+        m_grid[point + 1] += fraction;
+
+        sum += offset;
+        sumSquares += offset * offset;
+        ++m_count;
+    }
+
+    double mean = sum / m_count;
+    if (m_count > 1)
+        m_sd = std::sqrt(std::max(0.0, sumSquares / m_count - mean * mean) * m_count / (m_count - 1));
+
+    m_gridTransform.assign(kTransformSize, std::complex<double>(0.0, 0.0));
+    for (std::size_t i = 0; i < kDensityPoints; ++i)
+        m_gridTransform[i] = m_grid[i];
+    fft(m_gridTransform, false);
+}
+
+std::size_t Distribution::count() const
+{
+    return m_count;
+}
+
+bool Distribution::logScale() const
+{
+    return m_logScale;
+}
+
+double Distribution::lo() const
+{
+    return m_lo;
+}
+
+double Distribution::hi() const
+{
+    return m_hi;
+}
+
+double Distribution::gridPoint(std::size_t i) const
+{
+    return m_lo + (m_hi - m_lo) * i / (kDensityPoints - 1);
+}
+
+const std::vector<double> &Distribution::histogram() const
+{
+    return m_histogram;
+}
+
+double Distribution::defaultBandwidth() const
+{
+    double delta = (m_hi - m_lo) / (kDensityPoints - 1);
+    if (m_count < 2)
+        return delta;
+
+    //The smaller of the standard deviation and the interquartile range, as in R's bw.nrd0
+    double iqr = gridQuantile(m_grid, m_count, m_lo, delta, 0.75) - gridQuantile(m_grid, m_count, m_lo, delta, 0.25);
+    double spread = std::min(m_sd, iqr / 1.34);
+    if (!(spread > 0.0))
+        spread = m_sd > 0.0 ? m_sd : iqr;
+    double bandwidth = 0.9 * spread * std::pow(static_cast<double>(m_count), -0.2);
+
+    return bandwidth > 0.0 ? bandwidth : delta;
+}
+
+void Distribution::density(double bandwidth, std::vector<double> &out) const
+{
+    out.clear();
+    if (m_count == 0)
+        return;
+
+    //Kernel at the grid offsets within 4 bandwidths, both ways round the padded grid. Its weights are made
+    //to add up to 1, so that a bandwidth narrower than the grid still keeps the weight of every value
+    double delta = (m_hi - m_lo) / (kDensityPoints - 1);
+    bandwidth = std::max(bandwidth, delta * 1e-3);
+    std::size_t reach = static_cast<std::size_t>(std::min<double>(kDensityPoints - 1, std::ceil(4.0 * bandwidth / delta)));
+
+    std::vector<std::complex<double> > kernel(kTransformSize, std::complex<double>(0.0, 0.0));
+    double total = 0.0;
+    for (std::size_t j = 0; j <= reach; ++j) {
+        double z = j * delta / bandwidth;
+        double weight = std::exp(-0.5 * z * z);
+        kernel[j] = weight;
+        if (j > 0)
+            kernel[kTransformSize - j] = weight;
+        total += j > 0 ? 2.0 * weight : weight;
+    }
+
+    //Convolution of the grid and the kernel, as the product of their transforms
+    fft(kernel, false);
+    for (std::size_t k = 0; k < kTransformSize; ++k)
+        kernel[k] *= m_gridTransform[k];
+    fft(kernel, true);
+
+    //Rounding can leave tiny negative values where there are no values at all
+    out.resize(kDensityPoints);
+    double scale = 1.0 / (total * m_count * delta);
+    for (std::size_t i = 0; i < kDensityPoints; ++i)
+        out[i] = std::max(0.0, kernel[i].real() * scale);
+}
+
+double Distribution::toScale(double value, bool logScale)
+{
+    if (!logScale)
+        return value;
+    return value > -1.0 ? std::log10(1.0 + value) : std::numeric_limits<double>::quiet_NaN();
+}
+
+double Distribution::fromScale(double position, bool logScale)
+{
+    return logScale ? std::pow(10.0, position) - 1.0 : position;
+}
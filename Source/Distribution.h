@@ -0,0 +1,60 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Histogram and kernel density estimate of one variable, from bins computed once
+//
+// Author: Francois Stelluti
+//
+
+#ifndef Distribution_H
+#define Distribution_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+//Bars of the histogram, and points at which the density is estimated
+const std::size_t kHistogramBins = 40;
+const std::size_t kDensityPoints = 2048;
+
+//The values are read once, into the bars of the histogram and a linearly binned grid: each value is shared
+//between the two nearest grid points. The density is the grid convolved with a Gaussian kernel, done as a
+//product of Fourier transforms, so a new bandwidth costs a few transforms of the grid whatever the number
+//of values. On a log scale, the values are binned as log10(1 + value)
+class Distribution
+{
+public:
+    Distribution();
+    Distribution(const std::vector<double> &values, bool logScale);     //NaN values are left out
+
+    std::size_t count() const;          //Values binned
+    bool logScale() const;
+
+    //Range of the bins and grid, on the scale of the bins
+    double lo() const;
+    double hi() const;
+    double gridPoint(std::size_t i) const;
+
+    //Number of values in each bar of the histogram
+    const std::vector<double> &histogram() const;
+
+    //Silverman's rule of thumb, on the scale of the bins
+    double defaultBandwidth() const;
+
+    //Density at every grid point, on the scale of the bins. Empty without values
+    void density(double bandwidth, std::vector<double> &out) const;
+
+    //Between the values and the scale of the bins
+    static double toScale(double value, bool logScale);
+    static double fromScale(double position, bool logScale);
+
+private:
+    bool m_logScale;
+    std::size_t m_count;
+    double m_lo, m_hi;
+    double m_sd;                                        //Standard deviation, on the scale of the bins
+    std::vector<double> m_histogram;
+    std::vector<double> m_grid;                         //Linearly binned weights
+    std::vector<std::complex<double> > m_gridTransform; //Of the grid padded with zeros, reused for every bandwidth
+};
+
+#endif
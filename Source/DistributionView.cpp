@@ -0,0 +1,238 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Histogram and kernel density of one plot variable, with a log scale and a bandwidth slider
+//
+// Author: Francois Stelluti
+//
+
+#include "DistributionView.h"
+#include "PerfTrace.h"
+#include "ScatterPlot.h"
+
+#include <QHBoxLayout>
+#include <QPainterPath>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//The slider goes from a tenth to ten times the default bandwidth, in steps of the same ratio
+const int kSliderSteps = 100;
+
+//Values of the ticks of the x axis. On a log scale, 0 and the powers of ten
+std::vector<double> valueTicks(double lo, double hi, bool logScale)
+{
+    if (!logScale)
+        return axisTicks(lo, hi, 5);
+
+    std::vector<double> ticks;
+    double top = Distribution::fromScale(hi, true);
+    for (double value = 0.0; value <= top * (1.0 + 1e-9); value = value == 0.0 ? 1.0 : value * 10.0)
+        if (Distribution::toScale(value, true) >= lo - 1e-9)
+            ticks.push_back(value);
+
+    //Every other power of ten once there are too many to read
+    std::vector<double> thinned;
+    for (std::size_t i = 0; i < ticks.size(); i += ticks.size() > 8 ? 2 : 1)
+        thinned.push_back(ticks[i]);
+    return thinned;
+}
+
+} // namespace
+
+void drawDistribution(QPainter &painter, const QRect &rect, const Distribution &distribution,
+                      const std::vector<double> &density, const QString &label)
+{
+    painter.save();
+    painter.fillRect(rect, Qt::white);
+
+    QFontMetrics metrics(painter.font());
+    int lineHeight = metrics.height();
+    QRect panel = scatterPlotPanel(metrics, rect);
+    if (panel.width() <= 0 || panel.height() <= 0 || distribution.count() == 0) {
+        painter.restore();
+        return;
+    }
+
+    //Bars are drawn as densities, so that they share the y axis with the curve
+    double lo = distribution.lo(), hi = distribution.hi();
+    const std::vector<double> &bars = distribution.histogram();
+    double barWidth = (hi - lo) / bars.size();
+    double barScale = 1.0 / (distribution.count() * barWidth);
+
+    double yMax = 0.0;
+    for (std::size_t i = 0; i < bars.size(); ++i)
+        yMax = std::max(yMax, bars[i] * barScale);
+    for (std::size_t i = 0; i < density.size(); ++i)
+        yMax = std::max(yMax, density[i]);
+    yMax = yMax > 0.0 ? yMax * 1.05 : 1.0;
+
+    double xScale = panel.width() / (hi - lo);
+    double yScale = panel.height() / yMax;
+
+    //Grey panel with white grid lines, as in the scatter plot
+    painter.fillRect(panel, QColor(235, 235, 235));
+    std::vector<double> xTicks = valueTicks(lo, hi, distribution.logScale());
+    std::vector<double> yTicks = axisTicks(0.0, yMax, 5);
+
+    for (std::size_t i = 0; i < xTicks.size(); ++i) {
+        double px = panel.left() + (Distribution::toScale(xTicks[i], distribution.logScale()) - lo) * xScale;
+        painter.setPen(QPen(Qt::white, 1.0));
+        painter.drawLine(QPointF(px, panel.top()), QPointF(px, panel.bottom()));
+        painter.setPen(QColor(77, 77, 77));
+        painter.drawText(QRectF(px - 50, panel.bottom() + 2, 100, lineHeight),
+                         Qt::AlignHCenter | Qt::AlignTop, QString::number(xTicks[i], 'g', 6));
+    }
+    for (std::size_t i = 0; i < yTicks.size(); ++i) {
+        double py = panel.bottom() - yTicks[i] * yScale;
+        painter.setPen(QPen(Qt::white, 1.0));
+        painter.drawLine(QPointF(panel.left(), py), QPointF(panel.right(), py));
+        painter.setPen(QColor(77, 77, 77));
+        painter.drawText(QRectF(rect.left(), py - lineHeight / 2.0, panel.left() - rect.left() - 4, lineHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(yTicks[i], 'g', 4));
+    }
+
+    //Title and axis labels
+    QString xLabel = label + (distribution.logScale() ? " (log scale)" : "");
+    painter.setPen(Qt::black);
+    painter.drawText(QRect(panel.left(), rect.top(), panel.width(), lineHeight * 2),
+                     Qt::AlignCenter, "Distribution of " + label);
+    painter.drawText(QRect(panel.left(), panel.bottom() + lineHeight + 4, panel.width(), lineHeight * 2),
+                     Qt::AlignHCenter | Qt::AlignTop, xLabel);
+
+    painter.save();
+    painter.translate(rect.left() + lineHeight / 2, panel.center().y());
+    painter.rotate(-90);
+    painter.drawText(QRect(-panel.height() / 2, -lineHeight / 2, panel.height(), lineHeight), Qt::AlignCenter, "Density");
+    painter.restore();
+
+    //Bars, then the density curve in the blue of the smoothing curve
+    painter.setClipRect(panel);
+    painter.setPen(QPen(Qt::white, 1.0));
+    painter.setBrush(QColor(150, 170, 220));
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        if (bars[i] == 0.0)
+            continue;
+        double height = bars[i] * barScale * yScale;
+        painter.drawRect(QRectF(panel.left() + i * barWidth * xScale, panel.bottom() - height, barWidth * xScale, height));
+    }
+
+    QPainterPath curve;
+    for (std::size_t i = 0; i < density.size(); ++i) {
+        QPointF point(panel.left() + (distribution.gridPoint(i) - lo) * xScale, panel.bottom() - density[i] * yScale);
+        if (i == 0)
+            curve.moveTo(point);
+        else
+            curve.lineTo(point);
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(QColor(51, 102, 255), 2.0));
+    painter.drawPath(curve);
+
+    painter.restore();
+}
+
+DistributionPlotWidget::DistributionPlotWidget(QWidget *parent) : QWidget(parent)
+{
+    setMinimumSize(320, 240);
+}
+
+void DistributionPlotWidget::setDistribution(std::shared_ptr<const Distribution> distribution, const QString &label)
+{
+    m_distribution = distribution;
+    m_label = label;
+    m_density.clear();
+    update();
+}
+
+void DistributionPlotWidget::setDensity(const std::vector<double> &density)
+{
+    m_density = density;
+    update();
+}
+
+void DistributionPlotWidget::paintEvent(QPaintEvent *)
+{
+    if (!m_distribution)
+        return;
+
+    ScopedTimer timer("drawDistribution");
+    QPainter painter(this);
+    drawDistribution(painter, rect(), *m_distribution, m_density, m_label);
+}
+
+DistributionView::DistributionView(QWidget *parent) : QWidget(parent)
+{
+    plotWidget = new DistributionPlotWidget();
+    logCheck = new QCheckBox("Log scale");
+    bandwidthSlider = new QSlider(Qt::Horizontal);
+    bandwidthLabel = new QLabel();
+
+    //Price, owners and playtime are heavily skewed, their distributions are easier to read on a log scale
+    logCheck->setToolTip("Bin the values as log10(1 + value)");
+
+    //The middle of the slider is the default bandwidth
+    bandwidthSlider->setRange(-kSliderSteps, kSliderSteps);
+    bandwidthSlider->setValue(0);
+    bandwidthLabel->setMinimumWidth(140);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->addWidget(logCheck);
+    controls->addWidget(new QLabel("Bandwidth:"));
+    controls->addWidget(bandwidthSlider, 1);
+    controls->addWidget(bandwidthLabel);
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(plotWidget, 1);
+    layout->addLayout(controls);
+    setLayout(layout);
+
+    QObject::connect(logCheck, SIGNAL(toggled(bool)), this, SLOT(setLogScale(bool)));
+    QObject::connect(bandwidthSlider, SIGNAL(valueChanged(int)), this, SLOT(setBandwidth(int)));
+}
+
+void DistributionView::setValues(const std::vector<double> &values, const QString &label)
+{
+    m_values = values;
+    m_label = label;
+    m_distributions[0].reset();
+    m_distributions[1].reset();
+    setLogScale(logCheck->isChecked());
+}
+
+void DistributionView::setLogScale(bool logScale)
+{
+    //The bins of each scale are kept until the values change
+    std::shared_ptr<const Distribution> &distribution = m_distributions[logScale ? 1 : 0];
+    if (!distribution) {
+        ScopedTimer timer("binDistribution");
+        distribution = std::make_shared<const Distribution>(m_values, logScale);
+    }
+
+    plotWidget->setDistribution(distribution, m_label);
+    setBandwidth(bandwidthSlider->value());
+}
+
+void DistributionView::setBandwidth(int position)
+{
+    std::shared_ptr<const Distribution> distribution = m_distributions[logCheck->isChecked() ? 1 : 0];
+    if (!distribution)
+        return;
+
+    double bandwidth = distribution->defaultBandwidth() * std::pow(10.0, double(position) / kSliderSteps);
+    std::vector<double> density;
+    {
+        ScopedTimer timer("kernelDensity");
+        distribution->density(bandwidth, density);
+    }
+    plotWidget->setDensity(density);
+
+    //The bandwidth in the units of the values, unless they are on a log scale
+    bandwidthLabel->setText(QString("%1 (x%2)").arg(bandwidth, 0, 'g', 3)
+                            .arg(std::pow(10.0, double(position) / kSliderSteps), 0, 'f', 2));
+}
@@ -0,0 +1,72 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Histogram and kernel density of one plot variable, with a log scale and a bandwidth slider
+//
+// Author: Francois Stelluti
+//
+
+#ifndef DistributionView_H
+#define DistributionView_H
+
+#include "Distribution.h"
+
+#include <QCheckBox>
+#include <QLabel>
+#include <QPainter>
+#include <QRect>
+#include <QSlider>
+#include <QString>
+#include <QWidget>
+
+#include <memory>
+#include <vector>
+
+//Draw the histogram of a distribution, as a density, with its kernel density on top
+void drawDistribution(QPainter &painter, const QRect &rect, const Distribution &distribution,
+                      const std::vector<double> &density, const QString &label);
+
+class DistributionPlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DistributionPlotWidget(QWidget *parent = 0);
+
+    void setDistribution(std::shared_ptr<const Distribution> distribution, const QString &label);
+    void setDensity(const std::vector<double> &density);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    std::shared_ptr<const Distribution> m_distribution;
+    std::vector<double> m_density;
+    QString m_label;
+};
+
+//The values are binned once for each scale. Moving the bandwidth slider only convolves the bins again
+class DistributionView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DistributionView(QWidget *parent = 0);
+
+    void setValues(const std::vector<double> &values, const QString &label);
+
+private slots:
+    void setLogScale(bool logScale);
+    void setBandwidth(int position);        //Of the slider, a multiple of the default bandwidth
+
+private:
+    std::vector<double> m_values;
+    QString m_label;
+    std::shared_ptr<const Distribution> m_distributions[2];     //Linear and log scale, binned when first shown
+
+    DistributionPlotWidget *plotWidget;
+    QCheckBox *logCheck;
+    QSlider *bandwidthSlider;
+    QLabel *bandwidthLabel;
+};
+
+#endif
@@ -0,0 +1,214 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window with the filters applied to the games of the selected year
+//
+// Author: Francois Stelluti
+//
+
+#include "FilterPanel.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+//Steps of the owners slider per factor of 10, up to 10^8 owners
+const int kOwnersStepsPerDecade = 10;
+const int kOwnersSteps = 8 * kOwnersStepsPerDecade;
+
+} // namespace
+
+FilterPanel::FilterPanel(QWidget *parent) : QWidget(parent)
+{
+    setWindowTitle("Filters");
+
+    minPriceSlider = new QSlider(Qt::Horizontal);
+    maxPriceSlider = new QSlider(Qt::Horizontal);
+    priceLabel = new QLabel();
+    releaseCheck = new QCheckBox("Released between");
+    firstReleaseEdit = new QDateEdit();
+    lastReleaseEdit = new QDateEdit();
+    ownersSlider = new QSlider(Qt::Horizontal);
+    ownersLabel = new QLabel();
+    metascoreCombo = new QComboBox();
+    nameEdit = new QLineEdit();
+    resetButton = new QPushButton("Reset");
+    countLabel = new QLabel();
+
+    minPriceSlider->setRange(0, 100);
+    maxPriceSlider->setRange(0, 100);
+    maxPriceSlider->setValue(100);
+
+    firstReleaseEdit->setCalendarPopup(true);
+    lastReleaseEdit->setCalendarPopup(true);
+    firstReleaseEdit->setEnabled(false);
+    lastReleaseEdit->setEnabled(false);
+
+    ownersSlider->setRange(0, kOwnersSteps);
+
+    //Metascore filters, in the same order as GameFilter::ScoreFilter
+    metascoreCombo->addItem("Any");
+    metascoreCombo->addItem("Available");
+    metascoreCombo->addItem("N/A");
+
+    nameEdit->setPlaceholderText("Part of the name");
+    nameEdit->setClearButtonEnabled(true);
+
+    QHBoxLayout *releaseLayout = new QHBoxLayout();
+    releaseLayout->addWidget(firstReleaseEdit);
+    releaseLayout->addWidget(lastReleaseEdit);
+
+    QFormLayout *form = new QFormLayout();
+    form->addRow(tr("Minimum price:"), minPriceSlider);
+    form->addRow(tr("Maximum price:"), maxPriceSlider);
+    form->addRow(QString(), priceLabel);
+    form->addRow(releaseCheck, releaseLayout);
+    form->addRow(tr("Minimum owners:"), ownersSlider);
+    form->addRow(QString(), ownersLabel);
+    form->addRow(tr("Metascore:"), metascoreCombo);
+    form->addRow(tr("Game name:"), nameEdit);
+
+    QHBoxLayout *bottom = new QHBoxLayout();
+    bottom->addWidget(countLabel);
+    bottom->addStretch();
+    bottom->addWidget(resetButton);
+
+    QVBoxLayout *outer = new QVBoxLayout();
+    outer->addLayout(form);
+    outer->addLayout(bottom);
+    setLayout(outer);
+    setMinimumWidth(360);
+
+    //Every control applies the filter as soon as it changes
+    QObject::connect(minPriceSlider, SIGNAL(valueChanged(int)), this, SLOT(changed()));
+    QObject::connect(maxPriceSlider, SIGNAL(valueChanged(int)), this, SLOT(changed()));
+    QObject::connect(releaseCheck, SIGNAL(toggled(bool)), this, SLOT(changed()));
+    QObject::connect(firstReleaseEdit, SIGNAL(dateChanged(QDate)), this, SLOT(changed()));
+    QObject::connect(lastReleaseEdit, SIGNAL(dateChanged(QDate)), this, SLOT(changed()));
+    QObject::connect(ownersSlider, SIGNAL(valueChanged(int)), this, SLOT(changed()));
+    QObject::connect(metascoreCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(changed()));
+    QObject::connect(nameEdit, SIGNAL(textChanged(QString)), this, SLOT(changed()));
+    QObject::connect(resetButton, SIGNAL(released()), this, SLOT(reset()));
+
+    updateLabels();
+}
+
+GameFilter FilterPanel::filter() const
+{
+    GameFilter filter;
+
+    //The ends of the price sliders mean no limit
+    if (minPriceSlider->value() > 0)
+        filter.minPrice = static_cast<float>(minPriceSlider->value());
+    if (maxPriceSlider->value() < maxPriceSlider->maximum())
+        filter.maxPrice = static_cast<float>(maxPriceSlider->value());
+
+    if (releaseCheck->isChecked()) {
+        filter.firstReleaseDate = dayFromDate(firstReleaseEdit->date());
+        filter.lastReleaseDate = dayFromDate(lastReleaseEdit->date());
+    }
+
+    filter.minOwners = ownersFromSlider(ownersSlider->value());
+    filter.metascore = static_cast<GameFilter::ScoreFilter>(metascoreCombo->currentIndex());
+    filter.nameContains = nameEdit->text().trimmed().toStdString();
+    return filter;
+}
+
+void FilterPanel::setTable(const SteamGameTable &table)
+{
+    //Range of the prices and release dates of the year
+    float maxPrice = 0.0f;
+    int32_t firstDay = std::numeric_limits<int32_t>::max(), lastDay = std::numeric_limits<int32_t>::min();
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (!std::isnan(table.prices()[i]))
+            maxPrice = std::max(maxPrice, table.prices()[i]);
+        int32_t day = table.releaseDates()[i];
+        if (day != kUnknownReleaseDate) {
+            firstDay = std::min(firstDay, day);
+            lastDay = std::max(lastDay, day);
+        }
+    }
+
+    //Changing the ranges must not apply the filter once per control
+    bool blocked = blockSignals(true);
+
+    bool noMaximum = maxPriceSlider->value() == maxPriceSlider->maximum();
+    int top = std::max(1, static_cast<int>(std::ceil(maxPrice)));
+    minPriceSlider->setMaximum(top);
+    maxPriceSlider->setMaximum(top);
+    if (noMaximum)
+        maxPriceSlider->setValue(top);
+
+    //Dates outside of the year are moved to its first and last release dates
+    if (firstDay <= lastDay) {
+        firstReleaseEdit->setDateRange(dateFromDay(firstDay), dateFromDay(lastDay));
+        lastReleaseEdit->setDateRange(dateFromDay(firstDay), dateFromDay(lastDay));
+        if (!releaseCheck->isChecked()) {
+            firstReleaseEdit->setDate(dateFromDay(firstDay));
+            lastReleaseEdit->setDate(dateFromDay(lastDay));
+        }
+    }
+
+    blockSignals(blocked);
+
+    updateLabels();
+}
+
+void FilterPanel::setSelectedCount(std::size_t selected, std::size_t rows)
+{
+    countLabel->setText(QString("%1 of %2 games").arg(selected).arg(rows));
+}
+
+void FilterPanel::changed(void)
+{
+    updateLabels();
+    emit filterChanged();
+}
+
+void FilterPanel::updateLabels()
+{
+    firstReleaseEdit->setEnabled(releaseCheck->isChecked());
+    lastReleaseEdit->setEnabled(releaseCheck->isChecked());
+
+    QString minPrice = minPriceSlider->value() > 0 ? "$" + QString::number(minPriceSlider->value()) : "$0";
+    QString maxPrice = maxPriceSlider->value() < maxPriceSlider->maximum() ? "$" + QString::number(maxPriceSlider->value())
+                                                                           : QString("no limit");
+    priceLabel->setText(minPrice + " to " + maxPrice);
+    ownersLabel->setText(QString::number(ownersFromSlider(ownersSlider->value())));
+}
+
+void FilterPanel::reset(void)
+{
+    bool blocked = blockSignals(true);
+    minPriceSlider->setValue(0);
+    maxPriceSlider->setValue(maxPriceSlider->maximum());
+    releaseCheck->setChecked(false);
+    ownersSlider->setValue(0);
+    metascoreCombo->setCurrentIndex(GameFilter::AnyScore);
+    nameEdit->clear();
+    blockSignals(blocked);
+
+    changed();
+}
+
+uint32_t FilterPanel::ownersFromSlider(int value)
+{
+    if (value <= 0)
+        return 0;
+    return static_cast<uint32_t>(std::pow(10.0, double(value) / kOwnersStepsPerDecade) + 0.5);
+}
+
+QDate FilterPanel::dateFromDay(int32_t day)
+{
+    return QDate(1970, 1, 1).addDays(day);
+}
+
+int32_t FilterPanel::dayFromDate(const QDate &date)
+{
+    return static_cast<int32_t>(QDate(1970, 1, 1).daysTo(date));
+}
@@ -0,0 +1,67 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window with the filters applied to the games of the selected year
+//
+// Author: Francois Stelluti
+//
+
+#ifndef FilterPanel_H
+#define FilterPanel_H
+
+#include "GameFilter.h"
+#include "SteamGameTable.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDate>
+#include <QDateEdit>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSlider>
+#include <QWidget>
+
+#include <cstddef>
+
+//Every change is applied immediately: filterChanged() is emitted on each move of a slider or key press
+class FilterPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FilterPanel(QWidget *parent = 0);
+
+    GameFilter filter() const;
+
+    //Fit the ranges of the sliders and dates to a table, keeping the current filter where possible.
+    //Doesn't emit filterChanged, the filter may have changed to fit the table
+    void setTable(const SteamGameTable &table);
+
+    void setSelectedCount(std::size_t selected, std::size_t rows);
+
+signals:
+    void filterChanged();
+
+private slots:
+    void changed(void);             //Update the labels and emit filterChanged
+    void reset(void);               //Select every game again
+
+private:
+    void updateLabels();
+    static uint32_t ownersFromSlider(int value);    //The owners slider is logarithmic
+    static QDate dateFromDay(int32_t day);
+    static int32_t dayFromDate(const QDate &date);
+
+    QSlider *minPriceSlider, *maxPriceSlider;       //In dollars, the maximum of maxPriceSlider means no limit
+    QLabel *priceLabel;
+    QCheckBox *releaseCheck;
+    QDateEdit *firstReleaseEdit, *lastReleaseEdit;
+    QSlider *ownersSlider;
+    QLabel *ownersLabel;
+    QComboBox *metascoreCombo;                      //In the same order as GameFilter::ScoreFilter
+    QLineEdit *nameEdit;
+    QPushButton *resetButton;
+    QLabel *countLabel;
+};
+
+#endif
@@ -0,0 +1,243 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Filters on the rows of a game table, evaluated natively as bitmaps over the columns
+//
+// Author: Francois Stelluti
+//
+
+#include "GameFilter.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+//Index of the lowest set bit of a non-zero word
+inline int lowestBit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+//Clear the bits of the rows where keep(values[row]) is false. Each word is built from 64 comparisons
+//without branches, and words already cleared by an earlier condition are skipped
+template <typename T, typename Predicate>
+void keepWhere(std::vector<uint64_t> &words, std::size_t rows, const T *values, Predicate keep)
+{
+    for (std::size_t w = 0; w < words.size(); ++w) {
+        if (!words[w])
+            continue;
+
+        std::size_t begin = w * 64;
+        std::size_t count = std::min<std::size_t>(64, rows - begin);
+        uint64_t bits = 0;
+        for (std::size_t j = 0; j < count; ++j)
+            bits |= uint64_t(keep(values[begin + j])) << j;
+        words[w] &= bits;
+    }
+}
+
+//The conditions of select() for one row, with the name in lower case
+bool rowMatches(const SteamGameTable &table, const GameFilter &filter, const std::string &needle, std::size_t row)
+{
+    const SteamGameColumns &c = table.columns();
+
+    if (filter.metascore != GameFilter::AnyScore && table.hasMetascore(row) != (filter.metascore == GameFilter::ScoreAvailable))
+        return false;
+    if (c.owners[row] < filter.minOwners)
+        return false;
+    if (filter.hasPriceRange() && !(c.price[row] >= filter.minPrice && c.price[row] <= filter.maxPrice))
+        return false;
+    if (filter.hasReleaseWindow() && (c.releaseDate[row] == kUnknownReleaseDate ||
+                                      c.releaseDate[row] < filter.firstReleaseDate || c.releaseDate[row] > filter.lastReleaseDate))
+        return false;
+    return needle.empty() || containsIgnoringCase(c.names + c.nameOffsets[row], c.names + c.nameOffsets[row + 1], needle);
+}
+
+} // namespace
+
+char toLowerAscii(char c)
+{
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+bool containsIgnoringCase(const char *begin, const char *end, const std::string &needle)
+{
+    std::size_t length = needle.size();
+    if (static_cast<std::size_t>(end - begin) < length)
+        return false;
+
+    for (const char *p = begin; p + length <= end; ++p) {
+        if (toLowerAscii(*p) != needle[0])
+            continue;
+        std::size_t i = 1;
+        while (i < length && toLowerAscii(p[i]) == needle[i])
+            ++i;
+        if (i == length)
+            return true;
+    }
+    return false;
+}
+
+GameFilter::GameFilter() :
+    minPrice(0.0f), maxPrice(std::numeric_limits<float>::infinity()),
+    firstReleaseDate(kUnknownReleaseDate), lastReleaseDate(std::numeric_limits<int32_t>::max()),
+    minOwners(0), metascore(AnyScore)
+{
+}
+
+bool GameFilter::hasPriceRange() const
+{
+    return minPrice > 0.0f || maxPrice != std::numeric_limits<float>::infinity();
+}
+
+bool GameFilter::hasReleaseWindow() const
+{
+    return firstReleaseDate != kUnknownReleaseDate || lastReleaseDate != std::numeric_limits<int32_t>::max();
+}
+
+bool GameFilter::isEmpty() const
+{
+    return !hasPriceRange() && !hasReleaseWindow() && minOwners == 0 && metascore == AnyScore && nameContains.empty();
+}
+
+bool GameFilter::operator==(const GameFilter &other) const
+{
+    return minPrice == other.minPrice && maxPrice == other.maxPrice
+        && firstReleaseDate == other.firstReleaseDate && lastReleaseDate == other.lastReleaseDate
+        && minOwners == other.minOwners && metascore == other.metascore && nameContains == other.nameContains;
+}
+
+bool GameFilter::operator!=(const GameFilter &other) const
+{
+    return !(*this == other);
+}
+
+RowSelection::RowSelection() : m_rows(0), m_count(0)
+{
+}
+
+std::size_t RowSelection::rows() const
+{
+    return m_rows;
+}
+
+std::size_t RowSelection::count() const
+{
+    return m_count;
+}
+
+const uint64_t *RowSelection::words() const
+{
+    return m_words.data();
+}
+
+bool RowSelection::contains(std::size_t row) const
+{
+    return (m_words[row / 64] >> (row % 64)) & 1;
+}
+
+std::size_t RowSelection::compact(double *values) const
+{
+    std::size_t kept = 0;
+    for (std::size_t w = 0; w < m_words.size(); ++w) {
+        for (uint64_t word = m_words[w]; word; word &= word - 1)
+            values[kept++] = values[w * 64 + lowestBit(word)];
+    }
+    return kept;
+}
+
+const RowSelection &FilterEngine::select(const SteamGameTable &table, const GameFilter &filter)
+{
+    RowSelection &selection = m_selection;
+    std::size_t rows = table.size();
+    std::size_t numWords = (rows + 63) / 64;
+    std::vector<uint64_t> &words = selection.m_words;
+
+    //Start with every row, without the bits past the end of the table
+    selection.m_rows = rows;
+    words.assign(numWords, ~uint64_t(0));
+    if (rows % 64)
+        words.back() = (uint64_t(1) << (rows % 64)) - 1;
+
+    //Cheapest conditions first, so that the name search only looks at the rows left
+    if (filter.metascore != GameFilter::AnyScore) {
+        const uint64_t *mask = table.metascoreMask();
+        for (std::size_t w = 0; w < numWords; ++w)
+            words[w] &= filter.metascore == GameFilter::ScoreAvailable ? mask[w] : ~mask[w];
+    }
+
+    if (filter.minOwners > 0) {
+        uint32_t minOwners = filter.minOwners;
+        keepWhere(words, rows, table.owners(), [minOwners](uint32_t owners) { return owners >= minOwners; });
+    }
+
+    if (filter.hasPriceRange()) {
+        float minPrice = filter.minPrice, maxPrice = filter.maxPrice;
+        keepWhere(words, rows, table.prices(), [minPrice, maxPrice](float price) {
+            return price >= minPrice && price <= maxPrice;
+        });
+    }
+
+    if (filter.hasReleaseWindow()) {
+        int32_t first = filter.firstReleaseDate, last = filter.lastReleaseDate;
+        keepWhere(words, rows, table.releaseDates(), [first, last](int32_t date) {
+            return date != kUnknownReleaseDate && date >= first && date <= last;
+        });
+    }
+
+    if (!filter.nameContains.empty()) {
+        m_needle.resize(filter.nameContains.size());
+        std::transform(filter.nameContains.begin(), filter.nameContains.end(), m_needle.begin(), toLowerAscii);
+
+        const SteamGameColumns &columns = table.columns();
+        for (std::size_t w = 0; w < numWords; ++w) {
+            for (uint64_t word = words[w]; word; word &= word - 1) {
+                int bit = lowestBit(word);
+                std::size_t row = w * 64 + bit;
+                if (!containsIgnoringCase(columns.names + columns.nameOffsets[row],
+                                          columns.names + columns.nameOffsets[row + 1], m_needle))
+                    words[w] &= ~(uint64_t(1) << bit);
+            }
+        }
+    }
+
+    selection.m_count = 0;
+    for (std::size_t w = 0; w < numWords; ++w)
+        selection.m_count += std::bitset<64>(words[w]).count();
+
+    return selection;
+}
+
+std::size_t FilterEngine::extend(const SteamGameTable &table, const GameFilter &filter)
+{
+    RowSelection &selection = m_selection;
+    std::size_t first = selection.m_rows, rows = table.size();
+    selection.m_words.resize((rows + 63) / 64, 0);
+
+    m_needle.resize(filter.nameContains.size());
+    std::transform(filter.nameContains.begin(), filter.nameContains.end(), m_needle.begin(), toLowerAscii);
+
+    std::size_t added = 0;
+    for (std::size_t row = first; row < rows; ++row) {
+        if (rowMatches(table, filter, m_needle, row)) {
+            selection.m_words[row / 64] |= uint64_t(1) << (row % 64);
+            ++added;
+        }
+    }
+
+    selection.m_rows = rows;
+    selection.m_count += added;
+    return added;
+}
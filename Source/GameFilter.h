@@ -0,0 +1,89 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Filters on the rows of a game table, evaluated natively as bitmaps over the columns
+//
+// Author: Francois Stelluti
+//
+
+#ifndef GameFilter_H
+#define GameFilter_H
+
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+char toLowerAscii(char c);
+
+//True if needle (already in lower case) is in [begin, end), ignoring case
+bool containsIgnoringCase(const char *begin, const char *end, const std::string &needle);
+
+//Conditions on the games of a table. A row is selected if it meets every condition;
+//the default value of each condition selects every row
+struct GameFilter
+{
+    enum ScoreFilter {
+        AnyScore,
+        ScoreAvailable,
+        ScoreMissing
+    };
+
+    GameFilter();
+
+    float minPrice, maxPrice;                       //Games with an unknown price are dropped by a price range
+    int32_t firstReleaseDate, lastReleaseDate;      //Days since 1970-01-01, unknown dates are dropped by a window
+    uint32_t minOwners;
+    ScoreFilter metascore;
+    std::string nameContains;                       //Ignoring case
+
+    bool hasPriceRange() const;
+    bool hasReleaseWindow() const;
+    bool isEmpty() const;                           //True if every row is selected
+
+    bool operator==(const GameFilter &other) const;
+    bool operator!=(const GameFilter &other) const;
+};
+
+//Rows of a table selected by a filter: bit (row % 64) of word (row / 64) is set if the row is selected
+class RowSelection
+{
+public:
+    RowSelection();
+
+    std::size_t rows() const;               //Rows of the table
+    std::size_t count() const;              //Rows selected
+    const uint64_t *words() const;
+    bool contains(std::size_t row) const;
+
+    //Move the values of the selected rows to the front of values (which holds rows() values), in order,
+    //and return how many there are
+    std::size_t compact(double *values) const;
+
+private:
+    friend class FilterEngine;
+
+    std::vector<uint64_t> m_words;
+    std::size_t m_rows;
+    std::size_t m_count;
+};
+
+//Evaluates filters one condition at a time, each one clearing the bits of the rows it rejects.
+//The bitmaps are kept between queries, so moving a slider doesn't allocate anything
+class FilterEngine
+{
+public:
+    //Rows of the table selected by the filter. The selection is valid until the next call
+    const RowSelection &select(const SteamGameTable &table, const GameFilter &filter);
+
+    //Add the rows appended to the table since the last call, with the same filter, to the selection.
+    //Only the new rows are looked at. Returns how many of them are selected
+    std::size_t extend(const SteamGameTable &table, const GameFilter &filter);
+
+private:
+    RowSelection m_selection;
+    std::string m_needle;                   //Lower case nameContains
+};
+
+#endif
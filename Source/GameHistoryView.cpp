@@ -0,0 +1,164 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window following the games from year to year, with the change of a column and the games listed every year
+//
+// Author: Francois Stelluti
+//
+
+#include "GameHistoryView.h"
+#include "NameDictionary.h"
+#include "TopGamesPanel.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//Rows of the table, the first games in the order chosen
+const std::size_t kMaxShownGames = 500;
+
+} // namespace
+
+GameHistoryView::GameHistoryView(QWidget *parent) : QWidget(parent), m_joinMs(0.0)
+{
+    setWindowTitle("Games by Year");
+
+    columnCombo = new QComboBox();
+    orderCombo = new QComboBox();
+    everyYearCheck = new QCheckBox("Only games in every year");
+    searchEdit = new QLineEdit();
+    summaryLabel = new QLabel();
+    gamesTable = new QTableWidget();
+
+    //Every numeric column, in the same order as GameColumn
+    for (int c = 0; c < kNumGameColumns; ++c)
+        columnCombo->addItem(gameColumnName(static_cast<GameColumn>(c)));
+    columnCombo->setCurrentIndex(static_cast<int>(GameColumn::Owners));
+
+    orderCombo->addItem("Largest increase");
+    orderCombo->addItem("Largest decrease");
+
+    searchEdit->setPlaceholderText("Find a game by name");
+    searchEdit->setClearButtonEnabled(true);
+
+    summaryLabel->setWordWrap(true);
+
+    gamesTable->verticalHeader()->hide();
+    gamesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    gamesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    QHBoxLayout *queryLayout = new QHBoxLayout();
+    queryLayout->addWidget(columnCombo);
+    queryLayout->addWidget(orderCombo);
+    queryLayout->addWidget(everyYearCheck);
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addLayout(queryLayout);
+    layout->addWidget(searchEdit);
+    layout->addWidget(summaryLabel);
+    layout->addWidget(gamesTable);
+    setLayout(layout);
+    resize(700, 600);
+
+    QObject::connect(columnCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    QObject::connect(orderCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    QObject::connect(everyYearCheck, SIGNAL(toggled(bool)), this, SLOT(refresh()));
+    QObject::connect(searchEdit, SIGNAL(textChanged(QString)), this, SLOT(refresh()));
+}
+
+void GameHistoryView::setJoin(std::shared_ptr<const GameJoin> join, double joinMs)
+{
+    m_join = join;
+    m_joinMs = joinMs;
+
+    //Game, one column per year, and the change from the first year to the last
+    QStringList headers;
+    headers << "Game";
+    for (std::size_t y = 0; y < m_join->numYears(); ++y)
+        headers << QString::number(m_join->year(y));
+    headers << "Change";
+
+    gamesTable->setColumnCount(headers.size());
+    gamesTable->setHorizontalHeaderLabels(headers);
+    gamesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    gamesTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    refresh();
+}
+
+void GameHistoryView::refresh(void)
+{
+    if (!m_join || m_join->numYears() == 0)
+        return;
+
+    GameColumn column = static_cast<GameColumn>(columnCombo->currentIndex());
+    std::size_t last = m_join->numYears() - 1;
+    NameDictionary &names = NameDictionary::global();
+
+    std::vector<uint32_t> cohort;
+    m_join->cohort(cohort);
+    std::size_t cohortSize = cohort.size();
+
+    //Games of the cohort or of any year, whose name contains the search text
+    if (everyYearCheck->isChecked()) {
+        m_games.swap(cohort);
+    }
+    else {
+        m_games.resize(m_join->numGames());
+        for (std::size_t game = 0; game < m_games.size(); ++game)
+            m_games[game] = static_cast<uint32_t>(game);
+    }
+
+    QString search = searchEdit->text().trimmed();
+    if (!search.isEmpty()) {
+        std::vector<uint32_t>::iterator end = std::remove_if(m_games.begin(), m_games.end(), [&](uint32_t game) {
+            return !QString::fromStdString(names.name(m_join->nameId(game))).contains(search, Qt::CaseInsensitive);
+        });
+        m_games.erase(end, m_games.end());
+    }
+
+    //Games with a change first, by its size, then the others in the order of their ids
+    std::vector<double> change(m_join->numGames(), 0.0);
+    for (std::size_t i = 0; i < m_games.size(); ++i)
+        change[m_games[i]] = m_join->value(m_games[i], last, column) - m_join->value(m_games[i], 0, column);
+
+    bool increase = orderCombo->currentIndex() == 0;
+    std::stable_sort(m_games.begin(), m_games.end(), [&](uint32_t a, uint32_t b) {
+        if (std::isnan(change[a]) || std::isnan(change[b]))
+            return !std::isnan(change[a]) && std::isnan(change[b]);
+        return increase ? change[a] > change[b] : change[a] < change[b];
+    });
+
+    std::size_t shown = std::min(m_games.size(), kMaxShownGames);
+    gamesTable->setRowCount(static_cast<int>(shown));
+    for (std::size_t i = 0; i < shown; ++i) {
+        uint32_t game = m_games[i];
+        int row = static_cast<int>(i);
+        gamesTable->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(names.name(m_join->nameId(game)))));
+
+        //A dash for the years the game isn't listed in
+        for (std::size_t y = 0; y <= last; ++y) {
+            QTableWidgetItem *item = new QTableWidgetItem(m_join->row(game, y) == kNoRow ? QString("-") :
+                                                          TopGamesPanel::formatValue(column, m_join->value(game, y, column)));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            gamesTable->setItem(row, static_cast<int>(y) + 1, item);
+        }
+
+        //Formatted like the values, with its sign in front
+        QString sign = change[game] < 0 ? "-" : "+";
+        QTableWidgetItem *item = new QTableWidgetItem(std::isnan(change[game]) ? QString("N/A") :
+                                                      sign + TopGamesPanel::formatValue(column, std::fabs(change[game])));
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        gamesTable->setItem(row, static_cast<int>(last) + 2, item);
+    }
+
+    summaryLabel->setText(QString("%1 games in any year, %2 in every year. Showing %3 of %4, change from %5 to %6. "
+                                  "Joined in %7 ms, %8 names in the dictionary")
+                          .arg(m_join->numGames()).arg(cohortSize)
+                          .arg(shown).arg(m_games.size()).arg(m_join->year(0)).arg(m_join->year(last))
+                          .arg(m_joinMs, 0, 'f', 2).arg(names.size()));
+}
@@ -0,0 +1,50 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window following the games from year to year, with the change of a column and the games listed every year
+//
+// Author: Francois Stelluti
+//
+
+#ifndef GameHistoryView_H
+#define GameHistoryView_H
+
+#include "GameJoin.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTableWidget>
+#include <QWidget>
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+class GameHistoryView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit GameHistoryView(QWidget *parent = 0);
+
+    //Show the games of a join of the years, which are in increasing order
+    void setJoin(std::shared_ptr<const GameJoin> join, double joinMs);
+
+private slots:
+    void refresh(void);             //Select, sort and show the games for the controls
+
+private:
+    std::shared_ptr<const GameJoin> m_join;
+    double m_joinMs;
+    std::vector<uint32_t> m_games;  //Games shown, kept between refreshes
+
+    QComboBox *columnCombo;         //In the same order as GameColumn
+    QComboBox *orderCombo;          //Largest increase or decrease from the first to the last year
+    QCheckBox *everyYearCheck;      //Only the games listed in every year
+    QLineEdit *searchEdit;          //Only the games whose name contains it
+    QLabel *summaryLabel;
+    QTableWidget *gamesTable;
+};
+
+#endif
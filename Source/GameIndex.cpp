@@ -0,0 +1,352 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Indexes of a game table for top-N, percentile and name queries, built once per year of data
+//
+// Author: Francois Stelluti
+//
+
+#include "GameIndex.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+//Name bytes are folded to 6 bits before making trigrams, so the offsets of every trigram fit in a small
+//array: letters ignoring case and digits keep their own code, other bytes share the rest. Folding only
+//adds candidates, which are all compared with the text anyway
+const int kTrigramBits = 18;
+const uint32_t kNumTrigrams = uint32_t(1) << kTrigramBits;
+
+uint32_t foldByte(unsigned char c)
+{
+    if (c >= 'a' && c <= 'z')
+        return 1 + (c - 'a');
+    if (c >= 'A' && c <= 'Z')
+        return 1 + (c - 'A');
+    if (c >= '0' && c <= '9')
+        return 27 + (c - '0');
+    if (c == ' ')
+        return 37;
+    return 38 + c % 26;
+}
+
+uint32_t trigram(const char *p)
+{
+    return foldByte(p[0]) << 12 | foldByte(p[1]) << 6 | foldByte(p[2]);
+}
+
+//Key of a row of a column that sorts in the same order as its value, and flags missing values.
+//Prices are floats: flipping the bits of negative ones and the sign bit of the others orders them as integers
+bool sortKey(const SteamGameTable &table, GameColumn column, std::size_t row, uint32_t &key)
+{
+    const SteamGameColumns &c = table.columns();
+
+    switch (column)
+    {
+        case GameColumn::Price: {
+            if (std::isnan(c.price[row]))
+                return false;
+            uint32_t bits;
+            std::memcpy(&bits, &c.price[row], sizeof(bits));
+            key = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+            return true;
+        }
+        case GameColumn::Userscore:
+            key = c.userscore[row];
+            return table.hasUserscore(row);
+        case GameColumn::Owners:
+            key = c.owners[row];
+            return true;
+        case GameColumn::Playtime:
+            key = c.playtime[row];
+            return true;
+        case GameColumn::Metascore:
+            key = c.metascore[row];
+            return table.hasMetascore(row);
+        case GameColumn::OwnersError:
+            key = c.ownersError[row];
+            return true;
+        case GameColumn::MedianPlaytime:
+            key = c.medianPlaytime[row];
+            return true;
+    }
+
+    return false;
+}
+
+bool isSelected(const RowSelection *selection, uint32_t row)
+{
+    return !selection || selection->contains(row);
+}
+
+//Key and row of a value as one integer, ordered as the sorted rows are
+uint64_t keyedRow(const SteamGameTable &table, GameColumn column, uint32_t row)
+{
+    uint32_t key = 0;
+    sortKey(table, column, row, key);
+    return uint64_t(key) << 32 | row;
+}
+
+} // namespace
+
+GameIndex::GameIndex(const SteamGameTable &table, ThreadPool &pool) : m_rows(table.size())
+{
+    //One task per column, and one for the names
+    pool.parallelFor(kNumGameColumns + 1, [this, &table](std::size_t i) {
+        if (i < static_cast<std::size_t>(kNumGameColumns))
+            sortColumn(table, static_cast<GameColumn>(i));
+        else
+            indexNames(table);
+    });
+}
+
+std::size_t GameIndex::rows() const
+{
+    return m_rows;
+}
+
+std::size_t GameIndex::memoryUsage() const
+{
+    std::size_t bytes = (m_postingOffsets.capacity() + m_postings.capacity()) * sizeof(uint32_t);
+    for (int c = 0; c < kNumGameColumns; ++c)
+        bytes += m_sorted[c].capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+const std::vector<uint32_t> &GameIndex::sortedRows(GameColumn column) const
+{
+    return m_sorted[static_cast<int>(column)];
+}
+
+void GameIndex::sortColumn(const SteamGameTable &table, GameColumn column)
+{
+    //Sort the key and row of every value as one integer, which keeps ties in the order of the table
+    std::vector<uint64_t> keyed;
+    keyed.reserve(m_rows);
+    for (std::size_t row = 0; row < m_rows; ++row) {
+        uint32_t key;
+        if (sortKey(table, column, row, key))
+            keyed.push_back(uint64_t(key) << 32 | row);
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<uint32_t> &sorted = m_sorted[static_cast<int>(column)];
+    sorted.resize(keyed.size());
+    for (std::size_t i = 0; i < keyed.size(); ++i)
+        sorted[i] = static_cast<uint32_t>(keyed[i]);
+}
+
+void GameIndex::indexNames(const SteamGameTable &table)
+{
+    //Counting sort of the (trigram, row) pairs: count the rows of every trigram, then fill in the rows.
+    //A trigram appearing twice in a name is only listed once, using the last row that listed it
+    const SteamGameColumns &columns = table.columns();
+    std::vector<uint32_t> lastRow(kNumTrigrams, 0);
+    m_postingOffsets.assign(kNumTrigrams + 1, 0);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::fill(lastRow.begin(), lastRow.end(), 0);
+        std::vector<uint32_t> next;
+        if (pass == 1) {
+            for (uint32_t t = 0; t < kNumTrigrams; ++t)
+                m_postingOffsets[t + 1] += m_postingOffsets[t];
+            m_postings.resize(m_postingOffsets[kNumTrigrams]);
+            next.assign(m_postingOffsets.begin(), m_postingOffsets.end() - 1);
+        }
+
+        for (std::size_t row = 0; row < m_rows; ++row) {
+            const char *begin = columns.names + columns.nameOffsets[row];
+            const char *end = columns.names + columns.nameOffsets[row + 1];
+            uint32_t mark = static_cast<uint32_t>(row) + 1;
+
+            for (const char *p = begin; p + 3 <= end; ++p) {
+                uint32_t t = trigram(p);
+                if (lastRow[t] == mark)
+                    continue;
+                lastRow[t] = mark;
+
+                if (pass == 0)
+                    ++m_postingOffsets[t + 1];
+                else
+                    m_postings[next[t]++] = static_cast<uint32_t>(row);
+            }
+        }
+    }
+}
+
+void GameIndex::sortTail(const SteamGameTable &table, GameColumn column, const RowSelection *selection,
+                        std::vector<uint64_t> &keyed) const
+{
+    keyed.clear();
+    for (std::size_t row = m_rows; row < table.size(); ++row) {
+        uint32_t key;
+        if (isSelected(selection, static_cast<uint32_t>(row)) && sortKey(table, column, row, key))
+            keyed.push_back(uint64_t(key) << 32 | row);
+    }
+    std::sort(keyed.begin(), keyed.end());
+}
+
+void GameIndex::topRows(const SteamGameTable &table, GameColumn column, std::size_t n, bool highest,
+                        const RowSelection *selection, std::vector<uint32_t> &rows) const
+{
+    const std::vector<uint32_t> &sorted = sortedRows(column);
+    std::vector<uint64_t> tail;
+    sortTail(table, column, selection, tail);
+    rows.clear();
+
+    //Walk from the chosen end of the sorted rows, skipping the rows left out by the selection,
+    //and of the rows appended since the table was indexed
+    std::size_t i = 0, j = 0;
+    while (rows.size() < n && (i < sorted.size() || j < tail.size())) {
+        uint32_t row = 0;
+        if (i < sorted.size()) {
+            row = highest ? sorted[sorted.size() - 1 - i] : sorted[i];
+            if (!isSelected(selection, row)) {
+                ++i;
+                continue;
+            }
+        }
+
+        if (j < tail.size()) {
+            uint64_t next = highest ? tail[tail.size() - 1 - j] : tail[j];
+            bool takeTail = i == sorted.size() || (highest ? next > keyedRow(table, column, row)
+                                                           : next < keyedRow(table, column, row));
+            if (takeTail) {
+                rows.push_back(static_cast<uint32_t>(next));
+                ++j;
+                continue;
+            }
+        }
+
+        rows.push_back(row);
+        ++i;
+    }
+}
+
+double GameIndex::percentile(const SteamGameTable &table, GameColumn column, double fraction,
+                             const RowSelection *selection) const
+{
+    const std::vector<uint32_t> &sorted = sortedRows(column);
+    if (table.size() > m_rows)
+        return tailPercentile(table, column, fraction, selection);
+
+    std::size_t count = sorted.size();
+    if (selection) {
+        count = 0;
+        for (std::size_t i = 0; i < sorted.size(); ++i)
+            count += selection->contains(sorted[i]);
+    }
+    if (count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    //R's type 7: interpolate between the values of rank floor(h) and floor(h) + 1, counting from 0
+    double h = (count - 1) * std::min(std::max(fraction, 0.0), 1.0);
+    std::size_t lower = static_cast<std::size_t>(std::floor(h));
+    std::size_t upper = std::min(lower + 1, count - 1);
+
+    double lowerValue = 0.0, upperValue = 0.0;
+    if (!selection) {
+        lowerValue = table.value(column, sorted[lower]);
+        upperValue = table.value(column, sorted[upper]);
+    } else {
+        std::size_t rank = 0;
+        for (std::size_t i = 0; i < sorted.size() && rank <= upper; ++i) {
+            if (!selection->contains(sorted[i]))
+                continue;
+            if (rank == lower)
+                lowerValue = table.value(column, sorted[i]);
+            if (rank == upper)
+                upperValue = table.value(column, sorted[i]);
+            ++rank;
+        }
+    }
+
+    return lowerValue + (h - lower) * (upperValue - lowerValue);
+}
+
+double GameIndex::tailPercentile(const SteamGameTable &table, GameColumn column, double fraction,
+                                 const RowSelection *selection) const
+{
+    const std::vector<uint32_t> &sorted = sortedRows(column);
+    std::vector<uint64_t> tail;
+    sortTail(table, column, selection, tail);
+
+    std::size_t count = tail.size();
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+        count += isSelected(selection, sorted[i]);
+    if (count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    double h = (count - 1) * std::min(std::max(fraction, 0.0), 1.0);
+    std::size_t lower = static_cast<std::size_t>(std::floor(h));
+    std::size_t upper = std::min(lower + 1, count - 1);
+
+    //Merge the sorted rows with the sorted tail up to the upper rank
+    double lowerValue = 0.0, upperValue = 0.0;
+    std::size_t i = 0, j = 0;
+    for (std::size_t rank = 0; rank <= upper; ++rank) {
+        while (i < sorted.size() && !isSelected(selection, sorted[i]))
+            ++i;
+
+        uint32_t row;
+        if (j == tail.size() || (i < sorted.size() && keyedRow(table, column, sorted[i]) < tail[j]))
+            row = sorted[i++];
+        else
+            row = static_cast<uint32_t>(tail[j++]);
+
+        if (rank == lower)
+            lowerValue = table.value(column, row);
+        if (rank == upper)
+            upperValue = table.value(column, row);
+    }
+
+    return lowerValue + (h - lower) * (upperValue - lowerValue);
+}
+
+void GameIndex::findName(const SteamGameTable &table, const std::string &text, std::size_t limit,
+                         const RowSelection *selection, std::vector<uint32_t> &rows) const
+{
+    rows.clear();
+    if (text.empty())
+        return;
+
+    std::string needle(text.size(), '\0');
+    std::transform(text.begin(), text.end(), needle.begin(), toLowerAscii);
+    const SteamGameColumns &columns = table.columns();
+
+    //Too short for a trigram: compare every name
+    if (needle.size() < 3) {
+        for (uint32_t row = 0; row < table.size() && rows.size() < limit; ++row) {
+            if (isSelected(selection, row) && containsIgnoringCase(columns.names + columns.nameOffsets[row],
+                                                                   columns.names + columns.nameOffsets[row + 1], needle))
+                rows.push_back(row);
+        }
+        return;
+    }
+
+    //Every matching name has all the trigrams of the text, so the rows of the rarest one are enough
+    uint32_t rarest = trigram(needle.data());
+    for (std::size_t i = 1; i + 3 <= needle.size(); ++i) {
+        uint32_t t = trigram(needle.data() + i);
+        if (m_postingOffsets[t + 1] - m_postingOffsets[t] < m_postingOffsets[rarest + 1] - m_postingOffsets[rarest])
+            rarest = t;
+    }
+
+    for (uint32_t i = m_postingOffsets[rarest]; i < m_postingOffsets[rarest + 1] && rows.size() < limit; ++i) {
+        uint32_t row = m_postings[i];
+        if (isSelected(selection, row) && containsIgnoringCase(columns.names + columns.nameOffsets[row],
+                                                               columns.names + columns.nameOffsets[row + 1], needle))
+            rows.push_back(row);
+    }
+
+    //Rows appended since the table was indexed come last, and are all compared
+    for (std::size_t row = m_rows; row < table.size() && rows.size() < limit; ++row) {
+        if (isSelected(selection, static_cast<uint32_t>(row)) &&
+            containsIgnoringCase(columns.names + columns.nameOffsets[row], columns.names + columns.nameOffsets[row + 1], needle))
+            rows.push_back(static_cast<uint32_t>(row));
+    }
+}
@@ -0,0 +1,72 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Indexes of a game table for top-N, percentile and name queries, built once per year of data
+//
+// Author: Francois Stelluti
+//
+
+#ifndef GameIndex_H
+#define GameIndex_H
+
+#include "GameFilter.h"
+#include "SteamGameTable.h"
+#include "SummaryStats.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//The rows of every numeric column sorted by value, and the trigrams of the game names.
+//The index doesn't keep the table, which must be passed to the queries that read it. Rows appended to the
+//table after it was indexed are sorted or compared at each query, until the table is indexed again
+class GameIndex
+{
+public:
+    //Index a table, sorting the columns in parallel on the pool
+    GameIndex(const SteamGameTable &table, ThreadPool &pool);
+
+    std::size_t rows() const;                       //Rows of the table when it was indexed
+    std::size_t memoryUsage() const;                //Bytes used by the index
+
+    //Rows with a value in a column, from the lowest value to the highest. Ties are in the order of the table
+    const std::vector<uint32_t> &sortedRows(GameColumn column) const;
+
+    //The n rows with the highest (or lowest) values of a column, first to last, only counting rows
+    //in the selection if there is one. Rows with a missing value are never included
+    void topRows(const SteamGameTable &table, GameColumn column, std::size_t n, bool highest,
+                 const RowSelection *selection, std::vector<uint32_t> &rows) const;
+
+    //Quantile of a column ignoring missing values, interpolated as R's quantile() does by default.
+    //Takes constant time for the whole table as it was indexed, and one pass over the sorted rows otherwise.
+    //NaN if there are no values
+    double percentile(const SteamGameTable &table, GameColumn column, double fraction,
+                      const RowSelection *selection) const;
+
+    //Rows whose name contains text, ignoring case, in the order of the table and at most limit of them.
+    //Names are only compared for the rows listed under the rarest trigram of the text
+    void findName(const SteamGameTable &table, const std::string &text, std::size_t limit,
+                  const RowSelection *selection, std::vector<uint32_t> &rows) const;
+
+private:
+    void sortColumn(const SteamGameTable &table, GameColumn column);
+    void indexNames(const SteamGameTable &table);
+
+    //Keys and rows of the rows appended since the table was indexed, in the same order as the sorted rows
+    void sortTail(const SteamGameTable &table, GameColumn column, const RowSelection *selection,
+                  std::vector<uint64_t> &keyed) const;
+    double tailPercentile(const SteamGameTable &table, GameColumn column, double fraction,
+                          const RowSelection *selection) const;
+
+    std::size_t m_rows;
+    std::vector<uint32_t> m_sorted[kNumGameColumns];
+
+    //Rows containing each trigram of folded name bytes, in the order of the table:
+    //trigram t lists m_postings[m_postingOffsets[t]] to m_postings[m_postingOffsets[t+1]]
+    std::vector<uint32_t> m_postingOffsets;
+    std::vector<uint32_t> m_postings;
+};
+
+#endif
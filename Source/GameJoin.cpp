@@ -0,0 +1,129 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Join of the years of data on the interned game names, for the history of each game across the years
+//
+// Author: Francois Stelluti
+//
+
+#include "GameJoin.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+//Ids gathered by each task of the second pass
+const std::size_t kIdsPerBlock = 64 * 1024;
+
+} // namespace
+
+GameJoin::GameJoin(const std::vector<JoinYear> &years, ThreadPool &pool) : m_years(years)
+{
+    std::size_t numYears = years.size();
+    uint32_t ids = 0;
+    for (std::size_t y = 0; y < numYears; ++y)
+        for (std::size_t i = 0; i < years[y].nameIds->size(); ++i)
+            ids = std::max(ids, (*years[y].nameIds)[i] + 1);
+
+    //Build: the row of every id in each year
+    std::vector<std::vector<uint32_t> > rowOfId(numYears);
+    pool.parallelFor(numYears, [&](std::size_t y) {
+        const std::vector<uint32_t> &nameIds = *years[y].nameIds;
+        rowOfId[y].assign(ids, kNoRow);
+        for (std::size_t row = 0; row < nameIds.size(); ++row)
+            rowOfId[y][nameIds[row]] = static_cast<uint32_t>(row);
+    });
+
+    //Probe: the ids listed in any year are games. Blocks of ids are counted, then filled in at their offset
+    std::size_t blocks = (ids + kIdsPerBlock - 1) / kIdsPerBlock;
+    std::vector<std::size_t> offsets(blocks + 1, 0);
+    auto listed = [&](uint32_t id) {
+        for (std::size_t y = 0; y < numYears; ++y)
+            if (rowOfId[y][id] != kNoRow)
+                return true;
+        return false;
+    };
+
+    pool.parallelFor(blocks, [&](std::size_t b) {
+        uint32_t end = static_cast<uint32_t>(std::min<std::size_t>(ids, (b + 1) * kIdsPerBlock));
+        for (uint32_t id = static_cast<uint32_t>(b * kIdsPerBlock); id < end; ++id)
+            offsets[b + 1] += listed(id);
+    });
+    for (std::size_t b = 0; b < blocks; ++b)
+        offsets[b + 1] += offsets[b];
+
+    m_nameIds.resize(offsets[blocks]);
+    m_rows.resize(offsets[blocks] * numYears);
+    pool.parallelFor(blocks, [&](std::size_t b) {
+        std::size_t game = offsets[b];
+        uint32_t end = static_cast<uint32_t>(std::min<std::size_t>(ids, (b + 1) * kIdsPerBlock));
+        for (uint32_t id = static_cast<uint32_t>(b * kIdsPerBlock); id < end; ++id) {
+            if (!listed(id))
+                continue;
+            m_nameIds[game] = id;
+            for (std::size_t y = 0; y < numYears; ++y)
+                m_rows[game * numYears + y] = rowOfId[y][id];
+            ++game;
+        }
+    });
+}
+
+std::size_t GameJoin::numYears() const
+{
+    return m_years.size();
+}
+
+int GameJoin::year(std::size_t y) const
+{
+    return m_years[y].year;
+}
+
+std::size_t GameJoin::numGames() const
+{
+    return m_nameIds.size();
+}
+
+std::size_t GameJoin::memoryUsage() const
+{
+    return (m_nameIds.capacity() + m_rows.capacity()) * sizeof(uint32_t);
+}
+
+uint32_t GameJoin::nameId(std::size_t game) const
+{
+    return m_nameIds[game];
+}
+
+uint32_t GameJoin::row(std::size_t game, std::size_t y) const
+{
+    return m_rows[game * m_years.size() + y];
+}
+
+double GameJoin::value(std::size_t game, std::size_t y, GameColumn column) const
+{
+    uint32_t r = row(game, y);
+    return r == kNoRow ? std::numeric_limits<double>::quiet_NaN() : m_years[y].table->value(column, r);
+}
+
+void GameJoin::cohort(std::vector<uint32_t> &games) const
+{
+    games.clear();
+    for (std::size_t game = 0; game < numGames(); ++game) {
+        const uint32_t *rows = &m_rows[game * m_years.size()];
+        if (std::find(rows, rows + m_years.size(), kNoRow) == rows + m_years.size())
+            games.push_back(static_cast<uint32_t>(game));
+    }
+}
+
+void GameJoin::changes(GameColumn column, std::size_t from, std::size_t to, std::vector<GameChange> &out) const
+{
+    out.clear();
+    for (std::size_t game = 0; game < numGames(); ++game) {
+        GameChange change;
+        change.game = static_cast<uint32_t>(game);
+        change.from = value(game, from, column);
+        change.to = value(game, to, column);
+        if (change.from == change.from && change.to == change.to)
+            out.push_back(change);
+    }
+}
@@ -0,0 +1,68 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Join of the years of data on the interned game names, for the history of each game across the years
+//
+// Author: Francois Stelluti
+//
+
+#ifndef GameJoin_H
+#define GameJoin_H
+
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+class ThreadPool;
+
+//Row of a game in a year where it isn't listed
+const uint32_t kNoRow = UINT32_MAX;
+
+//One year to join: its table, and the id of the name of every row in NameDictionary::global()
+struct JoinYear
+{
+    int year;
+    std::shared_ptr<const SteamGameTable> table;
+    std::shared_ptr<const std::vector<uint32_t> > nameIds;
+};
+
+//Value of a column for a game in two years
+struct GameChange
+{
+    uint32_t game;
+    double from, to;
+};
+
+//The games listed in any of the years, and their row in each year. Name ids are small and dense, so
+//the hash table of the join is an array indexed by id: every year is scattered into it in parallel,
+//then the ids are gathered into games in blocks, also in parallel. A name listed twice in a year
+//is joined with its last row
+class GameJoin
+{
+public:
+    GameJoin(const std::vector<JoinYear> &years, ThreadPool &pool);
+
+    std::size_t numYears() const;
+    int year(std::size_t y) const;
+    std::size_t numGames() const;
+    std::size_t memoryUsage() const;
+
+    uint32_t nameId(std::size_t game) const;
+    uint32_t row(std::size_t game, std::size_t y) const;             //kNoRow if the game isn't listed that year
+    double value(std::size_t game, std::size_t y, GameColumn column) const;     //NaN if not listed or N/A
+
+    //Games listed in every year, in the order of their ids
+    void cohort(std::vector<uint32_t> &games) const;
+
+    //Games with a value of the column in both years, and the two values
+    void changes(GameColumn column, std::size_t from, std::size_t to, std::vector<GameChange> &out) const;
+
+private:
+    std::vector<JoinYear> m_years;
+    std::vector<uint32_t> m_nameIds;        //Name id of each game
+    std::vector<uint32_t> m_rows;           //Row of game g in year y at g * numYears() + y
+};
+
+#endif
@@ -0,0 +1,231 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Statistics of a column for groups of games, by price tier or release date, computed on every thread
+//
+// Author: Francois Stelluti
+//
+
+#include "GroupBy.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+//Fewer rows are aggregated on one thread, starting tasks would take longer
+const std::size_t kMinRowsPerTask = 16 * 1024;
+
+const char *kPriceTierNames[] = {"Free", "Under $5", "Under $20", "$20 and over"};
+const char *kMonthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+//Order of the groups in the results: by group, the unknown group last
+bool groupBefore(const GroupAggregate &a, const GroupAggregate &b)
+{
+    return a.group != kUnknownGroup && (b.group == kUnknownGroup || a.group < b.group);
+}
+
+//Open addressing hash table of the groups of one task. There are few groups, so it stays in the cache
+class GroupTable
+{
+public:
+    GroupTable() : m_slots(64, -1)
+    {
+    }
+
+    GroupAggregate &find(int32_t group)
+    {
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t i = hashGroup(group) & mask;; i = (i + 1) & mask) {
+            int32_t slot = m_slots[i];
+            if (slot < 0) {
+                m_slots[i] = static_cast<int32_t>(m_groups.size());
+                m_groups.push_back(GroupAggregate(group));
+                if (m_groups.size() * 2 > m_slots.size())
+                    grow();
+                return m_groups.back();
+            }
+            if (m_groups[slot].group == group)
+                return m_groups[slot];
+        }
+    }
+
+    std::vector<GroupAggregate> &groups()
+    {
+        return m_groups;
+    }
+
+private:
+    //Multiplying by an odd number mixes the bits of nearby groups, such as consecutive months
+    static std::size_t hashGroup(int32_t group)
+    {
+        return (static_cast<uint32_t>(group) * 2654435761u) >> 8;
+    }
+
+    void grow()
+    {
+        m_slots.assign(m_slots.size() * 2, -1);
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t g = 0; g < m_groups.size(); ++g) {
+            std::size_t i = hashGroup(m_groups[g].group) & mask;
+            while (m_slots[i] >= 0)
+                i = (i + 1) & mask;
+            m_slots[i] = static_cast<int32_t>(g);
+        }
+    }
+
+    std::vector<int32_t> m_slots;           //Index of the group in m_groups, or -1 if the slot is empty
+    std::vector<GroupAggregate> m_groups;
+};
+
+void hashRows(const SteamGameTable &table, GroupKey key, GameColumn column, const RowSelection *selection,
+              std::size_t begin, std::size_t end, std::vector<GroupAggregate> &groups)
+{
+    GroupTable hashTable;
+    for (std::size_t row = begin; row < end; ++row)
+        if (!selection || selection->contains(row))
+            hashTable.find(groupOf(table, key, row)).add(table.value(column, row));
+    groups.swap(hashTable.groups());
+}
+
+void sortRows(const SteamGameTable &table, GroupKey key, GameColumn column, const RowSelection *selection,
+              std::size_t begin, std::size_t end, std::vector<GroupAggregate> &groups)
+{
+    //Group and row, so that rows stay in order within their group
+    std::vector<std::pair<int32_t, uint32_t> > keyed;
+    keyed.reserve(end - begin);
+    for (std::size_t row = begin; row < end; ++row)
+        if (!selection || selection->contains(row))
+            keyed.push_back(std::make_pair(groupOf(table, key, row), static_cast<uint32_t>(row)));
+    std::sort(keyed.begin(), keyed.end());
+
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        if (i == 0 || keyed[i].first != keyed[i - 1].first)
+            groups.push_back(GroupAggregate(keyed[i].first));
+        groups.back().add(table.value(column, keyed[i].second));
+    }
+}
+
+} // namespace
+
+GroupAggregate::GroupAggregate(int32_t group) :
+    group(group), games(0), count(0), sum(0.0),
+    min(std::numeric_limits<double>::quiet_NaN()), max(std::numeric_limits<double>::quiet_NaN())
+{
+}
+
+void GroupAggregate::add(double value)
+{
+    ++games;
+    if (std::isnan(value))
+        return;
+
+    min = count == 0 ? value : std::min(min, value);
+    max = count == 0 ? value : std::max(max, value);
+    sum += value;
+    ++count;
+}
+
+void GroupAggregate::merge(const GroupAggregate &other)
+{
+    games += other.games;
+    if (other.count == 0)
+        return;
+
+    min = count == 0 ? other.min : std::min(min, other.min);
+    max = count == 0 ? other.max : std::max(max, other.max);
+    sum += other.sum;
+    count += other.count;
+}
+
+double GroupAggregate::mean() const
+{
+    return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN();
+}
+
+const char *groupKeyName(GroupKey key)
+{
+    switch (key)
+    {
+        case GroupKey::PriceTier:
+            return "Price tier";
+        case GroupKey::ReleaseYear:
+            return "Release year";
+        case GroupKey::ReleaseMonth:
+            return "Release month";
+    }
+
+    return "";
+}
+
+std::string groupName(GroupKey key, int32_t group)
+{
+    if (group == kUnknownGroup)
+        return "Unknown";
+
+    switch (key)
+    {
+        case GroupKey::PriceTier:
+            return kPriceTierNames[group];
+        case GroupKey::ReleaseYear:
+            return std::to_string(group);
+        case GroupKey::ReleaseMonth:
+            return std::string(kMonthNames[group % 12]) + " " + std::to_string(group / 12);
+    }
+
+    return "";
+}
+
+int32_t groupOf(const SteamGameTable &table, GroupKey key, std::size_t row)
+{
+    const SteamGameColumns &c = table.columns();
+
+    if (key == GroupKey::PriceTier) {
+        float price = c.price[row];
+        if (std::isnan(price))
+            return kUnknownGroup;
+        return price <= 0.0f ? 0 : price < 5.0f ? 1 : price < 20.0f ? 2 : 3;
+    }
+
+    if (c.releaseDate[row] == kUnknownReleaseDate)
+        return kUnknownGroup;
+
+    int year, month, day;
+    releaseDate(c.releaseDate[row], year, month, day);
+    return key == GroupKey::ReleaseYear ? year : year * 12 + (month - 1);
+}
+
+std::vector<GroupAggregate> groupBy(const SteamGameTable &table, GroupKey key, GameColumn column,
+                                    const RowSelection *selection, ThreadPool &pool, GroupStrategy strategy)
+{
+    //About one task per thread, each with its own partial aggregates
+    std::size_t rows = table.size();
+    std::size_t tasks = std::max<std::size_t>(1, std::min(pool.size() + 1, rows / kMinRowsPerTask));
+    std::vector<std::vector<GroupAggregate> > partials(tasks);
+
+    pool.parallelFor(tasks, [&](std::size_t task) {
+        std::size_t begin = rows * task / tasks, end = rows * (task + 1) / tasks;
+        if (strategy == GroupStrategy::Hash)
+            hashRows(table, key, column, selection, begin, end, partials[task]);
+        else
+            sortRows(table, key, column, selection, begin, end, partials[task]);
+    });
+
+    //Merge the partial aggregates of each group, which are next to each other once sorted
+    std::vector<GroupAggregate> all;
+    for (std::size_t task = 0; task < tasks; ++task)
+        all.insert(all.end(), partials[task].begin(), partials[task].end());
+    std::stable_sort(all.begin(), all.end(), groupBefore);
+
+    std::vector<GroupAggregate> groups;
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        if (groups.empty() || groups.back().group != all[i].group)
+            groups.push_back(all[i]);
+        else
+            groups.back().merge(all[i]);
+    }
+
+    return groups;
+}
@@ -0,0 +1,67 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Statistics of a column for groups of games, by price tier or release date, computed on every thread
+//
+// Author: Francois Stelluti
+//
+
+#ifndef GroupBy_H
+#define GroupBy_H
+
+#include "GameFilter.h"
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//What the games are grouped by
+enum class GroupKey {
+    PriceTier,          //Free, under $5, under $20, $20 and over
+    ReleaseYear,
+    ReleaseMonth        //Month of the release date, e.g. Apr 2015
+};
+
+const int kNumGroupKeys = 3;
+
+//How groupBy() brings the rows of a group together. Both give the same groups
+enum class GroupStrategy {
+    Hash,               //Each thread adds its rows into a small hash table of its groups
+    Sort                //Each thread sorts its rows by group, and adds up each run of the same group
+};
+
+//Group of the rows whose key can't be read, e.g. an unknown release date
+const int32_t kUnknownGroup = INT32_MIN;
+
+//Statistics of a column over the games of a group. Partial aggregates of the same group can be merged
+struct GroupAggregate
+{
+    int32_t group;
+    std::size_t games;          //Games in the group
+    std::size_t count;          //Games with a value of the column
+    double sum, min, max;       //Min and max are NaN without values
+
+    explicit GroupAggregate(int32_t group = kUnknownGroup);
+
+    void add(double value);     //NaN values only count as games
+    void merge(const GroupAggregate &other);
+    double mean() const;        //NaN without values
+};
+
+const char *groupKeyName(GroupKey key);                     //Name of a key, as displayed
+std::string groupName(GroupKey key, int32_t group);        //Name of a group, e.g. "Under $5" or "Apr 2015"
+
+//Group of a row of the table
+int32_t groupOf(const SteamGameTable &table, GroupKey key, std::size_t row);
+
+//Statistics of the column for every group of the selected rows (all of them without a selection), in the
+//order of the groups with the unknown group last. The rows are split between the threads of the pool, each
+//aggregating its own rows, and the partial aggregates are merged at the end
+std::vector<GroupAggregate> groupBy(const SteamGameTable &table, GroupKey key, GameColumn column,
+                                    const RowSelection *selection, ThreadPool &pool,
+                                    GroupStrategy strategy = GroupStrategy::Hash);
+
+#endif
@@ -0,0 +1,203 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Bar chart and table of a statistic of the selected year for groups of games, beside the stats
+//
+// Author: Francois Stelluti
+//
+
+#include "GroupByPanel.h"
+#include "PerfTrace.h"
+#include "SummaryStats.h"
+#include "ThreadPool.h"
+#include "TopGamesPanel.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPainter>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+//Statistics the bars can show, in the order of the combo box
+enum BarStatistic {
+    GamesBars,
+    MeanBars,
+    TotalBars,
+    MinimumBars,
+    MaximumBars
+};
+
+} // namespace
+
+GroupBarChart::GroupBarChart(QWidget *parent) : QWidget(parent)
+{
+    setMinimumHeight(180);
+}
+
+void GroupBarChart::setBars(const std::vector<QString> &names, const std::vector<double> &values,
+                            const std::vector<QString> &labels)
+{
+    m_names = names;
+    m_values = values;
+    m_labels = labels;
+    update();
+}
+
+void GroupBarChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+    if (m_values.empty())
+        return;
+
+    //Bars start at zero, or at the lowest value if some are negative
+    double lo = 0.0, hi = 0.0;
+    for (std::size_t i = 0; i < m_values.size(); ++i) {
+        if (std::isnan(m_values[i]))
+            continue;
+        lo = std::min(lo, m_values[i]);
+        hi = std::max(hi, m_values[i]);
+    }
+    if (hi <= lo)
+        hi = lo + 1.0;
+
+    //Group names on the left, values at the end of the bars
+    const int nameWidth = 80, labelWidth = 70;
+    int n = static_cast<int>(m_values.size());
+    double barHeight = double(height() - 4) / n;
+    int barWidth = width() - nameWidth - labelWidth - 8;
+
+    for (int i = 0; i < n; ++i) {
+        QRectF line(0, 2 + i * barHeight, width(), barHeight);
+        painter.setPen(Qt::black);
+        painter.drawText(QRectF(2, line.top(), nameWidth - 6, barHeight), Qt::AlignRight | Qt::AlignVCenter, m_names[i]);
+
+        if (std::isnan(m_values[i]))
+            continue;
+        double from = nameWidth + barWidth * (std::min(0.0, m_values[i]) - lo) / (hi - lo);
+        double to = nameWidth + barWidth * (std::max(0.0, m_values[i]) - lo) / (hi - lo);
+        painter.fillRect(QRectF(from, line.top() + barHeight * 0.15, std::max(1.0, to - from), barHeight * 0.7),
+                         QColor(51, 102, 255));
+        painter.drawText(QRectF(to + 4, line.top(), labelWidth, barHeight), Qt::AlignLeft | Qt::AlignVCenter, m_labels[i]);
+    }
+}
+
+GroupByPanel::GroupByPanel(QWidget *parent) : QGroupBox("Grouped Stats", parent), m_selection(0)
+{
+    keyCombo = new QComboBox();
+    columnCombo = new QComboBox();
+    statisticCombo = new QComboBox();
+    barChart = new GroupBarChart();
+    groupsTable = new QTableWidget(0, 4);
+
+    //Every key and numeric column, in the same order as GroupKey and GameColumn
+    for (int k = 0; k < kNumGroupKeys; ++k)
+        keyCombo->addItem(groupKeyName(static_cast<GroupKey>(k)));
+    for (int c = 0; c < kNumGameColumns; ++c)
+        columnCombo->addItem(gameColumnName(static_cast<GameColumn>(c)));
+    columnCombo->setCurrentIndex(static_cast<int>(GameColumn::Owners));
+
+    //In the same order as BarStatistic
+    statisticCombo->addItem("Games");
+    statisticCombo->addItem("Mean");
+    statisticCombo->addItem("Total");
+    statisticCombo->addItem("Minimum");
+    statisticCombo->addItem("Maximum");
+    statisticCombo->setCurrentIndex(MeanBars);
+
+    //Read only table of the groups, with the number of games and the mean and total of the column
+    groupsTable->setHorizontalHeaderLabels(QStringList() << "Group" << "Games" << "Mean" << "Total");
+    groupsTable->verticalHeader()->hide();
+    groupsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    groupsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    groupsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int c = 1; c < 4; ++c)
+        groupsTable->horizontalHeader()->setSectionResizeMode(c, QHeaderView::ResizeToContents);
+
+    QHBoxLayout *queryLayout = new QHBoxLayout();
+    queryLayout->addWidget(statisticCombo);
+    queryLayout->addWidget(columnCombo);
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addWidget(keyCombo);
+    layout->addLayout(queryLayout);
+    layout->addWidget(barChart, 1);
+    layout->addWidget(groupsTable, 1);
+    setLayout(layout);
+    setFixedWidth(340);
+
+    //Group the games again whenever a control changes
+    QObject::connect(keyCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    QObject::connect(columnCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    QObject::connect(statisticCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+}
+
+void GroupByPanel::setData(std::shared_ptr<const SteamGameTable> table, const RowSelection *selection)
+{
+    m_table = table;
+    m_selection = selection;
+    refresh();
+}
+
+void GroupByPanel::showEvent(QShowEvent *event)
+{
+    QGroupBox::showEvent(event);
+    refresh();
+}
+
+void GroupByPanel::refresh(void)
+{
+    if (!m_table || !isVisible())
+        return;
+
+    GroupKey key = static_cast<GroupKey>(keyCombo->currentIndex());
+    GameColumn column = static_cast<GameColumn>(columnCombo->currentIndex());
+    BarStatistic statistic = static_cast<BarStatistic>(statisticCombo->currentIndex());
+
+    std::vector<GroupAggregate> groups;
+    {
+        ScopedTimer timer("groupBy");
+        groups = groupBy(*m_table, key, column, m_selection, ThreadPool::global());
+    }
+
+    std::vector<QString> names, labels;
+    std::vector<double> values;
+    groupsTable->setRowCount(static_cast<int>(groups.size()));
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        const GroupAggregate &group = groups[i];
+        int row = static_cast<int>(i);
+
+        double total = group.count > 0 ? group.sum : std::numeric_limits<double>::quiet_NaN();
+        double value = group.mean();
+        if (statistic == GamesBars)
+            value = static_cast<double>(group.games);
+        else if (statistic == TotalBars)
+            value = total;
+        else if (statistic == MinimumBars)
+            value = group.min;
+        else if (statistic == MaximumBars)
+            value = group.max;
+
+        names.push_back(QString::fromStdString(groupName(key, group.group)));
+        values.push_back(value);
+        labels.push_back(statistic == GamesBars ? QString::number(group.games) : TopGamesPanel::formatValue(column, value));
+
+        QTableWidgetItem *games = new QTableWidgetItem(QString::number(group.games));
+        QTableWidgetItem *mean = new QTableWidgetItem(TopGamesPanel::formatValue(column, group.mean()));
+        QTableWidgetItem *sum = new QTableWidgetItem(TopGamesPanel::formatValue(column, total));
+        games->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        mean->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        sum->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+        groupsTable->setItem(row, 0, new QTableWidgetItem(names.back()));
+        groupsTable->setItem(row, 1, games);
+        groupsTable->setItem(row, 2, mean);
+        groupsTable->setItem(row, 3, sum);
+    }
+
+    barChart->setBars(names, values, labels);
+}
@@ -0,0 +1,72 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Bar chart and table of a statistic of the selected year for groups of games, beside the stats
+//
+// Author: Francois Stelluti
+//
+
+#ifndef GroupByPanel_H
+#define GroupByPanel_H
+
+#include "GameFilter.h"
+#include "GroupBy.h"
+#include "SteamGameTable.h"
+
+#include <QComboBox>
+#include <QGroupBox>
+#include <QString>
+#include <QTableWidget>
+#include <QWidget>
+
+#include <memory>
+#include <vector>
+
+//Horizontal bars, one per group, labelled with the group and the value
+class GroupBarChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit GroupBarChart(QWidget *parent = 0);
+
+    void setBars(const std::vector<QString> &names, const std::vector<double> &values,
+                 const std::vector<QString> &labels);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    std::vector<QString> m_names;
+    std::vector<double> m_values;       //NaN for a group without values, drawn without a bar
+    std::vector<QString> m_labels;
+};
+
+class GroupByPanel : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    explicit GroupByPanel(QWidget *parent = 0);
+
+    //Group the games of a year, only those in the selection if there is one. They are grouped when the
+    //panel is shown, not while it is hidden behind another tab. The selection must stay valid until the next call
+    void setData(std::shared_ptr<const SteamGameTable> table, const RowSelection *selection);
+
+protected:
+    void showEvent(QShowEvent *event);
+
+private slots:
+    void refresh(void);             //Group the games for the controls and fill the chart and the table
+
+private:
+    std::shared_ptr<const SteamGameTable> m_table;
+    const RowSelection *m_selection;
+
+    QComboBox *keyCombo;            //In the same order as GroupKey
+    QComboBox *columnCombo;         //In the same order as GameColumn
+    QComboBox *statisticCombo;      //Statistic shown by the bars
+    GroupBarChart *barChart;
+    QTableWidget *groupsTable;
+};
+
+#endif
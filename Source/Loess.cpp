@@ -0,0 +1,147 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Local polynomial regression (LOESS), used to draw the smoothing curve of native plots
+//
+// Author: Francois Stelluti
+//
+
+#include "Loess.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+//Solve the (degree+1)x(degree+1) normal equations a*b = c with partial pivoting.
+//Returns false if the system is singular, e.g. when the neighbourhood has too few distinct x
+bool solveNormalEquations(double a[3][3], double c[3], int size, double b[3])
+{
+    //a[0][0] is the sum of the weights, any pivot much smaller than it is a rounding error
+    double tolerance = 1e-10 * std::fabs(a[0][0]);
+
+    for (int col = 0; col < size; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < size; ++row)
+            if (std::fabs(a[row][col]) > std::fabs(a[pivot][col]))
+                pivot = row;
+
+        if (std::fabs(a[pivot][col]) <= tolerance)
+            return false;
+
+        if (pivot != col) {
+            for (int k = 0; k < size; ++k)
+                std::swap(a[col][k], a[pivot][k]);
+            std::swap(c[col], c[pivot]);
+        }
+
+        for (int row = col + 1; row < size; ++row) {
+            double factor = a[row][col] / a[col][col];
+            for (int k = col; k < size; ++k)
+                a[row][k] -= factor * a[col][k];
+            c[row] -= factor * c[col];
+        }
+    }
+
+    for (int row = size - 1; row >= 0; --row) {
+        double sum = c[row];
+        for (int k = row + 1; k < size; ++k)
+            sum -= a[row][k] * b[k];
+        b[row] = sum / a[row][row];
+    }
+
+    return true;
+}
+
+} // namespace
+
+std::vector<double> loessFit(const double *x, const double *y, std::size_t n,
+                             const double *at, std::size_t m, double span, int degree)
+{
+    std::vector<double> fit(m, std::numeric_limits<double>::quiet_NaN());
+    if (n == 0)
+        return fit;
+
+    degree = std::max(0, std::min(degree, 2));
+
+    //Sort the observations by x, so that the nearest neighbours of a point are a contiguous window
+    std::vector<std::pair<double, double> > points(n);
+    for (std::size_t i = 0; i < n; ++i)
+        points[i] = std::make_pair(x[i], y[i]);
+    std::sort(points.begin(), points.end());
+
+    std::size_t q = static_cast<std::size_t>(std::floor(n * span));
+    q = std::min(n, std::max<std::size_t>(q, degree + 1));
+
+    for (std::size_t p = 0; p < m; ++p) {
+        double x0 = at[p];
+
+        //Grow the window [lo, hi) from the position of x0 until it holds the q nearest points
+        std::size_t hi = std::lower_bound(points.begin(), points.end(), std::make_pair(x0, -std::numeric_limits<double>::infinity()))
+                         - points.begin();
+        std::size_t lo = hi;
+        while (hi - lo < q) {
+            if (lo == 0)
+                ++hi;
+            else if (hi == n)
+                --lo;
+            else if (x0 - points[lo - 1].first <= points[hi].first - x0)
+                --lo;
+            else
+                ++hi;
+        }
+
+        double maxDistance = std::max(x0 - points[lo].first, points[hi - 1].first - x0);
+        if (span > 1.0)
+            maxDistance *= span;    //R enlarges the neighbourhood beyond the data when span > 1
+        if (maxDistance <= 0.0)
+            maxDistance = 1.0;
+
+        //Accumulate the weighted moments of u = (x - x0) / maxDistance, which keeps the system well conditioned
+        double moments[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        double c[3] = {0.0, 0.0, 0.0};
+        for (std::size_t i = lo; i < hi; ++i) {
+            double u = (points[i].first - x0) / maxDistance;
+            double d = std::fabs(u);
+            if (d >= 1.0)
+                continue;
+
+            double t = 1.0 - d * d * d;
+            double w = t * t * t;
+            double powers[5] = {1.0, u, u * u, u * u * u, u * u * u * u};
+
+            for (int k = 0; k < 5; ++k)
+                moments[k] += w * powers[k];
+            for (int k = 0; k < 3; ++k)
+                c[k] += w * powers[k] * points[i].second;
+        }
+
+        if (moments[0] <= 0.0) {
+            //Every point is on the edge of the window: fall back to the unweighted mean
+            double sum = 0.0;
+            for (std::size_t i = lo; i < hi; ++i)
+                sum += points[i].second;
+            fit[p] = sum / (hi - lo);
+            continue;
+        }
+
+        //The fitted value at x0 is the intercept. Lower the degree if the neighbourhood can't support it
+        for (int d = degree; d >= 0; --d) {
+            int size = d + 1;
+            double a[3][3], rhs[3], b[3];
+            for (int row = 0; row < size; ++row) {
+                rhs[row] = c[row];
+                for (int col = 0; col < size; ++col)
+                    a[row][col] = moments[row + col];
+            }
+
+            if (solveNormalEquations(a, rhs, size, b)) {
+                fit[p] = b[0];
+                break;
+            }
+        }
+    }
+
+    return fit;
+}
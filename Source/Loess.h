@@ -0,0 +1,20 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Local polynomial regression (LOESS), used to draw the smoothing curve of native plots
+//
+// Author: Francois Stelluti
+//
+
+#ifndef Loess_H
+#define Loess_H
+
+#include <cstddef>
+#include <vector>
+
+//Fit of y on x evaluated at each of the m points of 'at', like R's loess with family='gaussian'.
+//Each point is fitted with a polynomial of the given degree (0 to 2), weighted with a tricube
+//kernel over the span*n nearest observations. x and y must not contain NaN
+std::vector<double> loessFit(const double *x, const double *y, std::size_t n,
+                             const double *at, std::size_t m, double span = 0.75, int degree = 2);
+
+#endif
@@ -0,0 +1,307 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Dictionary of interned game names, giving every distinct name a small id shared by all the years
+//
+// Author: Francois Stelluti
+//
+
+#include "NameDictionary.h"
+
+#include <cstring>
+
+namespace {
+
+const std::size_t kInitialSlots = 1024;
+
+} // namespace
+
+uint64_t hashName(const char *name, std::size_t length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+NameDictionary::NameDictionary() : m_releasedBytes(0), m_blocks(1, Block()), m_slots(kInitialSlots, 0)
+{
+}
+
+NameDictionary &NameDictionary::global()
+{
+    static NameDictionary dictionary;
+    return dictionary;
+}
+
+uint32_t NameDictionary::intern(const char *name, std::size_t length)
+{
+    uint64_t hash = hashName(name, length);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return internLocked(name, length, hash, 0, 0);
+}
+
+std::shared_ptr<std::vector<uint32_t> > NameDictionary::internTable(const SteamGameTable &table)
+{
+    const SteamGameColumns &columns = table.columns();
+    std::shared_ptr<const std::vector<char> > names = table.sharedNames();
+    std::shared_ptr<std::vector<uint32_t> > ids = releasedWith(new std::vector<uint32_t>());
+
+    std::vector<uint64_t> hashes;
+    hashNames(table, 0, hashes);
+    ids->reserve(table.size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //New names refer to a block holding the names of the table, which is dropped if none of them was new
+    uint32_t block = 0;
+    if (names) {
+        if (m_freeBlocks.empty()) {
+            block = static_cast<uint32_t>(m_blocks.size());
+            m_blocks.push_back(Block());
+        }
+        else {
+            block = m_freeBlocks.back();
+            m_freeBlocks.pop_back();
+        }
+        m_blocks[block].names = names;
+        m_blocks[block].ids = 0;
+    }
+
+    for (std::size_t row = 0; row < table.size(); ++row)
+        ids->push_back(internLocked(columns.names + columns.nameOffsets[row],
+                                    columns.nameOffsets[row + 1] - columns.nameOffsets[row], hashes[row],
+                                    block, columns.nameOffsets[row]));
+
+    if (block != 0 && m_blocks[block].ids == 0) {
+        m_blocks[block].names.reset();
+        m_freeBlocks.push_back(block);
+    }
+    copyUnsharedBlocks();
+    return ids;
+}
+
+void NameDictionary::internNames(const SteamGameTable &table, std::size_t firstRow, std::vector<uint32_t> &ids)
+{
+    const SteamGameColumns &columns = table.columns();
+
+    //Hash without the lock, so that a year being loaded in the background doesn't hold up the others
+    std::vector<uint64_t> hashes;
+    hashNames(table, firstRow, hashes);
+
+    //Appends to ids grow it geometrically, reserving the exact size each time would copy it every time
+    if (ids.empty())
+        ids.reserve(table.size() - firstRow);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t row = firstRow; row < table.size(); ++row)
+        ids.push_back(internLocked(columns.names + columns.nameOffsets[row],
+                                   columns.nameOffsets[row + 1] - columns.nameOffsets[row], hashes[row - firstRow],
+                                   0, 0));
+}
+
+std::shared_ptr<std::vector<uint32_t> > NameDictionary::copyIds(const std::vector<uint32_t> &ids)
+{
+    std::shared_ptr<std::vector<uint32_t> > copy = releasedWith(new std::vector<uint32_t>(ids));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        ++m_ids[ids[i]].references;
+    return copy;
+}
+
+void NameDictionary::release(const std::vector<uint32_t> &ids)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::size_t freed = 0;
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        Name &name = m_ids[ids[i]];
+        if (--name.references > 0)
+            continue;
+
+        --m_blocks[name.block].ids;
+        if (name.block == 0) {
+            m_releasedBytes += name.length;
+        }
+        else if (m_blocks[name.block].ids == 0) {
+            m_blocks[name.block].names.reset();
+            m_freeBlocks.push_back(name.block);
+        }
+        m_freeIds.push_back(ids[i]);
+        ++freed;
+    }
+    copyUnsharedBlocks();
+    if (freed == 0)
+        return;
+
+    //Copy the names still used once most of m_names was released, instead of letting it grow forever
+    if (m_releasedBytes > m_names.size() / 2) {
+        std::vector<char> names;
+        names.reserve(m_names.size() - m_releasedBytes);
+        for (std::size_t id = 0; id < m_ids.size(); ++id) {
+            Name &name = m_ids[id];
+            if (name.references == 0 || name.block != 0)
+                continue;
+            uint32_t offset = static_cast<uint32_t>(names.size());
+            names.insert(names.end(), m_names.begin() + name.offset, m_names.begin() + name.offset + name.length);
+            name.offset = offset;
+        }
+        m_names.swap(names);
+        m_releasedBytes = 0;
+    }
+
+    //Shrink the slots along with the names, leaving room for as many names again
+    std::size_t slots = kInitialSlots;
+    while (slots < (m_ids.size() - m_freeIds.size()) * 4)
+        slots *= 2;
+    rehash(slots);
+}
+
+void NameDictionary::prune()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    copyUnsharedBlocks();
+}
+
+std::string NameDictionary::name(uint32_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::string(nameData(m_ids[id]), m_ids[id].length);
+}
+
+std::size_t NameDictionary::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ids.size() - m_freeIds.size();
+}
+
+std::size_t NameDictionary::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //The names of a table that is gone are only held by the dictionary, until they are copied
+    std::size_t unshared = 0;
+    for (std::size_t block = 1; block < m_blocks.size(); ++block)
+        if (m_blocks[block].names && m_blocks[block].names.use_count() == 1)
+            unshared += m_blocks[block].names->capacity();
+
+    return m_names.capacity() + unshared + m_ids.capacity() * sizeof(Name)
+         + (m_freeIds.capacity() + m_freeBlocks.capacity() + m_slots.capacity()) * sizeof(uint32_t)
+         + m_blocks.capacity() * sizeof(Block);
+}
+
+std::shared_ptr<std::vector<uint32_t> > NameDictionary::releasedWith(std::vector<uint32_t> *ids)
+{
+    return std::shared_ptr<std::vector<uint32_t> >(ids, [this](std::vector<uint32_t> *released) {
+        release(*released);
+        delete released;
+    });
+}
+
+void NameDictionary::hashNames(const SteamGameTable &table, std::size_t firstRow, std::vector<uint64_t> &hashes) const
+{
+    const SteamGameColumns &columns = table.columns();
+    hashes.resize(table.size() - firstRow);
+    for (std::size_t row = firstRow; row < table.size(); ++row)
+        hashes[row - firstRow] = hashName(columns.names + columns.nameOffsets[row],
+                                          columns.nameOffsets[row + 1] - columns.nameOffsets[row]);
+}
+
+const char *NameDictionary::nameData(const Name &name) const
+{
+    const char *names = name.block == 0 ? m_names.data() : m_blocks[name.block].names->data();
+    return names + name.offset;
+}
+
+uint32_t NameDictionary::internLocked(const char *name, std::size_t length, uint64_t hash, uint32_t block,
+                                      uint32_t offset)
+{
+    std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = static_cast<uint32_t>(hash) & mask;; i = (i + 1) & mask) {
+        uint32_t slot = m_slots[i];
+        if (slot == 0) {
+            uint32_t id;
+            if (m_freeIds.empty()) {
+                id = static_cast<uint32_t>(m_ids.size());
+                m_ids.push_back(Name());
+            }
+            else {
+                id = m_freeIds.back();
+                m_freeIds.pop_back();
+            }
+
+            //A name that isn't in the names of a table is copied
+            if (block == 0) {
+                offset = static_cast<uint32_t>(m_names.size());
+                m_names.insert(m_names.end(), name, name + length);
+            }
+            Name &added = m_ids[id];
+            added.hash = static_cast<uint32_t>(hash);
+            added.block = block;
+            added.offset = offset;
+            added.length = static_cast<uint32_t>(length);
+            added.references = 1;
+            ++m_blocks[block].ids;
+            m_slots[i] = id + 1;
+
+            if ((m_ids.size() - m_freeIds.size()) * 2 > m_slots.size())
+                rehash(m_slots.size() * 2);
+            return id;
+        }
+
+        uint32_t id = slot - 1;
+        const Name &found = m_ids[id];
+        if (found.hash == static_cast<uint32_t>(hash) && found.length == length && std::memcmp(nameData(found), name, length) == 0) {
+            ++m_ids[id].references;
+            return id;
+        }
+    }
+}
+
+void NameDictionary::copyUnsharedBlocks()
+{
+    //A block only held by the dictionary belongs to a table that was destroyed
+    std::vector<char> unshared(m_blocks.size(), 0);
+    bool any = false;
+    for (std::size_t block = 1; block < m_blocks.size(); ++block) {
+        unshared[block] = m_blocks[block].names && m_blocks[block].names.use_count() == 1;
+        any = any || unshared[block];
+    }
+    if (!any)
+        return;
+
+    for (std::size_t id = 0; id < m_ids.size(); ++id) {
+        Name &name = m_ids[id];
+        if (name.references == 0 || !unshared[name.block])
+            continue;
+        const char *data = nameData(name);
+        uint32_t offset = static_cast<uint32_t>(m_names.size());
+        m_names.insert(m_names.end(), data, data + name.length);
+        name.block = 0;
+        name.offset = offset;
+    }
+
+    for (std::size_t block = 1; block < m_blocks.size(); ++block) {
+        if (unshared[block]) {
+            m_blocks[0].ids += m_blocks[block].ids;
+            m_blocks[block].names.reset();
+            m_blocks[block].ids = 0;
+            m_freeBlocks.push_back(static_cast<uint32_t>(block));
+        }
+    }
+}
+
+void NameDictionary::rehash(std::size_t slots)
+{
+    std::vector<uint32_t>(slots, 0).swap(m_slots);
+    std::size_t mask = m_slots.size() - 1;
+    for (uint32_t id = 0; id < m_ids.size(); ++id) {
+        if (m_ids[id].references == 0)
+            continue;
+        std::size_t i = static_cast<std::size_t>(m_ids[id].hash) & mask;
+        while (m_slots[i])
+            i = (i + 1) & mask;
+        m_slots[i] = id + 1;
+    }
+}
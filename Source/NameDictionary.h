@@ -0,0 +1,92 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Dictionary of interned game names, giving every distinct name a small id shared by all the years
+//
+// Author: Francois Stelluti
+//
+
+#ifndef NameDictionary_H
+#define NameDictionary_H
+
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//64-bit FNV-1a hash of a name
+uint64_t hashName(const char *name, std::size_t length);
+
+//Every distinct name is stored once, and numbered from 0 so ids can index arrays directly. Names are
+//compared exactly. Every id handed out holds a reference to its name, and the name is forgotten once its
+//references are released, its id being reused for a later name. All member functions are thread-safe
+class NameDictionary
+{
+public:
+    NameDictionary();
+
+    //Shared by every table loaded by the application
+    static NameDictionary &global();
+
+    //Id of a name, taking a reference to it
+    uint32_t intern(const char *name, std::size_t length);
+
+    //Ids of the names of every row of the table, released when the vector is destroyed. The names of a
+    //table that owns its columns aren't copied: the dictionary refers to the names of the table, and only
+    //copies the ones still in use once the table is gone
+    std::shared_ptr<std::vector<uint32_t> > internTable(const SteamGameTable &table);
+
+    //Append the id of the name of every row of the table from firstRow on to ids, taking a reference to each.
+    //The names are copied. ids should come from internTable or copyIds, so that they are released with it
+    void internNames(const SteamGameTable &table, std::size_t firstRow, std::vector<uint32_t> &ids);
+
+    //Copy of ids, with references of its own
+    std::shared_ptr<std::vector<uint32_t> > copyIds(const std::vector<uint32_t> &ids);
+
+    //Release a reference to every id of ids
+    void release(const std::vector<uint32_t> &ids);
+
+    //Copy the names still used of tables that were destroyed, so that the memory of the tables is freed.
+    //Also done whenever ids are interned or released
+    void prune();
+
+    std::string name(uint32_t id) const;
+    std::size_t size() const;                   //Number of distinct names in use
+    std::size_t memoryUsage() const;            //Not counting the names of tables that are still alive
+
+private:
+    //A name, either in m_names or in the names of a table
+    struct Name {
+        uint32_t hash;                          //Low bits of the hash, so that growing doesn't hash the names again
+        uint32_t block;                         //0 for m_names, otherwise the index in m_blocks
+        uint32_t offset, length;
+        uint32_t references;                    //0 if the id is free
+    };
+
+    //Names of a table, that names of the dictionary refer to
+    struct Block {
+        std::shared_ptr<const std::vector<char> > names;    //Null if the block is free
+        std::size_t ids;                        //Names of the dictionary in the block
+    };
+
+    std::shared_ptr<std::vector<uint32_t> > releasedWith(std::vector<uint32_t> *ids);  //Release ids on destruction
+    void hashNames(const SteamGameTable &table, std::size_t firstRow, std::vector<uint64_t> &hashes) const;
+    const char *nameData(const Name &name) const;
+    uint32_t internLocked(const char *name, std::size_t length, uint64_t hash, uint32_t block, uint32_t offset);
+    void copyUnsharedBlocks();                  //Copy the names still used of tables that are gone into m_names
+    void rehash(std::size_t slots);             //Rebuild m_slots with the ids in use
+
+    mutable std::mutex m_mutex;
+    std::vector<char> m_names;                  //Names that were copied, with gaps left by released ones
+    std::size_t m_releasedBytes;                //Bytes of m_names of released names
+    std::vector<Name> m_ids;
+    std::vector<uint32_t> m_freeIds;
+    std::vector<Block> m_blocks;                //Block 0 stands for m_names
+    std::vector<uint32_t> m_freeBlocks;
+    std::vector<uint32_t> m_slots;              //Open addressing: id + 1, or 0 if the slot is empty
+};
+
+#endif
@@ -0,0 +1,216 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Scoped timers and counters of the hot paths, shown in the window and written as a Chrome trace
+//
+// Author: Francois Stelluti
+//
+
+#include "PerfTrace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+//Beyond this, spans are no longer recorded (about 80 MB), but the overlay and counters keep working
+const std::size_t kMaxEvents = 1 << 20;
+
+std::atomic<int> g_nextThread(0);
+
+void writeJsonString(std::ostream &out, const std::string &text)
+{
+    out << '"';
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+const char *perfCounterName(PerfCounter counter)
+{
+    switch (counter) {
+    case PerfCounter::REvaluations:     return "R evaluations";
+    case PerfCounter::RBytes:           return "R bytes";
+    case PerfCounter::TempFileBytes:    return "Temp file bytes";
+    case PerfCounter::Allocations:      return "Allocations";
+    default:                            return "";
+    }
+}
+
+PerfTrace &PerfTrace::global()
+{
+    static PerfTrace trace;
+    return trace;
+}
+
+PerfTrace::PerfTrace() : m_enabled(false), m_origin(Clock::now())
+{
+    for (int i = 0; i < static_cast<int>(PerfCounter::NumCounters); ++i)
+        m_counters[i] = 0;
+}
+
+void PerfTrace::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool PerfTrace::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+int PerfTrace::threadIndex()
+{
+    static thread_local int index = g_nextThread.fetch_add(1);
+    return index;
+}
+
+int64_t PerfTrace::microseconds(Clock::time_point time) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - m_origin).count();
+}
+
+void PerfTrace::addSpan(const char *name, Clock::time_point start, Clock::time_point end)
+{
+    if (!isEnabled())
+        return;
+
+    Event event = Event();
+    event.name = name;
+    event.phase = 'X';
+    event.thread = threadIndex();
+    event.start = microseconds(start);
+    event.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_events.size() < kMaxEvents)
+        m_events.push_back(event);
+
+    //Few distinct names, a linear search is enough
+    for (std::size_t i = 0; i < m_last.size(); ++i) {
+        if (m_last[i].first == name) {
+            m_last[i].second = milliseconds;
+            return;
+        }
+    }
+    m_last.push_back(std::make_pair(std::string(name), milliseconds));
+}
+
+void PerfTrace::count(PerfCounter counter, int64_t amount)
+{
+    m_counters[static_cast<int>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+int64_t PerfTrace::counter(PerfCounter counter) const
+{
+    if (counter == PerfCounter::Allocations)
+        return countedAllocations();
+    return m_counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+}
+
+void PerfTrace::recordCounters()
+{
+    if (!isEnabled())
+        return;
+
+    Event event = Event();
+    event.name = "Counters";
+    event.phase = 'C';
+    event.thread = threadIndex();
+    event.start = microseconds(Clock::now());
+    for (int i = 0; i < static_cast<int>(PerfCounter::NumCounters); ++i)
+        event.counters[i] = counter(static_cast<PerfCounter>(i));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_events.size() < kMaxEvents)
+        m_events.push_back(event);
+}
+
+void PerfTrace::setThreadName(const std::string &name)
+{
+    int thread = threadIndex();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threadNames[thread] = name;
+}
+
+std::string PerfTrace::summary() const
+{
+    std::ostringstream out;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < m_last.size(); ++i) {
+            char duration[32];
+            std::snprintf(duration, sizeof(duration), "%.2f", m_last[i].second);
+            out << (i ? ",  " : "") << m_last[i].first << " " << duration << " ms";
+        }
+    }
+
+    out << "\n";
+    for (int i = 0; i < static_cast<int>(PerfCounter::NumCounters); ++i)
+        out << (i ? ",  " : "") << perfCounterName(static_cast<PerfCounter>(i)) << " " << counter(static_cast<PerfCounter>(i));
+    return out.str();
+}
+
+bool PerfTrace::writeChromeTrace(const std::string &path) const
+{
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    for (std::map<int, std::string>::const_iterator it = m_threadNames.begin(); it != m_threadNames.end(); ++it) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it->first
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, it->second);
+        out << "}}";
+        first = false;
+    }
+
+    for (std::size_t i = 0; i < m_events.size(); ++i) {
+        const Event &event = m_events[i];
+        out << (first ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out, event.name);
+        out << ",\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.start;
+
+        if (event.phase == 'X') {
+            out << ",\"dur\":" << event.duration << "}";
+        } else {
+            out << ",\"args\":{";
+            for (int c = 0; c < static_cast<int>(PerfCounter::NumCounters); ++c) {
+                out << (c ? "," : "");
+                writeJsonString(out, perfCounterName(static_cast<PerfCounter>(c)));
+                out << ":" << event.counters[c];
+            }
+            out << "}}";
+        }
+        first = false;
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out.flush());
+}
+
+ScopedTimer::ScopedTimer(const char *name, PerfTrace &trace) : m_name(name), m_trace(trace), m_enabled(trace.isEnabled())
+{
+    if (m_enabled)
+        m_start = PerfTrace::Clock::now();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (m_enabled)
+        m_trace.addSpan(m_name, m_start, PerfTrace::Clock::now());
+}
@@ -0,0 +1,109 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Scoped timers and counters of the hot paths, shown in the window and written as a Chrome trace
+//
+// Author: Francois Stelluti
+//
+
+#ifndef PerfTrace_H
+#define PerfTrace_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Counters are always kept, they are a single atomic add
+enum class PerfCounter {
+    REvaluations,           //Strings parsed and evaluated by R
+    RBytes,                 //Bytes of results returned by R (SVG text)
+    TempFileBytes,          //Bytes R wrote to temporary files
+    Allocations,            //Calls to operator new, in the whole application (from countedAllocations)
+    NumCounters
+};
+
+const char *perfCounterName(PerfCounter counter);
+
+//Calls to operator new so far. Defined with the replacement operator new, in AllocationCounter.cpp
+int64_t countedAllocations();
+
+//Timed spans of the application, recorded only while enabled. Spans can be recorded from any thread
+class PerfTrace
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    //Trace of the whole application, enabled with --trace <file> or STEAMSTATS_TRACE
+    static PerfTrace &global();
+
+    PerfTrace();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    //Record a span that ran from start to end on the calling thread
+    void addSpan(const char *name, Clock::time_point start, Clock::time_point end);
+
+    void count(PerfCounter counter, int64_t amount = 1);
+    int64_t counter(PerfCounter counter) const;
+
+    //Add the current value of every counter to the trace, so the timeline shows how they grow
+    void recordCounters();
+
+    //Name of the calling thread in the trace, e.g. 'R'
+    void setThreadName(const std::string &name);
+
+    //Most recent duration of each span name, in the order they were first seen, then a line with
+    //the counters. Used by the overlay of the window
+    std::string summary() const;
+
+    //Write every recorded event as a Chrome trace-event JSON file, which chrome://tracing and
+    //Perfetto can load. Returns false if the file can't be written
+    bool writeChromeTrace(const std::string &path) const;
+
+private:
+    struct Event {
+        const char *name;
+        char phase;                 //'X' for a span, 'C' for counters
+        int thread;
+        int64_t start;              //Microseconds since the trace was created
+        int64_t duration;
+        int64_t counters[static_cast<int>(PerfCounter::NumCounters)];
+    };
+
+    int threadIndex();              //Small number identifying the calling thread in the trace
+    int64_t microseconds(Clock::time_point time) const;
+
+    std::atomic<bool> m_enabled;
+    std::atomic<int64_t> m_counters[static_cast<int>(PerfCounter::NumCounters)];
+    Clock::time_point m_origin;
+
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::vector<std::pair<std::string, double> > m_last;   //Most recent duration of each span name, in ms
+    std::map<int, std::string> m_threadNames;
+};
+
+//Times the scope it is declared in, e.g. ScopedTimer timer("readFile");
+//The name must be a string literal, or live as long as the trace
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const char *name, PerfTrace &trace = PerfTrace::global());
+    ~ScopedTimer();
+
+private:
+    ScopedTimer(const ScopedTimer &);
+    ScopedTimer &operator=(const ScopedTimer &);
+
+    const char *m_name;
+    PerfTrace &m_trace;
+    bool m_enabled;
+    PerfTrace::Clock::time_point m_start;
+};
+
+#endif
@@ -0,0 +1,68 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Columns of a game table as they are plotted, shared by the window and batch mode
+//
+// Author: Francois Stelluti
+//
+
+#include "PlotData.h"
+
+#include <cctype>
+#include <limits>
+
+const char *plotVariableName(GameColumn column)
+{
+    switch (column)
+    {
+        case GameColumn::Price:
+            return "price";
+        case GameColumn::Userscore:
+            return "userscore";
+        case GameColumn::Owners:
+            return "Owners";
+        case GameColumn::Playtime:
+            return "playtime";
+        case GameColumn::Metascore:
+            return "metascore";
+        case GameColumn::OwnersError:
+            return "ownersError";
+        case GameColumn::MedianPlaytime:
+            return "";
+    }
+
+    return "";
+}
+
+bool findPlotVariable(const char *name, GameColumn &column)
+{
+    for (int c = 0; c <= static_cast<int>(GameColumn::OwnersError); ++c) {
+        const char *candidate = plotVariableName(static_cast<GameColumn>(c));
+
+        std::size_t i = 0;
+        while (name[i] && candidate[i] && std::tolower(name[i]) == std::tolower(candidate[i]))
+            ++i;
+
+        if (name[i] == '\0' && candidate[i] == '\0') {
+            column = static_cast<GameColumn>(c);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void getPlotValues(const SteamGameTable &table, GameColumn column, std::vector<double> &values)
+{
+    //Playtime is stored in minutes, plot it in hours
+    double scale = column == GameColumn::Playtime || column == GameColumn::MedianPlaytime ? 1.0 / 60.0 : 1.0;
+
+    values.resize(table.size());
+    table.copyColumn(column, values.data(), scale, std::numeric_limits<double>::quiet_NaN());
+}
+
+void getPlotValues(const SteamGameTable &table, GameColumn column, const RowSelection &selection,
+                   std::vector<double> &values)
+{
+    getPlotValues(table, column, values);
+    values.resize(selection.compact(values.data()));
+}
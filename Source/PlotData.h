@@ -0,0 +1,29 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Columns of a game table as they are plotted, shared by the window and batch mode
+//
+// Author: Francois Stelluti
+//
+
+#ifndef PlotData_H
+#define PlotData_H
+
+#include "GameFilter.h"
+#include "SteamGameTable.h"
+
+#include <vector>
+
+//Name of a column in plots and in R, e.g. "price". Empty for columns that can't be plotted
+const char *plotVariableName(GameColumn column);
+
+//Find a column from its plot variable name, ignoring case. Returns false if there is none
+bool findPlotVariable(const char *name, GameColumn &column);
+
+//Values of a column as plotted, with missing values as NaN. Playtimes are converted from minutes to hours
+void getPlotValues(const SteamGameTable &table, GameColumn column, std::vector<double> &values);
+
+//Values of the selected rows only, in the order of the table
+void getPlotValues(const SteamGameTable &table, GameColumn column, const RowSelection &selection,
+                   std::vector<double> &values);
+
+#endif
@@ -0,0 +1,47 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Reduces the points of a scatter plot to those that can be told apart on screen
+//
+// Author: Francois Stelluti
+//
+
+#include "PointDecimation.h"
+
+#include <cmath>
+
+std::vector<uint32_t> decimatePoints(const double *x, const double *y, std::size_t n,
+                                     double xMin, double xMax, double yMin, double yMax,
+                                     int cols, int rows)
+{
+    std::vector<uint32_t> kept;
+    if (cols <= 0 || rows <= 0 || !(xMax > xMin) || !(yMax > yMin))
+        return kept;
+
+    //One bit per cell, set once a point has been kept there
+    std::vector<uint64_t> occupied((static_cast<std::size_t>(cols) * rows + 63) / 64, 0);
+    double xScale = cols / (xMax - xMin);
+    double yScale = rows / (yMax - yMin);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        //Written so that NaN fails the comparisons
+        if (!(x[i] >= xMin && x[i] <= xMax && y[i] >= yMin && y[i] <= yMax))
+            continue;
+
+        int col = static_cast<int>((x[i] - xMin) * xScale);
+        int row = static_cast<int>((y[i] - yMin) * yScale);
+        if (col == cols)
+            --col;
+        if (row == rows)
+            --row;
+
+        std::size_t cell = static_cast<std::size_t>(row) * cols + col;
+        uint64_t bit = uint64_t(1) << (cell % 64);
+        if (occupied[cell / 64] & bit)
+            continue;
+
+        occupied[cell / 64] |= bit;
+        kept.push_back(static_cast<uint32_t>(i));
+    }
+
+    return kept;
+}
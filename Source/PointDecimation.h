@@ -0,0 +1,26 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Reduces the points of a scatter plot to those that can be told apart on screen
+//
+// Author: Francois Stelluti
+//
+
+#ifndef PointDecimation_H
+#define PointDecimation_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+//Plots with more points than this are decimated before drawing
+const std::size_t kDecimationThreshold = 5000;
+
+//Indexes of the points to draw, keeping one point in each cell of a cols x rows grid laid over
+//[xMin, xMax] x [yMin, yMax], which is what remains visible once overlapping points are drawn.
+//Points outside the range or with a NaN are dropped. Indexes are in increasing order. An empty range
+//(xMax == xMin, e.g. a constant column) has no grid and keeps no point, so it must be widened first
+std::vector<uint32_t> decimatePoints(const double *x, const double *y, std::size_t n,
+                                     double xMin, double xMax, double yMin, double yMax,
+                                     int cols, int rows);
+
+#endif
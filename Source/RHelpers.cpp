@@ -0,0 +1,99 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// R functions used by the application, byte-compiled once into a private environment of the R session
+//
+// Author: Francois Stelluti
+//
+
+#include "RHelpers.h"
+#include "PerfTrace.h"
+
+#include <RInside.h>
+
+namespace {
+
+//Environment holding the helpers, hidden from ls() in the global environment
+const char *kHelperEnvironment = ".steamStatsHelpers";
+
+//Parsed and compiled once at startup. The functions only use their arguments and locals,
+//so every intermediate object is released when they return
+const char *kHelperSource =
+    "local({ "
+    "  helpers <- new.env(parent=globalenv()); "
+
+    //Axes are constrained to eliminate outliers from view only,
+    //best fit using a Local Polynomial Regression Model is used
+    "  helpers$scatterPlot <- function(x, y, xName, yName, xPoints, yPoints) { "
+    "    data <- setNames(data.frame(x, y), c(xName, yName)); "
+    "    points <- if (length(xPoints) > 0) setNames(data.frame(xPoints, yPoints), c(xName, yName)) else data; "
+    "    ggplot(data, aes_string(x=xName, y=yName, colour=yName)) + geom_point(data=points, shape=16) + "
+    "      labs(title=paste(xName, 'vs', yName), x=xName, y=yName) + "
+    "      geom_smooth(method=loess, se=FALSE) + "
+    "      scale_colour_gradientn(colours=rainbow(7), guide=FALSE) "
+    "  }; "
+
+    //Render into a string with svglite. Without it, fall back to R's svg device, which can only
+    //write a file: it is read back once and removed, and its size is returned with the SVG
+    "  helpers$renderSvg <- function(plot) { "
+    "    if (requireNamespace('svglite', quietly=TRUE)) { "
+    "      device <- svglite::svgstring(width=6, height=5, pointsize=10); "
+    "      print(plot); invisible(dev.off()); "
+    "      return(list(paste(device(), collapse=''), 0)) "
+    "    } "
+    "    file <- tempfile(fileext='.svg'); "
+    "    svg(filename=file, width=6, height=5, pointsize=10); "
+    "    print(plot); invisible(dev.off()); "
+    "    bytes <- file.info(file)$size; "
+    "    text <- readChar(file, bytes, useBytes=TRUE); "
+    "    unlink(file); "
+    "    list(text, bytes) "
+    "  }; "
+
+    "  for (name in ls(helpers)) "
+    "    assign(name, compiler::cmpfun(get(name, envir=helpers)), envir=helpers); "
+    "  helpers "
+    "})";
+
+Rcpp::Function helper(const char *name)
+{
+    Rcpp::Environment helpers = Rcpp::Environment::global_env().get(kHelperEnvironment);
+    return helpers.get(name);
+}
+
+//R owns the memory of its vectors, so the values are copied once in bulk. NaN is missing in R as well
+Rcpp::NumericVector toRVector(const std::vector<double> &values)
+{
+    return Rcpp::NumericVector(values.begin(), values.end());
+}
+
+} // namespace
+
+void loadRHelpers(RInside &R)
+{
+    ScopedTimer timer("R init");
+    PerfTrace::global().count(PerfCounter::REvaluations);
+
+    R.parseEvalQ("suppressPackageStartupMessages(library(ggplot2));");
+    R.parseEvalQ(std::string(kHelperEnvironment) + " <- " + kHelperSource);
+}
+
+RPlot renderScatterPlot(RInside &, const std::vector<double> &x, const std::vector<double> &y,
+                        const std::string &xName, const std::string &yName,
+                        const std::vector<double> &xPoints, const std::vector<double> &yPoints)
+{
+    Rcpp::RObject plot;
+    {
+        ScopedTimer convertTimer("toRVector");
+        Rcpp::NumericVector rx = toRVector(x), ry = toRVector(y);
+        Rcpp::NumericVector rxPoints = toRVector(xPoints), ryPoints = toRVector(yPoints);
+        plot = helper("scatterPlot")(rx, ry, xName, yName, rxPoints, ryPoints);
+    }
+
+    Rcpp::List result = helper("renderSvg")(plot);
+    PerfTrace::global().count(PerfCounter::REvaluations);
+
+    RPlot rendered;
+    rendered.svg = Rcpp::as<std::string>(result[0]);
+    rendered.tempFileBytes = Rcpp::as<double>(result[1]);
+    return rendered;
+}
@@ -0,0 +1,33 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// R functions used by the application, byte-compiled once into a private environment of the R session
+//
+// Author: Francois Stelluti
+//
+
+#ifndef RHelpers_H
+#define RHelpers_H
+
+#include <string>
+#include <vector>
+
+class RInside;
+
+//Load ggplot2 and define the helper functions. Must be called once, on the R thread, before any other call
+void loadRHelpers(RInside &R);
+
+//Rendered ggplot and the bytes of the temporary file R's svg device needed, 0 with svglite
+struct RPlot
+{
+    std::string svg;
+    double tempFileBytes;
+};
+
+//Scatter plot of y against x with a loess curve, as an SVG of 6x5 inches. The curve is fitted on every
+//pair, the points drawn are xPoints/yPoints if they aren't empty. NaN values are missing. Must be called on
+//the R thread; nothing is left behind in the R session
+RPlot renderScatterPlot(RInside &R, const std::vector<double> &x, const std::vector<double> &y,
+                        const std::string &xName, const std::string &yName,
+                        const std::vector<double> &xPoints, const std::vector<double> &yPoints);
+
+#endif
@@ -0,0 +1,120 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Thread owning the embedded R instance, running R jobs from a queue
+//
+// Author: Francois Stelluti
+//
+
+#include "RWorker.h"
+#include "PerfTrace.h"
+
+#include <exception>
+
+#ifndef Q_OS_WIN
+#define CSTACK_DEFNS
+#include <Rinterface.h>
+#endif
+
+RWorker::RWorker(int argc, char *argv[]) : m_argc(argc), m_argv(argv), m_nextId(1), m_stopping(false)
+{
+}
+
+RWorker::~RWorker()
+{
+    stop();
+}
+
+int RWorker::post(const QString &channel, Job job)
+{
+    QMutexLocker lock(&m_mutex);
+
+    //Replace the job still waiting on this channel, if any
+    for (std::deque<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ) {
+        if (it->channel == channel)
+            it = m_requests.erase(it);
+        else
+            ++it;
+    }
+
+    Request request;
+    request.id = m_nextId++;
+    request.channel = channel;
+    request.job = job;
+    m_requests.push_back(request);
+    m_latest[channel] = request.id;
+
+    m_requestAvailable.wakeOne();
+    return request.id;
+}
+
+void RWorker::cancel(const QString &channel)
+{
+    QMutexLocker lock(&m_mutex);
+
+    for (std::deque<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ) {
+        if (it->channel == channel)
+            it = m_requests.erase(it);
+        else
+            ++it;
+    }
+
+    //No id is ever 0, so any running job of the channel is now out of date
+    m_latest[channel] = 0;
+}
+
+void RWorker::stop()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopping = true;
+        m_requests.clear();
+        m_requestAvailable.wakeAll();
+    }
+    wait();
+}
+
+bool RWorker::isLatest(const Request &request)
+{
+    QMutexLocker lock(&m_mutex);
+    return m_latest.value(request.channel) == request.id;
+}
+
+void RWorker::run()
+{
+    //Create R on this thread, so that it is only ever used from here
+    RInside R(m_argc, m_argv);
+    PerfTrace::global().setThreadName("R");
+
+#ifndef Q_OS_WIN
+    //R measures the stack of the thread that started it, disable the check rather than fail on this one
+    R_CStackLimit = (uintptr_t)-1;
+#endif
+
+    while (true) {
+        Request request;
+        {
+            QMutexLocker lock(&m_mutex);
+            if (m_requests.empty())
+                emit busyChanged(false);
+            while (!m_stopping && m_requests.empty())
+                m_requestAvailable.wait(&m_mutex);
+            if (m_stopping)
+                return;
+
+            request = m_requests.front();
+            m_requests.pop_front();
+        }
+        emit busyChanged(true);
+
+        //R calls can't be interrupted safely, so a replaced job runs to the end and its result is dropped
+        try {
+            QByteArray result = request.job(R);
+            if (isLatest(request))
+                emit finished(request.id, request.channel, result);
+        }
+        catch (std::exception &e) {
+            if (isLatest(request))
+                emit failed(request.id, request.channel, QString::fromStdString(e.what()));
+        }
+    }
+}
@@ -0,0 +1,72 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Thread owning the embedded R instance, running R jobs from a queue
+//
+// Author: Francois Stelluti
+//
+
+#ifndef RWorker_H
+#define RWorker_H
+
+#include <RInside.h>
+
+#include <QThread>
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <deque>
+#include <functional>
+
+//R isn't thread-safe, so the R instance is created and used only on this thread.
+//Jobs are posted on a named channel: a new job replaces any job still queued on the same channel,
+//and the result of a job that was replaced while it was running is dropped
+class RWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<QByteArray(RInside &)> Job;
+
+    RWorker(int argc, char *argv[]);
+    ~RWorker();                             //Stops the thread, dropping the queued jobs
+
+    //Queue a job and return its id, which is passed to finished() or failed()
+    int post(const QString &channel, Job job);
+
+    //Drop the queued job of a channel, and the result of its running job
+    void cancel(const QString &channel);
+
+    void stop();
+
+signals:
+    void finished(int id, QString channel, QByteArray result);
+    void failed(int id, QString channel, QString message);
+    void busyChanged(bool busy);            //True while jobs are queued or running
+
+protected:
+    void run();
+
+private:
+    struct Request {
+        int id;
+        QString channel;
+        Job job;
+    };
+
+    bool isLatest(const Request &request);  //False if the request has been replaced or cancelled
+
+    int m_argc;
+    char **m_argv;
+
+    QMutex m_mutex;
+    QWaitCondition m_requestAvailable;
+    std::deque<Request> m_requests;
+    QMap<QString, int> m_latest;            //Id of the most recent job of each channel
+    int m_nextId;
+    bool m_stopping;
+};
+
+#endif
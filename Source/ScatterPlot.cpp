@@ -0,0 +1,311 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Native scatter plot with a LOESS curve, drawn with QPainter instead of ggplot2
+//
+// Author: Francois Stelluti
+//
+
+#include "ScatterPlot.h"
+#include "Loess.h"
+#include "PointDecimation.h"
+#include "PerfTrace.h"
+
+#include <QColor>
+#include <QMouseEvent>
+#include <QPainterPath>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kSmoothPoints = 80;           //Same as ggplot's stat_smooth
+
+//Axis range of the data, expanded by 5% on each side like ggplot's continuous scales
+void expandRange(double &lo, double &hi)
+{
+    if (hi <= lo) {
+        double pad = lo == 0.0 ? 1.0 : std::fabs(lo) * 0.05;
+        lo -= pad;
+        hi += pad;
+        return;
+    }
+
+    double pad = (hi - lo) * 0.05;
+    lo -= pad;
+    hi += pad;
+}
+
+//R's rainbow(7) as a gradient: red for the lowest values through to magenta for the highest
+QRgb rainbowColour(double t)
+{
+    return QColor::fromHsvF(std::max(0.0, std::min(t, 1.0)) * 6.0 / 7.0, 1.0, 1.0).rgb();
+}
+
+} // namespace
+
+ScatterPlotData makeScatterPlot(const std::vector<double> &x, const std::vector<double> &y,
+                                const QString &xLabel, const QString &yLabel)
+{
+    ScatterPlotData plot;
+    plot.title = xLabel + " vs " + yLabel;
+    plot.xLabel = xLabel;
+    plot.yLabel = yLabel;
+
+    //Keep the complete pairs, like ggplot removing rows with missing values
+    std::size_t n = std::min(x.size(), y.size());
+    plot.x.reserve(n);
+    plot.y.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::isnan(x[i]) || std::isnan(y[i]))
+            continue;
+        plot.x.push_back(x[i]);
+        plot.y.push_back(y[i]);
+    }
+
+    if (plot.x.empty())
+        return plot;
+
+    double xLo = *std::min_element(plot.x.begin(), plot.x.end());
+    double xHi = *std::max_element(plot.x.begin(), plot.x.end());
+    double yLo = *std::min_element(plot.y.begin(), plot.y.end());
+    double yHi = *std::max_element(plot.y.begin(), plot.y.end());
+
+    //Colour each point by its y value
+    plot.colours.resize(plot.y.size());
+    for (std::size_t i = 0; i < plot.y.size(); ++i)
+        plot.colours[i] = rainbowColour(yHi > yLo ? (plot.y[i] - yLo) / (yHi - yLo) : 0.0);
+
+    //LOESS curve over the range of x
+    if (xHi > xLo && plot.x.size() > 3) {
+        plot.smoothX.resize(kSmoothPoints);
+        for (int i = 0; i < kSmoothPoints; ++i)
+            plot.smoothX[i] = xLo + (xHi - xLo) * i / (kSmoothPoints - 1);
+        plot.smoothY = loessFit(plot.x.data(), plot.y.data(), plot.x.size(), plot.smoothX.data(), kSmoothPoints);
+
+        //The curve can leave the range of the points, make room for it
+        for (std::size_t i = 0; i < plot.smoothY.size(); ++i) {
+            if (std::isnan(plot.smoothY[i]))
+                continue;
+            yLo = std::min(yLo, plot.smoothY[i]);
+            yHi = std::max(yHi, plot.smoothY[i]);
+        }
+    }
+
+    expandRange(xLo, xHi);
+    expandRange(yLo, yHi);
+    plot.range.xMin = xLo;
+    plot.range.xMax = xHi;
+    plot.range.yMin = yLo;
+    plot.range.yMax = yHi;
+
+    return plot;
+}
+
+std::vector<double> axisTicks(double lo, double hi, int target)
+{
+    std::vector<double> ticks;
+    double rough = (hi - lo) / target;
+    if (!(rough > 0.0))
+        return ticks;
+
+    double magnitude = std::pow(10.0, std::floor(std::log10(rough)));
+    double normalized = rough / magnitude;
+    double step = (normalized < 1.5 ? 1.0 : normalized < 3.0 ? 2.0 : normalized < 7.0 ? 5.0 : 10.0) * magnitude;
+
+    for (double tick = std::ceil(lo / step) * step; tick <= hi + step * 1e-9; tick += step)
+        ticks.push_back(std::fabs(tick) < step * 1e-9 ? 0.0 : tick);
+    return ticks;
+}
+
+QRect scatterPlotPanel(const QFontMetrics &metrics, const QRect &rect)
+{
+    //Leave room for the title, the axis labels and the tick labels
+    int lineHeight = metrics.height();
+    return rect.adjusted(lineHeight * 2 + metrics.width("0000000"), lineHeight * 2,
+                         -lineHeight, -lineHeight * 3);
+}
+
+void drawScatterPlot(QPainter &painter, const QRect &rect, const ScatterPlotData &plot)
+{
+    drawScatterPlot(painter, rect, plot, plot.range);
+}
+
+void drawScatterPlot(QPainter &painter, const QRect &rect, const ScatterPlotData &plot, const PlotRange &view)
+{
+    painter.save();
+    painter.fillRect(rect, Qt::white);
+
+    QFontMetrics metrics(painter.font());
+    int lineHeight = metrics.height();
+    QRect panel = scatterPlotPanel(metrics, rect);
+    if (panel.width() <= 0 || panel.height() <= 0) {
+        painter.restore();
+        return;
+    }
+
+    double xScale = panel.width() / (view.xMax - view.xMin);
+    double yScale = panel.height() / (view.yMax - view.yMin);
+
+    //Grey panel with white grid lines, as in ggplot's default theme
+    painter.fillRect(panel, QColor(235, 235, 235));
+    painter.setPen(QPen(Qt::white, 1.0));
+
+    std::vector<double> xTicks = axisTicks(view.xMin, view.xMax, 5);
+    std::vector<double> yTicks = axisTicks(view.yMin, view.yMax, 5);
+
+    for (std::size_t i = 0; i < xTicks.size(); ++i) {
+        double px = panel.left() + (xTicks[i] - view.xMin) * xScale;
+        painter.drawLine(QPointF(px, panel.top()), QPointF(px, panel.bottom()));
+    }
+    for (std::size_t i = 0; i < yTicks.size(); ++i) {
+        double py = panel.bottom() - (yTicks[i] - view.yMin) * yScale;
+        painter.drawLine(QPointF(panel.left(), py), QPointF(panel.right(), py));
+    }
+
+    //Tick labels
+    painter.setPen(QColor(77, 77, 77));
+    for (std::size_t i = 0; i < xTicks.size(); ++i) {
+        double px = panel.left() + (xTicks[i] - view.xMin) * xScale;
+        painter.drawText(QRectF(px - 50, panel.bottom() + 2, 100, lineHeight),
+                         Qt::AlignHCenter | Qt::AlignTop, QString::number(xTicks[i], 'g', 6));
+    }
+    for (std::size_t i = 0; i < yTicks.size(); ++i) {
+        double py = panel.bottom() - (yTicks[i] - view.yMin) * yScale;
+        painter.drawText(QRectF(rect.left(), py - lineHeight / 2.0, panel.left() - rect.left() - 4, lineHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(yTicks[i], 'g', 6));
+    }
+
+    //Title and axis labels
+    painter.setPen(Qt::black);
+    painter.drawText(QRect(panel.left(), rect.top(), panel.width(), lineHeight * 2),
+                     Qt::AlignCenter, plot.title);
+    painter.drawText(QRect(panel.left(), panel.bottom() + lineHeight + 4, panel.width(), lineHeight * 2),
+                     Qt::AlignHCenter | Qt::AlignTop, plot.xLabel);
+
+    painter.save();
+    painter.translate(rect.left() + lineHeight / 2, panel.center().y());
+    painter.rotate(-90);
+    painter.drawText(QRect(-panel.height() / 2, -lineHeight / 2, panel.height(), lineHeight),
+                     Qt::AlignCenter, plot.yLabel);
+    painter.restore();
+
+    //Points and curve are clipped to the panel
+    painter.setClipRect(panel);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(Qt::NoPen);
+
+    const double radius = 2.0;
+    std::size_t count = plot.x.size();
+    std::vector<uint32_t> visible;
+    if (count > kDecimationThreshold) {
+        //Points closer than a point's size cover each other, only draw one of them
+        int diameter = static_cast<int>(radius * 2);
+        visible = decimatePoints(plot.x.data(), plot.y.data(), count, view.xMin, view.xMax, view.yMin, view.yMax,
+                                 panel.width() / diameter + 1, panel.height() / diameter + 1);
+        count = visible.size();
+    }
+
+    for (std::size_t k = 0; k < count; ++k) {
+        std::size_t i = visible.empty() ? k : visible[k];
+        QPointF point(panel.left() + (plot.x[i] - view.xMin) * xScale,
+                      panel.bottom() - (plot.y[i] - view.yMin) * yScale);
+        painter.setBrush(QColor(plot.colours[i]));
+        painter.drawEllipse(point, radius, radius);
+    }
+
+    //Smoothing curve, in ggplot's default blue
+    QPainterPath curve;
+    bool started = false;
+    for (std::size_t i = 0; i < plot.smoothX.size(); ++i) {
+        if (std::isnan(plot.smoothY[i])) {
+            started = false;
+            continue;
+        }
+
+        QPointF point(panel.left() + (plot.smoothX[i] - view.xMin) * xScale,
+                      panel.bottom() - (plot.smoothY[i] - view.yMin) * yScale);
+        if (started)
+            curve.lineTo(point);
+        else
+            curve.moveTo(point);
+        started = true;
+    }
+
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(QColor(51, 102, 255), 2.0));
+    painter.drawPath(curve);
+
+    painter.restore();
+}
+
+ScatterPlotWidget::ScatterPlotWidget(QWidget *parent) : QWidget(parent)
+{
+    setMinimumSize(320, 240);
+}
+
+void ScatterPlotWidget::setPlot(const ScatterPlotData &plot)
+{
+    m_plot = plot;
+    m_view = plot.range;
+    update();
+}
+
+void ScatterPlotWidget::paintEvent(QPaintEvent *)
+{
+    ScopedTimer timer("drawScatterPlot");
+    QPainter painter(this);
+    drawScatterPlot(painter, rect(), m_plot, m_view);
+}
+
+void ScatterPlotWidget::wheelEvent(QWheelEvent *event)
+{
+    QRect panel = scatterPlotPanel(fontMetrics(), rect());
+    if (panel.width() <= 0 || panel.height() <= 0)
+        return;
+
+    //Keep the value under the cursor in place, zooming in by 20% for each step of the wheel
+    double factor = std::pow(0.8, event->angleDelta().y() / 120.0);
+    double fx = double(event->pos().x() - panel.left()) / panel.width();
+    double fy = double(panel.bottom() - event->pos().y()) / panel.height();
+    double cx = m_view.xMin + fx * (m_view.xMax - m_view.xMin);
+    double cy = m_view.yMin + fy * (m_view.yMax - m_view.yMin);
+
+    m_view.xMin = cx - (cx - m_view.xMin) * factor;
+    m_view.xMax = cx + (m_view.xMax - cx) * factor;
+    m_view.yMin = cy - (cy - m_view.yMin) * factor;
+    m_view.yMax = cy + (m_view.yMax - cy) * factor;
+
+    event->accept();
+    update();
+}
+
+void ScatterPlotWidget::mousePressEvent(QMouseEvent *event)
+{
+    m_dragStart = event->pos();
+}
+
+void ScatterPlotWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    QRect panel = scatterPlotPanel(fontMetrics(), rect());
+    if (!(event->buttons() & Qt::LeftButton) || panel.width() <= 0 || panel.height() <= 0)
+        return;
+
+    //Move the view with the cursor
+    double dx = double(event->pos().x() - m_dragStart.x()) / panel.width() * (m_view.xMax - m_view.xMin);
+    double dy = double(event->pos().y() - m_dragStart.y()) / panel.height() * (m_view.yMax - m_view.yMin);
+    m_view.xMin -= dx;
+    m_view.xMax -= dx;
+    m_view.yMin += dy;
+    m_view.yMax += dy;
+
+    m_dragStart = event->pos();
+    update();
+}
+
+void ScatterPlotWidget::mouseDoubleClickEvent(QMouseEvent *)
+{
+    m_view = m_plot.range;
+    update();
+}
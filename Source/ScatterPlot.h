@@ -0,0 +1,78 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Native scatter plot with a LOESS curve, drawn with QPainter instead of ggplot2
+//
+// Author: Francois Stelluti
+//
+
+#ifndef ScatterPlot_H
+#define ScatterPlot_H
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPoint>
+#include <QRect>
+#include <QRgb>
+#include <QString>
+#include <QWidget>
+
+#include <vector>
+
+//Range of the axes
+struct PlotRange
+{
+    double xMin = 0.0, xMax = 1.0;
+    double yMin = 0.0, yMax = 1.0;
+};
+
+//Everything needed to draw a plot, prepared once so that repainting only draws
+struct ScatterPlotData
+{
+    QString title, xLabel, yLabel;
+    std::vector<double> x, y;               //Complete pairs only
+    std::vector<QRgb> colours;              //Colour of each point, from its y value
+    PlotRange range;                        //Range of all the points and of the curve
+    std::vector<double> smoothX, smoothY;   //LOESS curve, always fitted on every point
+};
+
+//Drop the pairs with a NaN, then compute the colours, the axes and the LOESS curve, like the ggplot
+//of SteamGameStats::plot (rainbow gradient on y, geom_smooth(method=loess) evaluated at 80 points)
+ScatterPlotData makeScatterPlot(const std::vector<double> &x, const std::vector<double> &y,
+                                const QString &xLabel, const QString &yLabel);
+
+//Round numbers between lo and hi, about 'target' of them, for the ticks of an axis
+std::vector<double> axisTicks(double lo, double hi, int target);
+
+//Area of rect inside the axes, where the points are drawn
+QRect scatterPlotPanel(const QFontMetrics &metrics, const QRect &rect);
+
+//Draw the part of a plot inside view, in rect. Doesn't need a widget, so it can also paint into an image
+//or an SVG. Above kDecimationThreshold points, only one point per cell of the size of a point is drawn
+void drawScatterPlot(QPainter &painter, const QRect &rect, const ScatterPlotData &plot, const PlotRange &view);
+void drawScatterPlot(QPainter &painter, const QRect &rect, const ScatterPlotData &plot);
+
+//Zooms with the mouse wheel around the cursor, pans by dragging, and double-click shows the whole plot again.
+//Decimation depends on the view, so zooming in shows every point of the zoomed area
+class ScatterPlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ScatterPlotWidget(QWidget *parent = 0);
+
+    void setPlot(const ScatterPlotData &plot);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void wheelEvent(QWheelEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mouseDoubleClickEvent(QMouseEvent *event);
+
+private:
+    ScatterPlotData m_plot;
+    PlotRange m_view;           //Part of the plot being displayed
+    QPoint m_dragStart;
+};
+
+#endif
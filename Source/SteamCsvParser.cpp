@@ -0,0 +1,420 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Streaming parser for SteamSpy CSV exports, producing typed columns directly
+//
+// Author: Francois Stelluti
+//
+
+#include "SteamCsvParser.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const std::size_t kReadBlockSize = 1 << 20;     //Bytes read from the file at a time
+const double kNA = std::numeric_limits<double>::quiet_NaN();
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+void skipSpaces(const char *&p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+}
+
+//Parse an integer that may use ',' as a thousands separator (ex: "217,241")
+bool parseGroupedInteger(const char *&p, const char *end, double &value)
+{
+    const char *start = p;
+    double result = 0.0;
+
+    while (p < end && (isDigit(*p) || *p == ',')) {
+        if (*p != ',')
+            result = result * 10.0 + (*p - '0');
+        ++p;
+    }
+
+    value = result;
+    return p != start;
+}
+
+//Parse a decimal number such as "9.89"
+bool parseDecimal(const char *&p, const char *end, double &value)
+{
+    const char *start = p;
+    double result = 0.0;
+
+    while (p < end && isDigit(*p))
+        result = result * 10.0 + (*p++ - '0');
+
+    if (p < end && *p == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p < end && isDigit(*p)) {
+            result += (*p++ - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+
+    value = result;
+    return p != start;
+}
+
+//Parse a percentage such as "98%", 'N/A' gives NaN
+double parsePercent(const char *&p, const char *end)
+{
+    double value;
+    if (!parseDecimal(p, end, value))
+        value = kNA;
+
+    //Skip the rest of the token ('%' or 'N/A')
+    while (p < end && *p != ' ' && *p != '(' && *p != ')')
+        ++p;
+
+    return value;
+}
+
+//Parse a time in the format HH:MM and return the number of minutes, 'N/A' gives NaN
+double parseMinutes(const char *&p, const char *end)
+{
+    double hours, minutes = 0.0;
+    if (!parseDecimal(p, end, hours))
+        return kNA;
+
+    if (p < end && *p == ':') {
+        ++p;
+        parseDecimal(p, end, minutes);
+    }
+
+    return hours * 60.0 + minutes;
+}
+
+//Parse a release date, "Apr 23, 2015", "23 Apr, 2015" or "Apr 2015" (the 1st of the month)
+int32_t parseReleaseDate(const char *p, const char *end)
+{
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    //Words separated by spaces and commas: a month, and one or two numbers with the year last
+    int month = 0, numbers = 0;
+    double day = 1.0, year = 0.0;
+    while (p < end) {
+        if (*p == ' ' || *p == ',') {
+            ++p;
+        } else if (isDigit(*p)) {
+            day = year;
+            parseDecimal(p, end, year);
+            ++numbers;
+        } else {
+            const char *word = p;
+            while (p < end && *p != ' ' && *p != ',')
+                ++p;
+            for (int m = 0; m < 12 && p - word >= 3; ++m)
+                if (std::memcmp(word, months + 3 * m, 3) == 0)
+                    month = m + 1;
+        }
+    }
+
+    if (numbers == 1)
+        day = 1.0;
+    if (month == 0 || numbers < 1 || numbers > 2 || year < 1970.0 || year > 2100.0 || day < 1.0 || day > 31.0)
+        return kUnknownReleaseDate;
+    return releaseDay(static_cast<int>(year), month, static_cast<int>(day));
+}
+
+//Move to the value inside the brackets of a pair such as "98% (87%)"
+bool skipToBracket(const char *&p, const char *end)
+{
+    while (p < end && *p != '(')
+        ++p;
+
+    if (p == end)
+        return false;
+
+    ++p;
+    return true;
+}
+
+} // namespace
+
+SteamCsvParser::SteamCsvParser()
+{
+    reset();
+}
+
+void SteamCsvParser::reset()
+{
+    //Default layout of a SteamSpy export, used if the file has no header
+    m_columns[GameColumn] = 1;
+    m_columns[ReleaseDateColumn] = 2;
+    m_columns[PriceColumn] = 3;
+    m_columns[ScoreColumn] = 4;
+    m_columns[OwnersColumn] = 5;
+    m_columns[PlaytimeColumn] = 6;
+    m_minFields = 7;
+    m_haveHeader = false;
+    m_skippedRows = 0;
+}
+
+std::size_t SteamCsvParser::skippedRows() const
+{
+    return m_skippedRows;
+}
+
+void SteamCsvParser::parseFile(const std::string &path, SteamGameTable &table)
+{
+    table.clear();
+    appendFile(path, table);
+}
+
+void SteamCsvParser::appendFile(const std::string &path, SteamGameTable &table)
+{
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Unable to open " + path);
+
+    reset();
+
+    //Read the file in blocks, keeping the incomplete record at the end of each block for the next one
+    std::vector<char> buffer(kReadBlockSize);
+    std::size_t pending = 0;
+
+    while (true) {
+        if (pending == buffer.size())
+            buffer.resize(buffer.size() * 2);      //A single record is larger than the buffer
+
+        in.read(&buffer[pending], buffer.size() - pending);
+        std::size_t length = pending + static_cast<std::size_t>(in.gcount());
+        bool atEof = !in;
+
+        std::size_t consumed = parseBuffer(&buffer[0], &buffer[0] + length, table, atEof);
+        if (atEof)
+            break;
+
+        pending = length - consumed;
+        std::memmove(&buffer[0], &buffer[consumed], pending);
+    }
+}
+
+std::size_t SteamCsvParser::parseBuffer(const char *begin, const char *end, SteamGameTable &table, bool atEof)
+{
+    const char *p = begin;
+
+    while (p < end) {
+        const char *next = splitRecord(p, end, atEof);
+        if (!next)
+            break;      //Need more input
+
+        p = next;
+
+        //Ignore blank lines
+        if (m_fields.size() == 1 && m_fields[0].begin == m_fields[0].end)
+            continue;
+
+        if (!m_haveHeader) {
+            m_haveHeader = true;
+            if (readHeader())
+                continue;
+        }
+
+        if (!appendRecord(table))
+            ++m_skippedRows;
+    }
+
+    return static_cast<std::size_t>(p - begin);
+}
+
+std::size_t SteamCsvParser::parseHeader(const char *begin, const char *end)
+{
+    reset();
+    m_haveHeader = true;
+
+    //The first record that isn't a blank line, which is only consumed if it is a header
+    const char *p = begin;
+    while (p < end) {
+        const char *next = splitRecord(p, end, true);
+        if (m_fields.size() == 1 && m_fields[0].begin == m_fields[0].end) {
+            p = next;
+            continue;
+        }
+        return readHeader() ? static_cast<std::size_t>(next - begin) : static_cast<std::size_t>(p - begin);
+    }
+
+    return static_cast<std::size_t>(p - begin);
+}
+
+const char *SteamCsvParser::splitRecord(const char *p, const char *end, bool atEof)
+{
+    m_fields.clear();
+
+    while (true) {
+        Field field;
+        field.escaped = false;
+
+        if (p < end && *p == '"') {
+            //Quoted field, which can contain commas and doubled quotes
+            field.begin = ++p;
+            while (true) {
+                const char *quote = static_cast<const char *>(std::memchr(p, '"', end - p));
+                if (!quote) {
+                    if (!atEof)
+                        return 0;
+                    field.end = p = end;        //Unterminated quote, take the rest of the input
+                    break;
+                }
+                if (quote + 1 == end && !atEof)
+                    return 0;                   //Can't tell yet if this is a doubled quote
+                if (quote + 1 < end && quote[1] == '"') {
+                    field.escaped = true;
+                    p = quote + 2;
+                    continue;
+                }
+                field.end = quote;
+                p = quote + 1;
+                break;
+            }
+
+            //Ignore anything between the closing quote and the delimiter
+            while (p < end && *p != ',' && *p != '\n')
+                ++p;
+        }
+        else {
+            field.begin = p;
+            while (p < end && *p != ',' && *p != '\n')
+                ++p;
+            field.end = p;
+            if (field.end > field.begin && field.end[-1] == '\r')
+                --field.end;
+        }
+
+        m_fields.push_back(field);
+
+        if (p == end)
+            return atEof ? p : 0;
+        if (*p == '\n')
+            return p + 1;
+        ++p;    //Skip the comma
+    }
+}
+
+bool SteamCsvParser::readHeader()
+{
+    //Names of the columns used, as written by SteamSpy
+    static const char *names[NumColumns] = {
+        "Game",
+        "Release date",
+        "Price",
+        "Userscore (Metascore)",
+        "Owners",
+        "Playtime (Median)"
+    };
+
+    bool isHeader = false;
+    int found[NumColumns];
+    for (int c = 0; c < NumColumns; ++c)
+        found[c] = -1;
+
+    for (std::size_t i = 0; i < m_fields.size(); ++i) {
+        std::size_t length = static_cast<std::size_t>(m_fields[i].end - m_fields[i].begin);
+        for (int c = 0; c < NumColumns; ++c) {
+            if (std::strlen(names[c]) == length && std::memcmp(names[c], m_fields[i].begin, length) == 0) {
+                found[c] = static_cast<int>(i);
+                isHeader = true;
+            }
+        }
+    }
+
+    if (!isHeader)
+        return false;
+
+    //Keep the default position of any column missing from the header
+    m_minFields = 0;
+    for (int c = 0; c < NumColumns; ++c) {
+        if (found[c] >= 0)
+            m_columns[c] = found[c];
+        if (static_cast<std::size_t>(m_columns[c]) + 1 > m_minFields)
+            m_minFields = static_cast<std::size_t>(m_columns[c]) + 1;
+    }
+
+    return true;
+}
+
+bool SteamCsvParser::appendRecord(SteamGameTable &table)
+{
+    if (m_fields.size() < m_minFields)
+        return false;
+
+    //Game title, with any doubled quotes collapsed
+    const Field &game = m_fields[m_columns[GameColumn]];
+    SteamGameRow row;
+    row.name = game.begin;
+    row.nameLength = static_cast<std::size_t>(game.end - game.begin);
+    if (game.escaped) {
+        m_scratch.assign(game.begin, game.end);
+        std::string::size_type pos = 0;
+        while ((pos = m_scratch.find("\"\"", pos)) != std::string::npos)
+            m_scratch.erase(pos++, 1);
+        row.name = m_scratch.data();
+        row.nameLength = m_scratch.size();
+    }
+
+    const Field &dateField = m_fields[m_columns[ReleaseDateColumn]];
+    row.releaseDate = parseReleaseDate(dateField.begin, dateField.end);
+
+    //Price, either "$9.89" or "Free"
+    const Field &priceField = m_fields[m_columns[PriceColumn]];
+    const char *p = priceField.begin;
+    double price;
+    skipSpaces(p, priceField.end);
+    if (p < priceField.end && *p == '$')
+        ++p;
+    if (!parseDecimal(p, priceField.end, price)) {
+        if (priceField.end - p == 4 && std::memcmp(p, "Free", 4) == 0)
+            price = 0.0;
+        else
+            price = kNA;
+    }
+
+    //Scores, "98% (87%)" where either value can be 'N/A'
+    const Field &scoreField = m_fields[m_columns[ScoreColumn]];
+    p = scoreField.begin;
+    skipSpaces(p, scoreField.end);
+    double userscore = parsePercent(p, scoreField.end);
+    double metascore = skipToBracket(p, scoreField.end) ? parsePercent(p, scoreField.end) : kNA;
+
+    //Owners, "217,241 ±15,231" where the error is optional
+    const Field &ownersField = m_fields[m_columns[OwnersColumn]];
+    p = ownersField.begin;
+    double owners, ownersError = 0.0;
+    skipSpaces(p, ownersField.end);
+    if (!parseGroupedInteger(p, ownersField.end, owners))
+        return false;
+    while (p < ownersField.end && !isDigit(*p))
+        ++p;        //Skip the '±', in whichever encoding it was written
+    parseGroupedInteger(p, ownersField.end, ownersError);
+
+    //Playtimes, "12:38 (04:00)" as HH:MM for the average and the median
+    const Field &playtimeField = m_fields[m_columns[PlaytimeColumn]];
+    p = playtimeField.begin;
+    skipSpaces(p, playtimeField.end);
+    double playtime = parseMinutes(p, playtimeField.end);
+    double medianPlaytime = skipToBracket(p, playtimeField.end) ? parseMinutes(p, playtimeField.end) : kNA;
+
+    //Playtimes are never missing in practice, count an 'N/A' as no time played
+    row.price = static_cast<float>(price);
+    row.userscore = static_cast<float>(userscore);
+    row.metascore = static_cast<float>(metascore);
+    row.owners = static_cast<uint32_t>(owners);
+    row.ownersError = static_cast<uint32_t>(ownersError);
+    row.playtime = std::isnan(playtime) ? 0 : static_cast<uint32_t>(playtime);
+    row.medianPlaytime = std::isnan(medianPlaytime) ? 0 : static_cast<uint32_t>(medianPlaytime);
+    table.appendRow(row);
+
+    return true;
+}
@@ -0,0 +1,72 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Streaming parser for SteamSpy CSV exports, producing typed columns directly
+//
+// Author: Francois Stelluti
+//
+
+#ifndef SteamCsvParser_H
+#define SteamCsvParser_H
+
+#include "SteamGameTable.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class SteamCsvParser
+{
+public:
+    SteamCsvParser();
+
+    //Read the whole file into the table (the table is cleared first).
+    //Throws std::runtime_error if the file can't be opened
+    void parseFile(const std::string &path, SteamGameTable &table);
+
+    //Read the whole file and append its rows to the table, e.g. to merge several files
+    void appendFile(const std::string &path, SteamGameTable &table);
+
+    //Parse as many complete records as possible from [begin, end) and append them to the table.
+    //Returns the number of bytes consumed; the remainder is an incomplete record, unless atEof is true
+    std::size_t parseBuffer(const char *begin, const char *end, SteamGameTable &table, bool atEof);
+
+    //Read the header at the start of a file in [begin, end), if it has one, and return its length in bytes.
+    //The parser can then be copied to parse separate chunks of the rest of the file, e.g. in parallel
+    std::size_t parseHeader(const char *begin, const char *end);
+
+    void reset();                                  //Forget the header, to start a new file
+    std::size_t skippedRows() const;               //Number of malformed records that were ignored
+
+private:
+
+    //Slice of the input buffer holding one field, without the surrounding quotes
+    struct Field {
+        const char *begin;
+        const char *end;
+        bool escaped;                              //True if the field contains doubled quotes ("")
+    };
+
+    //Location of every column we use, found from the header row
+    enum ColumnId {
+        GameColumn,
+        ReleaseDateColumn,
+        PriceColumn,
+        ScoreColumn,
+        OwnersColumn,
+        PlaytimeColumn,
+        NumColumns
+    };
+
+    const char *splitRecord(const char *p, const char *end, bool atEof);   //Split one record into m_fields
+    bool readHeader();                             //Map the column names of the header, if this record is one
+    bool appendRecord(SteamGameTable &table);      //Convert the fields of a record and append it as a row
+
+    std::vector<Field> m_fields;                   //Fields of the current record
+    std::string m_scratch;                         //Used to unescape quoted fields
+    int m_columns[NumColumns];                     //Field index of every column
+    std::size_t m_minFields;                       //Number of fields a valid record needs
+    bool m_haveHeader;
+    std::size_t m_skippedRows;
+};
+
+#endif
@@ -8,18 +8,76 @@
 //
 
 #include "SteamGameStats.h"
+#include "PointDecimation.h"
+#include "PlotData.h"
+#include "PerfTrace.h"
+#include "RHelpers.h"
+#include "ThreadPool.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <exception>
 #include <iostream>
 #include <stdlib.h>
 
+namespace {
+
+//Memory used to cache data files when STEAMSTATS_CACHE_MB isn't set
+const std::size_t kDefaultCacheMegabytes = 256;
+
+std::size_t cacheBudget()
+{
+    bool ok = false;
+    std::size_t megabytes = qgetenv("STEAMSTATS_CACHE_MB").toUInt(&ok);
+    if (!ok)
+        megabytes = kDefaultCacheMegabytes;
+    return megabytes * 1024 * 1024;
+}
+
+//Widen an empty range, that of a constant column, as the native plot does, so that a grid can be laid over it
+void padEmptyRange(double &lo, double &hi)
+{
+    if (hi != lo)
+        return;
+    double pad = lo == 0.0 ? 1.0 : std::fabs(lo) * 0.05;
+    lo -= pad;
+    hi += pad;
+}
+
+//Number of resamples an interval was taken from, shown when it is fewer than the window asks for
+QString resampleNote(std::size_t resamples)
+{
+    if (resamples >= BootstrapOptions().resamples)
+        return QString();
+    return " (" + QString::number(resamples) + " resamples)";
+}
+
+} // namespace
+
 //Constructor sets to default year to 2015, the number of games considered and average price to zero.
-SteamGameStats::SteamGameStats(RInside & R) : m_R(R), m_year(2015), m_numGames(0), m_avgPrice(0.0)
+SteamGameStats::SteamGameStats(RWorker & R) : m_R(R), m_year(2015), m_dataDirectory(findDataDirectory()), m_cache(cacheBudget()), m_numGames(0), m_avgPrice(0.0),
+    m_selection(0), m_filterVersion(0), m_lastFilterVersion(0), m_correlationIntervalRequest(0), m_ownerIntervalRequest(0),
+    m_plotX(Price), m_plotY(Userscore), m_plotRequest(0), m_plotRequestX(Price), m_plotRequestY(Userscore),
+    m_plotRequestFilter(0)
 {
-    //Set up temp files used for plots
-    m_tempfile = QString::fromStdString(Rcpp::as<std::string>(m_R.parseEval("tfile <- tempfile()")));
-    m_svgfile = QString::fromStdString(Rcpp::as<std::string>(m_R.parseEval("sfile <- tempfile()")));
+    //Load ggplot2 and compile the R functions once, on the R thread like every other R call
+    m_R.post("init", [](RInside &R) {
+        loadRHelpers(R);
+        return QByteArray();
+    });
 
-    m_R.parseEvalQ("library(ggplot2);");    //Load the ggplot2 library
+    //Plots are rendered asynchronously and displayed when R is done
+    QObject::connect(&m_R, SIGNAL(finished(int,QString,QByteArray)), this, SLOT(plotRendered(int,QString,QByteArray)));
+    QObject::connect(&m_R, SIGNAL(failed(int,QString,QString)), this, SLOT(plotFailed(int,QString,QString)));
+    QObject::connect(&m_R, SIGNAL(busyChanged(bool)), this, SLOT(setRBusy(bool)));
+
+    //Bootstrap intervals come back from the thread pool as arguments of queued calls
+    qRegisterMetaType<ConfidenceInterval>("ConfidenceInterval");
+    qRegisterMetaType<OwnerIntervals>("OwnerIntervals");
 
     //Instantiate labels and other UI components for each statistic
     numGamesLabel = new QLabel();
@@ -27,6 +85,7 @@ SteamGameStats::SteamGameStats(RInside & R) : m_R(R), m_year(2015), m_numGames(0
     maxPriceLabel = new QLabel();
     avgMetaScoreLabel = new QLabel();
     totalPlaytimeLabel = new QLabel();
+    totalOwnersLabel = new QLabel();
     corrCoefficientLabel = new QLabel("Coeff: ");    //The Correlation coefficient
     p_valueLabel = new QLabel("p-value: ");          //p-value for the correlation test
     correlationTestMessageLabel = new QLabel();
@@ -35,16 +94,49 @@ SteamGameStats::SteamGameStats(RInside & R) : m_R(R), m_year(2015), m_numGames(0
     yearCombo = new QComboBox();
     plotVarComboX = new QComboBox();
     plotVarComboY = new QComboBox();
+    correlationMethodCombo = new QComboBox();
+    plotModeCombo = new QComboBox();
+    intervalCheck = new QCheckBox("95% CI");
+    watchCheck = new QCheckBox("Watch");
+    m_watcher = new QFileSystemWatcher(this);
+    m_watchTimer = new QTimer(this);
     estimationBox = new QGroupBox();
+    topGamesPanel = new TopGamesPanel();
+    groupByPanel = new GroupByPanel();
 
     correlationButton = new QPushButton("Correlation Test");
     plotButton = new QPushButton("Plot Data");
+    correlationMatrixButton = new QPushButton("Correlation Matrix");
+    m_matrixView = 0;
+    trendsButton = new QPushButton("Trends");
+    m_trendsView = 0;
+    gamesButton = new QPushButton("Games");
+    m_historyView = 0;
+    filtersButton = new QPushButton("Filters");
+    m_filterPanel = 0;
+    plotProgress = new QProgressBar();
+    perfLabel = new QLabel();
 
     //Initialize and display the GUI
     setupDisplay();
+
+    //Parse the other years while the first plot is displayed
+    preloadDataFiles();
 }
 
-SteamGameStats::~SteamGameStats() {}
+SteamGameStats::~SteamGameStats()
+{
+    //Intervals still queued won't start, those running hand their result to a window that is gone
+    m_correlationIntervalRequest = 0;
+    m_ownerIntervalRequest = 0;
+    for (std::size_t i = 0; i < m_intervalTasks.size(); ++i)
+        m_intervalTasks[i].wait();
+
+    delete m_matrixView;
+    delete m_trendsView;
+    delete m_historyView;
+    delete m_filterPanel;
+}
 
 void SteamGameStats::setupDisplay(void)
 {
@@ -67,6 +159,8 @@ void SteamGameStats::setupDisplay(void)
     plotVarComboX->addItem("Userscore");
     plotVarComboX->addItem("Owners");
     plotVarComboX->addItem("Playtime");
+    plotVarComboX->addItem("Metascore");
+    plotVarComboX->addItem("Owners error");
     plotVarComboX->setCurrentIndex(0);
     plotVarComboX->setFixedWidth(100);
 
@@ -74,6 +168,8 @@ void SteamGameStats::setupDisplay(void)
     plotVarComboY->addItem("Userscore");
     plotVarComboY->addItem("Owners");
     plotVarComboY->addItem("Playtime");
+    plotVarComboY->addItem("Metascore");
+    plotVarComboY->addItem("Owners error");
     plotVarComboY->setCurrentIndex(1);      //Make sure the starting index is different
     plotVarComboY->setFixedWidth(100);
 
@@ -82,10 +178,71 @@ void SteamGameStats::setupDisplay(void)
     plotButton->setMaximumWidth(120);
 
     //Set properties of the correlation button
-    correlationButton->setToolTip("Correlation Test using Pearson's' coefficient");
+    correlationButton->setToolTip("Correlation Test using the selected coefficient");
     correlationButton->setMaximumWidth(130);
 
+    //Correlation methods, in the same order as CorrelationMethod
+    correlationMethodCombo->addItem("Pearson");
+    correlationMethodCombo->addItem("Spearman");
+    correlationMethodCombo->addItem("Kendall");
+    correlationMethodCombo->setFixedWidth(100);
+
+    //Confidence intervals are resampled natively, so they are off until asked for
+    intervalCheck->setToolTip("Bootstrap confidence intervals of the correlation and the owners,\n"
+                              "including the sampling error of the owner estimates.\n"
+                              "Large selections are resampled fewer times, Spearman and Kendall first;\n"
+                              "the number of resamples is then shown after the interval");
+
+    //Exports are written in pieces, they are read once nothing has been written for a moment
+    watchCheck->setToolTip("Add the games appended to the data file of the year as they are exported");
+    watchCheck->setChecked(watchRequested());
+    m_watchTimer->setSingleShot(true);
+    m_watchTimer->setInterval(250);
+
+    //Set properties of the correlation matrix button
+    correlationMatrixButton->setToolTip("Pearson correlation of every pair of variables, for every year");
+    correlationMatrixButton->setMaximumWidth(130);
+
+    //Set properties of the trends button
+    trendsButton->setToolTip("Statistics of every year of data");
+    trendsButton->setMaximumWidth(90);
+
+    //Set properties of the games button
+    gamesButton->setToolTip("Every game of every year, and how it changed");
+    gamesButton->setMaximumWidth(90);
+
+    //Set properties of the filters button
+    filtersButton->setToolTip("Only include some of the games in the statistics, plot and correlation");
+    filtersButton->setMaximumWidth(80);
+
+    //Native plots are drawn in milliseconds, ggplot is slower but gives the same plot as R.
+    //The distribution is a histogram and density of the X variable, drawn natively
+    plotModeCombo->addItem("Native");
+    plotModeCombo->addItem("ggplot (export quality)");
+    plotModeCombo->addItem("Distribution of X");
+    plotModeCombo->setFixedWidth(160);
+
     m_svg = new QSvgWidget();   //Initialize svg object
+    m_scatter = new ScatterPlotWidget();
+    m_distribution = new DistributionView();
+    plotStack = new QStackedWidget();
+    plotStack->addWidget(m_scatter);
+    plotStack->addWidget(m_svg);
+    plotStack->addWidget(m_distribution);
+
+    //Busy indicator while R renders a plot
+    plotProgress->setRange(0, 0);
+    plotProgress->setFormat("Rendering plot...");
+    plotProgress->setTextVisible(true);
+    plotProgress->setMaximumHeight(15);
+    plotProgress->hide();
+
+    //Timings of the last year switch and plot, only shown when tracing (--trace or --perf-overlay)
+    QFont perfFont = perfLabel->font();
+    perfFont.setPointSizeF(perfFont.pointSizeF() * 0.8);
+    perfLabel->setFont(perfFont);
+    perfLabel->setWordWrap(true);
+    perfLabel->setVisible(PerfTrace::global().isEnabled());
 
     generateStatsAndPlot(yearCombo->currentIndex());    //Generate initial plot
 
@@ -95,9 +252,33 @@ void SteamGameStats::setupDisplay(void)
     //Connect Correlaton test button
     QObject::connect(correlationButton, SIGNAL(released()), this, SLOT(displayCorrelationTest()));
 
+    //Connect Correlation matrix button
+    QObject::connect(correlationMatrixButton, SIGNAL(released()), this, SLOT(displayCorrelationMatrix()));
+
+    //Connect Trends button
+    QObject::connect(trendsButton, SIGNAL(released()), this, SLOT(displayTrends()));
+
+    //Connect Games button
+    QObject::connect(gamesButton, SIGNAL(released()), this, SLOT(displayGameHistory()));
+
+    //Connect Filters button
+    QObject::connect(filtersButton, SIGNAL(released()), this, SLOT(displayFilters()));
+
     //Connect Plot button
     QObject::connect(plotButton, SIGNAL(released()), this, SLOT(plotWithSelectedVariables()));
 
+    //Connect confidence interval checkBox
+    QObject::connect(intervalCheck, SIGNAL(toggled(bool)), this, SLOT(setIntervals(bool)));
+
+    //Connect watch checkBox, and the file watcher
+    QObject::connect(watchCheck, SIGNAL(toggled(bool)), this, SLOT(setWatching(bool)));
+    QObject::connect(m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(dataFileChanged(QString)));
+    QObject::connect(m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(dataFileChanged(QString)));
+    QObject::connect(m_watchTimer, SIGNAL(timeout()), this, SLOT(updateWatchedFile()));
+
+    //Connect plot mode comboBox
+    QObject::connect(plotModeCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(setPlotMode(int)));
+
     //Use these layouts to display multiple labels in one line
     QHBoxLayout *correlationStatsLayout = new QHBoxLayout();
     correlationStatsLayout->addWidget(p_valueLabel);
@@ -112,13 +293,27 @@ void SteamGameStats::setupDisplay(void)
 
     //Add year selection and correlation test
     QFormLayout *topLeft = new QFormLayout();
-    topLeft->addRow(tr("Select year:"), yearCombo);
+    QHBoxLayout *yearLayout = new QHBoxLayout();
+    yearLayout->addWidget(yearCombo);
+    yearLayout->addWidget(watchCheck);
+    topLeft->addRow(tr("Select year:"), yearLayout);
+    QHBoxLayout *correlationMethodLayout = new QHBoxLayout();
+    correlationMethodLayout->addWidget(correlationMethodCombo);
+    correlationMethodLayout->addWidget(intervalCheck);
+    topLeft->addRow(tr("Correlation:"), correlationMethodLayout);
+    QHBoxLayout *windowButtonLayout = new QHBoxLayout();
+    windowButtonLayout->addWidget(correlationMatrixButton);
+    windowButtonLayout->addWidget(trendsButton);
+    windowButtonLayout->addWidget(gamesButton);
+    windowButtonLayout->addWidget(filtersButton);
+    topLeft->addRow(windowButtonLayout);
     topLeft->addRow(correlationButtonLayout);
     topLeft->addRow(correlationStatsLayout);
     topLeft->addRow(plotVariableLayout);
+    topLeft->addRow(tr("Plot with:"), plotModeCombo);
 
     //Set properties of yearBox
-    yearBox->setMinimumSize(320,170);
+    yearBox->setMinimumSize(320,215);
     yearBox->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     yearBox->setLayout(topLeft);
 
@@ -129,10 +324,11 @@ void SteamGameStats::setupDisplay(void)
     topRight->addRow(tr("Maximum Price:"), maxPriceLabel);
     topRight->addRow(tr("Average Metascore:"), avgMetaScoreLabel);
     topRight->addRow(tr("Total Playtime:"), totalPlaytimeLabel);
+    topRight->addRow(tr("Total Owners:"), totalOwnersLabel);
 
     //Set properties of estimationBox
-    estimationBox->setMinimumSize(320,170);
-    estimationBox->setMaximumSize(320,170);
+    estimationBox->setMinimumSize(320,215);
+    estimationBox->setMaximumSize(320,215);
     estimationBox->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     estimationBox->setLayout(topRight);
 
@@ -141,96 +337,203 @@ void SteamGameStats::setupDisplay(void)
     upperlayout->addWidget(yearBox);
     upperlayout->addWidget(estimationBox);
 
-    //Add the svg graph picture
+    //Add the graph, native or svg
     QHBoxLayout *lowerlayout = new QHBoxLayout;
-    lowerlayout->addWidget(m_svg);
-
-    QVBoxLayout *outer = new QVBoxLayout;
-    outer->addLayout(upperlayout);
-    outer->addLayout(lowerlayout);
+    lowerlayout->addWidget(plotStack);
+
+    QVBoxLayout *left = new QVBoxLayout;
+    left->addLayout(upperlayout);
+    left->addLayout(lowerlayout);
+    left->addWidget(plotProgress);
+    left->addWidget(perfLabel);
+
+    //The top games and the grouped stats take the full height, to the right of the stats and the plot
+    QTabWidget *sideTabs = new QTabWidget();
+    sideTabs->addTab(topGamesPanel, "Top Games");
+    sideTabs->addTab(groupByPanel, "Groups");
+
+    QHBoxLayout *outer = new QHBoxLayout;
+    outer->addLayout(left);
+    outer->addWidget(sideTabs);
     window->setLayout(outer);
-    window->setMinimumSize(640,640);   //Set the size of the main window
-    window->setMaximumSize(640,640);
+    window->setMinimumSize(1000,640);   //Set the size of the main window
+    window->setMaximumSize(1000,640);
     window->show();
 }
 
 void SteamGameStats::plot(plotVariable x_axis, plotVariable y_axis)
 {
-    //Declare both variables as strings to be evaluated by R
-    std::string xVariableStatement, yVariableStatement;
+    ScopedTimer timer("plot");
 
-    //Also declare each variable name, to use within R
+    //Declare each variable name, to use within R
     std::string x_VariableName, y_VariableName;
-
-    //Set up the SVG file
-    std::string svgFile = "svg(filename=tfile,width=6,height=5,pointsize=10); ";
+    std::vector<double> xValues, yValues;
 
     //Get the data for the x_axis and y_axis
-    getPlotData(xVariableStatement, x_VariableName, x_axis);
-    getPlotData(yVariableStatement, y_VariableName, y_axis);
+    {
+        ScopedTimer dataTimer("getPlotData");
+        getPlotData(xValues, x_VariableName, x_axis);
+        getPlotData(yValues, y_VariableName, y_axis);
+    }
+
+    //Remember the variables, the correlation test is only run when asked for
+    m_plotX = x_axis;
+    m_plotY = y_axis;
+
+    //The distribution of x is binned natively, the bins are kept for every change of bandwidth
+    if (plotModeCombo->currentIndex() == 2) {
+        m_R.cancel("plot");
+        m_plotRequest = 0;
+        m_distribution->setValues(xValues, QString::fromStdString(x_VariableName));
+        plotStack->setCurrentWidget(m_distribution);
+        return;
+    }
+
+    //Draw natively, without waiting for R. Any ggplot still being rendered is no longer wanted
+    if (plotModeCombo->currentIndex() == 0) {
+        m_R.cancel("plot");
+        m_plotRequest = 0;
+        {
+            ScopedTimer scatterTimer("makeScatterPlot");
+            m_scatter->setPlot(makeScatterPlot(xValues, yValues, QString::fromStdString(x_VariableName),
+                                               QString::fromStdString(y_VariableName)));
+        }
+        plotStack->setCurrentWidget(m_scatter);
+        return;
+    }
 
-    //Construct the data to pass into the plot
-    std::string data = "dataPlot <- data.frame(" + x_VariableName + ", " + y_VariableName + "); ";
+    plotStack->setCurrentWidget(m_svg);
+
+    //Above the threshold, only give geom_point the points that can be told apart in the 6x5 inch plot,
+    //so the SVG stays small. The smoothing curve is still fitted on every point
+    std::vector<double> xPoints, yPoints;
+    if (xValues.size() > kDecimationThreshold) {
+        ScopedTimer decimateTimer("decimatePlotData");
+        decimatePlotData(xValues, yValues, xPoints, yPoints);
+    }
 
-    //Axes are constrained to eliminate outliers from view only
-    //Best fit using a Local Polynomial Regression Model is used
-    std::string plot = "print(ggplot(dataPlot, aes(x=" + x_VariableName + ","  + y_VariableName + ", colour=" + y_VariableName +")) + geom_point(shape=16) "
-                       " + labs(title='" + x_VariableName + " vs " + y_VariableName + "', x='" + x_VariableName + "', y='" + y_VariableName + "') "
-                       " + geom_smooth(method=loess,se=FALSE) "
-                       " + scale_colour_gradientn(colours=rainbow(7),guide=FALSE) );" ;
+    //Reuse the plot if it was already rendered for this year, and drop any plot still being rendered
+    QByteArray svg;
+    if (m_filterVersion == 0 && m_cache.findPlot(m_file.toStdString(), x_axis, y_axis, svg)) {
+        m_R.cancel("plot");
+        m_plotRequest = 0;
+        ScopedTimer loadTimer("svgLoad");
+        m_svg->load(svg);
+        return;
+    }
 
-    std::string dev = "dev.off();";     //End of SVG file
+    //Render on the R thread with the compiled helpers, replacing any plot that hasn't been rendered yet
+    m_plotRequestFile = m_file.toStdString();
+    m_plotRequestX = x_axis;
+    m_plotRequestY = y_axis;
+    m_plotRequestStart = PerfTrace::Clock::now();
+    m_plotRequestFilter = m_filterVersion;
+    m_plotRequest = m_R.post("plot", [=](RInside &R) {
+        ScopedTimer timer("R plot job");
+        PerfTrace &trace = PerfTrace::global();
+        RPlot plot;
+        {
+            ScopedTimer ggplotTimer("ggplot");
+            plot = renderScatterPlot(R, xValues, yValues, x_VariableName, y_VariableName, xPoints, yPoints);
+            trace.count(PerfCounter::RBytes, plot.svg.size());
+            trace.count(PerfCounter::TempFileBytes, static_cast<int64_t>(plot.tempFileBytes));
+        }
 
-    //Run the correlation test, use names of variables that are used in R
-    correlationTest(xVariableStatement, yVariableStatement, x_VariableName, y_VariableName);
+        ScopedTimer filterTimer("filterSvg");
+        return filterSvg(plot.svg);          //Simplify the svg for display by Qt
+    });
 
-    //Build command and execute in R
-    std::string cmd = svgFile + xVariableStatement + yVariableStatement + data + plot + dev;
+}
 
-    m_R.parseEvalQ(cmd);        //Parse and execute the string from R
-    filterFile();               //Simplify the svg file for display by Qt
-    m_svg->load(m_svgfile);
+void SteamGameStats::decimatePlotData(const std::vector<double> &x, const std::vector<double> &y,
+                                      std::vector<double> &xPoints, std::vector<double> &yPoints)
+{
+    //Range of the complete pairs
+    double xMin = std::numeric_limits<double>::infinity(), xMax = -xMin;
+    double yMin = xMin, yMax = -xMin;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (std::isnan(x[i]) || std::isnan(y[i]))
+            continue;
+        xMin = std::min(xMin, x[i]);
+        xMax = std::max(xMax, x[i]);
+        yMin = std::min(yMin, y[i]);
+        yMax = std::max(yMax, y[i]);
+    }
 
+    //A constant column, e.g. once a filter leaves a single value, would otherwise leave no grid and send every
+    //point to R
+    padEmptyRange(xMin, xMax);
+    padEmptyRange(yMin, yMax);
+
+    //About one cell per pixel of the plot
+    std::vector<uint32_t> kept = decimatePoints(x.data(), y.data(), x.size(), xMin, xMax, yMin, yMax, 600, 500);
+    xPoints.resize(kept.size());
+    yPoints.resize(kept.size());
+    for (std::size_t k = 0; k < kept.size(); ++k) {
+        xPoints[k] = x[kept[k]];
+        yPoints[k] = y[kept[k]];
+    }
 }
 
-void SteamGameStats::getPlotData(std::string &_VariableStatement, std::string &_VariableName, plotVariable &_axis)
+void SteamGameStats::plotRendered(int id, QString channel, QByteArray svg)
 {
-    //Get both the statement to pass into R and the variable name (used in plotting the data) from the plotVariable enum
-    switch (_axis)
+    //Ignore plots that have been replaced by a newer one
+    if (channel != "plot" || id != m_plotRequest)
+        return;
+
+    m_plotRequest = 0;
+    if (m_plotRequestFilter == 0)
+        m_cache.storePlot(m_plotRequestFile, m_plotRequestX, m_plotRequestY, svg);
     {
-        case Price:
-        {
-            _VariableStatement = getPrice();
-            _VariableName = "price";
-            break;
-        }
-        case Userscore:
-        {
-            _VariableStatement = getSelectElementsOfSet("Userscore..Metascore.", true) + //Gets User score
-                    "userscore <- gsub('\\\\(|\\\\)|\\\\%', '', Userscore..Metascore.);"   //Get rid of brackets and percent sign
-                    "userscore <- as.numeric(userscore);";
-            _VariableName = "userscore";
-            break;
-        }
-        case Owners:
-        {
-            _VariableStatement = getSelectElementsOfSet("Owners", true) + "Owners <-as.numeric(Owners);";
-            _VariableName = "Owners";
-            break;
-        }
-        case Playtime:
-        {
-            //Consider number of hours only
-            _VariableStatement = "splitPlayTimes <-unlist(strsplit(as.character(Playtime..Median.), ':'));"
-                        "playtime <- splitPlayTimes[c(TRUE,FALSE)]; playtime <-as.numeric(playtime);";       //Get hours only
-            _VariableName = "playtime";
-            break;
-        }
-        default:
-        {
-            std::cout << "Error, invalid variable" << std::endl;
-        }
+        ScopedTimer timer("svgLoad");
+        m_svg->load(svg);
     }
+
+    //From the request to the plot being displayed, including the wait for R
+    PerfTrace::global().addSpan("plotRoundTrip", m_plotRequestStart, PerfTrace::Clock::now());
+    updatePerfOverlay();
+}
+
+void SteamGameStats::plotFailed(int id, QString channel, QString message)
+{
+    if (channel == "plot" && id == m_plotRequest)
+        m_plotRequest = 0;
+
+    std::cout << "R error: " << message.toStdString() << std::endl;
+}
+
+void SteamGameStats::setPlotMode(int)
+{
+    plot(m_plotX, m_plotY);
+}
+
+void SteamGameStats::setRBusy(bool busy)
+{
+    plotProgress->setVisible(busy);
+}
+
+void SteamGameStats::updatePerfOverlay()
+{
+    PerfTrace &trace = PerfTrace::global();
+    if (!trace.isEnabled())
+        return;
+
+    trace.recordCounters();
+    perfLabel->setText(QString::fromStdString(trace.summary()));
+}
+
+void SteamGameStats::getPlotData(std::vector<double> &_values, std::string &_VariableName, plotVariable &_axis)
+{
+    //The plot variables are the first columns of the table, in the same order
+    GameColumn column = static_cast<GameColumn>(_axis);
+
+    //Get the variable name (used in plotting the data) and copy the column out of the table,
+    //the R thread converts it to an R vector
+    _VariableName = plotVariableName(column);
+    if (m_selection)
+        getPlotValues(*m_dataset.table, column, *m_selection, _values);
+    else
+        getPlotValues(*m_dataset.table, column, _values);
 }
 
 void SteamGameStats::setSteamYearDataFile(int year) {
@@ -238,32 +541,114 @@ void SteamGameStats::setSteamYearDataFile(int year) {
         m_year = year;
 }
 
-void SteamGameStats::readFile(QString file)
+QString SteamGameStats::dataDirectory() const
+{
+    return m_dataDirectory;
+}
+
+QString SteamGameStats::findDataDirectory()
 {
-    m_file = file;
+    //Directory given on the command line, as --data-dir=<dir> or --data-dir <dir>
+    QStringList args = QCoreApplication::arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i].startsWith("--data-dir="))
+            return QDir(args[i].mid(11)).absolutePath() + "/";
+        if (args[i] == "--data-dir" && i + 1 < args.size())
+            return QDir(args[i + 1]).absolutePath() + "/";
+    }
+
+    //Then the environment
+    QByteArray env = qgetenv("STEAMSTATS_DATA_DIR");
+    if (!env.isEmpty())
+        return QDir(QString::fromLocal8Bit(env)).absolutePath() + "/";
+
+    //Then a Data folder next to the application, and finally the original location
+    QDir appData(QCoreApplication::applicationDirPath() + "/Data");
+    if (appData.exists())
+        return appData.absolutePath() + "/";
 
-    //Command to read the csv file
-    std::string cmd = "SD <- read.csv(\"~/Desktop/Github/R_SteamStats/" + file.toStdString() + "\", header=TRUE)";
-    m_R.parseEvalQNT(cmd);      //Parse and execute the command string
+    return QDir::homePath() + "/Desktop/Github/R_SteamStats/Data/";
 }
 
-void SteamGameStats::getStatsByYear()
+QString SteamGameStats::yearDataFile(const QString &year) const
+{
+    //A year split across many exports is a directory of CSV files, used when there is no single file
+    QString file = year + "_SteamStats.csv";
+    QFileInfo catalogue(dataDirectory() + year + "_SteamStats");
+    if (!QFileInfo(dataDirectory() + file).exists() && catalogue.isDir())
+        return catalogue.fileName();
+    return file;
+}
+
+bool SteamGameStats::watchRequested()
+{
+    return QCoreApplication::arguments().contains("--watch") || !qgetenv("STEAMSTATS_WATCH").isEmpty();
+}
+
+void SteamGameStats::watchCurrentFile()
+{
+    if (!m_watcher->files().isEmpty())
+        m_watcher->removePaths(m_watcher->files());
+    if (!m_watcher->directories().isEmpty())
+        m_watcher->removePaths(m_watcher->directories());
+    m_watchTimer->stop();
+
+    //A directory of exports is watched for exports being added or replaced
+    if (watchCheck->isChecked() && QFileInfo(m_file).exists())
+        m_watcher->addPath(m_file);
+}
+
+QStringList SteamGameStats::dataFiles() const
+{
+    QDir dataDir(dataDirectory());
+    QStringList files = dataDir.entryList(QStringList() << "*_SteamStats.csv" << "*_SteamStats",
+                                          QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name | QDir::Reversed);
+
+    //One path per year, the one that yearDataFile picks
+    QStringList paths;
+    foreach (const QString &file, files) {
+        QString path = dataDir.filePath(yearDataFile(file.section('_', 0, 0)));
+        if (!paths.contains(path))
+            paths.append(path);
+    }
+    return paths;
+}
+
+void SteamGameStats::preloadDataFiles(void)
+{
+    //Find every year of data and load them on a background thread
+    std::vector<std::string> paths;
+    foreach (const QString &file, dataFiles())
+        paths.push_back(file.toStdString());
+
+    m_cache.preload(paths);
+}
+
+void SteamGameStats::readFile(QString file)
 {
-    std::string numGames = "nrow(SD)";    //Number of games (rows)
-    std::string averagePrice = getPrice() + "avgPrice <- mean(price); avgPrice <- round(avgPrice, digits=2)";
-    std::string maxPrice = getPrice() + "maxPrice <- max(price); maxPrice <- round(maxPrice, digits=2)";
-    std::string avgMetascore = getSelectElementsOfSet("Userscore..Metascore.", false) +
-                "avgMetascore <- gsub('\\\\(|\\\\)|\\\\%', '', Userscore..Metascore.);"   //Get rid of brackets and percent sign
-                "avgMetascore <- round(mean(as.numeric(avgMetascore),na.rm=TRUE),2);";    //Calculate the mean, ignoring N/A's and rounding to 2 decimal places
-    std::string totalPlayTime = getSelectElementsOfSet("Playtime..Median.", true) + getNumberOfHoursPlayed();
+    m_file = dataDirectory() + file;
 
-    //Store the results
-    m_numGames = m_R.parseEval(numGames);
-    m_avgPrice = m_R.parseEval(averagePrice);
-    m_maxPrice = m_R.parseEval(maxPrice);
-    m_avgMetascore = m_R.parseEval(avgMetascore);
-    m_totalPlaytime = m_R.parseEval(totalPlayTime);
+    //Get the parsed file and its stats from the cache, it is only parsed the first time
+    m_dataset = m_cache.get(m_file.toStdString());
+}
 
+void SteamGameStats::getStatsByYear()
+{
+    //The stats of every game are computed once, when the file is parsed. Those of a selection
+    //are computed from the columns each time, it takes microseconds
+    YearStats stats = m_dataset.stats;
+    TableSummary summary = m_dataset.summary;
+    if (m_selection) {
+        ScopedTimer timer("summarizeSelection");
+        summary = summarizeSelection(*m_dataset.table, *m_selection);
+        stats = computeYearStats(summary);
+    }
+    m_numGames = stats.numGames;
+    m_avgPrice = stats.avgPrice;
+    m_maxPrice = stats.maxPrice;
+    m_avgMetascore = stats.avgMetascore;
+    m_totalPlaytime = stats.totalPlaytime;
+    m_totalOwners = summary[GameColumn::Owners].sum;
 }
 
 void SteamGameStats::plotWithSelectedVariables()
@@ -280,29 +665,32 @@ void SteamGameStats::plotWithSelectedVariables()
     plot(varX, varY);     //Plot the data
 }
 
-void SteamGameStats::correlationTest(std::string variable1, std::string variable2, std::string name1, std::string name2) {
+void SteamGameStats::correlationTest(plotVariable x_axis, plotVariable y_axis) {
 
-    //Compute the Pearson product-moment correlation coefficient to see if there is a positive or negative,
+    //Compute the correlation coefficient to see if there is a positive or negative,
     //statistically significant correlation. Assuming an alpha of 0.05 to compare with the p-value
+    CorrelationMethod method = static_cast<CorrelationMethod>(correlationMethodCombo->currentIndex());
 
-    //First, evaluate the variables in R
-    m_R.parseEvalQ(variable1);
-    m_R.parseEvalQ(variable2);
-
-    //Use the variable names in subsequent commands. First preform the correlation test
-    std::string correlationTest = "corrTest <-cor.test(" + name1 + "," + name2 + ", use='complete.obs'); ";
+    ScopedTimer timer("correlationTest");
 
-    //Extract the p-value and coefficient and store the results
-    std::string p_value = "pVal <-corrTest$p.value; pVal <-round(pVal,digits=4);";
-    std::string corrCoeff = "corrEst <-corrTest$estimate; corrEst <-round(corrEst,digits=4)";
+    //The plot variables are the first columns of the table, in the same order
+    GameColumn x = static_cast<GameColumn>(x_axis), y = static_cast<GameColumn>(y_axis);
+    const CorrelationResult &result = m_selection
+        ? m_correlations.get(m_year, x, y, method, *m_dataset.table, *m_selection, m_filterVersion)
+        : m_correlations.get(m_year, x, y, method, *m_dataset.table);
 
-    m_p_value = m_R.parseEval(correlationTest + p_value);
-    m_corrCoeff = m_R.parseEval(correlationTest + corrCoeff);
+    //Store the p-value and coefficient, rounded to 4 decimal places
+    m_p_value = roundTo(result.pValue, 4);
+    m_corrCoeff = roundTo(result.estimate, 4);
 
 }
 
 void SteamGameStats::displayCorrelationTest(void)
 {
+    //Look up the test for the variables of the current plot
+    correlationTest(m_plotX, m_plotY);
+    updatePerfOverlay();
+
     //Store the p_value and correlation coefficient
     double pValue = getPValue();
     double corrCoeff = getCorrCoefficiant();
@@ -321,59 +709,157 @@ void SteamGameStats::displayCorrelationTest(void)
             correlationTestResultLabel->setText("No sig. correlation");
     }
 
-    //Display the p_value and correlation coefficient
+    //Display the p_value and correlation coefficient, with its interval if asked for
     p_valueLabel->setText("p-value: " + QString::number(pValue));
-    corrCoefficientLabel->setText("Coeff: " + QString::number(corrCoeff));
+    QString coefficient = "Coeff: " + QString::number(corrCoeff);
+    if (intervalCheck->isChecked()) {
+        const ConfidenceInterval *interval = correlationInterval(m_plotX, m_plotY);
+        if (interval)
+            coefficient += " [" + QString::number(roundTo(interval->lower, 3)) + ", "
+                           + QString::number(roundTo(interval->upper, 3)) + "]" + resampleNote(interval->resamples);
+        else
+            coefficient += " [...]";
+    }
+    corrCoefficientLabel->setText(coefficient);
 }
 
-std::string SteamGameStats::getPrice()
+const ConfidenceInterval *SteamGameStats::correlationInterval(plotVariable x_axis, plotVariable y_axis)
 {
-    //Use the variable SD, which is stored in R after reading the selected CSV file
-    //Also returns Price as a variable in R (used to get mean, average, etc)
+    CorrelationMethod method = static_cast<CorrelationMethod>(correlationMethodCombo->currentIndex());
+    GameColumn columns[2] = {static_cast<GameColumn>(x_axis), static_cast<GameColumn>(y_axis)};
+
+    const ConfidenceInterval *interval = m_intervals.findCorrelation(m_year, m_filterVersion, columns[0], columns[1], method);
+    if (interval)
+        return interval;
+
+    //Already being computed
+    std::tuple<unsigned, int, unsigned, int, int, int> request(m_intervals.generation(), m_year, m_filterVersion,
+                                                                x_axis, y_axis, static_cast<int>(method));
+    if (request == m_requestedCorrelationInterval)
+        return 0;
+    m_requestedCorrelationInterval = request;
+
+    //Values of both variables, and the '±' errors of a variable that is the owner estimate. They are copied
+    //here, as the table and the selection grow when rows are appended
+    struct Values {
+        std::vector<double> values[2], errors[2];
+    };
+    std::shared_ptr<Values> copy = std::make_shared<Values>();
+    for (int i = 0; i < 2; ++i) {
+        if (m_selection)
+            getPlotValues(*m_dataset.table, columns[i], *m_selection, copy->values[i]);
+        else
+            getPlotValues(*m_dataset.table, columns[i], copy->values[i]);
 
-    //First, eleminate the '$' symbol, set 'Free" entries to zero, and then convert the price to numbers
-    std::string priceFormatted = "SD2 <- SD; SD2$Price <- sub('$','',as.character(SD2$Price), fixed=TRUE);"
-                       "SD2$Price <- sub('Free','0',as.character(SD2$Price), fixed=TRUE);"
-                       "price <- as.numeric(SD2$Price); ";
+        if (columns[i] != GameColumn::Owners)
+            continue;
+        if (m_selection)
+            getPlotValues(*m_dataset.table, GameColumn::OwnersError, *m_selection, copy->errors[i]);
+        else
+            getPlotValues(*m_dataset.table, GameColumn::OwnersError, copy->errors[i]);
+    }
 
-    return priceFormatted;
+    unsigned number = ++m_correlationIntervalRequest;
+    unsigned generation = m_intervals.generation(), filterVersion = m_filterVersion;
+    int year = m_year;
+    m_intervalTasks.push_back(ThreadPool::global().submit([this, copy, number, generation, year, filterVersion,
+                                                          x_axis, y_axis, method]() {
+        //Another interval was asked for while this one was queued, e.g. as a filter slider moves
+        if (number != m_correlationIntervalRequest)
+            return;
+
+        ScopedTimer timer("correlationInterval");
+        const Values &v = *copy;
+        ConfidenceInterval interval = bootstrapCorrelation(method, v.values[0].data(), v.errors[0].empty() ? 0 : v.errors[0].data(),
+                                                           v.values[1].data(), v.errors[1].empty() ? 0 : v.errors[1].data(),
+                                                           v.values[0].size(), BootstrapOptions(), ThreadPool::global());
+        QMetaObject::invokeMethod(this, "correlationIntervalReady", Qt::QueuedConnection, Q_ARG(unsigned, generation),
+                                  Q_ARG(int, year), Q_ARG(unsigned, filterVersion), Q_ARG(int, x_axis),
+                                  Q_ARG(int, y_axis), Q_ARG(int, static_cast<int>(method)),
+                                  Q_ARG(ConfidenceInterval, interval));
+    }));
+    pruneIntervalTasks();
+
+    return 0;
 }
 
-std::string SteamGameStats::getSelectElementsOfSet(std::string column, bool isFirst)
+void SteamGameStats::correlationIntervalReady(unsigned generation, int year, unsigned filterVersion, int x, int y,
+                                              int method, ConfidenceInterval interval)
 {
-    //First create a string that will select either the first or second element of each tuple
-    std::string elementSelect;
-
-    if(isFirst)
-        elementSelect = "TRUE,FALSE";
-    else
-        elementSelect = "FALSE,TRUE";
+    m_intervals.storeCorrelation(generation, year, filterVersion, static_cast<GameColumn>(x), static_cast<GameColumn>(y),
+                                 static_cast<CorrelationMethod>(method), interval);
+    updatePerfOverlay();
+
+    //Show it if the test it belongs to is the one displayed
+    bool current = generation == m_intervals.generation() && year == m_year && filterVersion == m_filterVersion
+                   && x == m_plotX && y == m_plotY && method == correlationMethodCombo->currentIndex();
+    if (current && intervalCheck->isChecked() && !correlationTestResultLabel->text().isEmpty())
+        displayCorrelationTest();
+}
 
-    //Use the variable SD, which is stored in R after reading the selected CSV file
-    //Now split the string and then ignore the first or second half of the tuple
-    //Save the result as the column name
-    std::string ownersFormatted = "SD3 <- SD; SD3 <- unlist(strsplit(as.character(SD3$" + column + "), ' '));"
-                                  "SD3 <- SD3[c(" + elementSelect + ")];"
-                                  + column + " <- gsub(',','',SD3,fixed=TRUE);";
+const OwnerIntervals *SteamGameStats::selectedOwnerIntervals()
+{
+    const OwnerIntervals *intervals = m_intervals.findOwners(m_year, m_filterVersion);
+    if (intervals)
+        return intervals;
+
+    std::tuple<unsigned, int, unsigned> request(m_intervals.generation(), m_year, m_filterVersion);
+    if (request == m_requestedOwnerIntervals)
+        return 0;
+    m_requestedOwnerIntervals = request;
+
+    struct Values {
+        std::vector<double> owners, errors;
+    };
+    std::shared_ptr<Values> copy = std::make_shared<Values>();
+    if (m_selection) {
+        getPlotValues(*m_dataset.table, GameColumn::Owners, *m_selection, copy->owners);
+        getPlotValues(*m_dataset.table, GameColumn::OwnersError, *m_selection, copy->errors);
+    } else {
+        getPlotValues(*m_dataset.table, GameColumn::Owners, copy->owners);
+        getPlotValues(*m_dataset.table, GameColumn::OwnersError, copy->errors);
+    }
 
-    return ownersFormatted;
+    unsigned number = ++m_ownerIntervalRequest;
+    unsigned generation = m_intervals.generation(), filterVersion = m_filterVersion;
+    int year = m_year;
+    m_intervalTasks.push_back(ThreadPool::global().submit([this, copy, number, generation, year, filterVersion]() {
+        if (number != m_ownerIntervalRequest)
+            return;
+
+        ScopedTimer timer("ownerIntervals");
+
+        //Every game of the year is listed, so only the owner estimates are resampled, not the games
+        BootstrapOptions options;
+        options.resampleRows = false;
+        OwnerIntervals intervals = ownerIntervals(copy->owners.data(), copy->errors.data(), copy->owners.size(),
+                                                  options, ThreadPool::global());
+        QMetaObject::invokeMethod(this, "ownerIntervalsReady", Qt::QueuedConnection, Q_ARG(unsigned, generation),
+                                  Q_ARG(int, year), Q_ARG(unsigned, filterVersion), Q_ARG(OwnerIntervals, intervals));
+    }));
+    pruneIntervalTasks();
+
+    return 0;
 }
 
-std::string SteamGameStats::getNumberOfHoursPlayed()
+void SteamGameStats::ownerIntervalsReady(unsigned generation, int year, unsigned filterVersion, OwnerIntervals intervals)
 {
-    //First split the time, in the format HH:MM, into two sets (hours and mins)
-    //Then convert mins to hours and sum the total number of hours
-
-    std::string numHoursPlayed =
-    "splitPlayTimes <-unlist(strsplit(as.character(Playtime..Median.), ':'));"
-    "splitPlayTimesHour <- splitPlayTimes[c(TRUE,FALSE)];"          //Get hours only
-    "splitPlayTimesMin <- splitPlayTimes[c(FALSE,TRUE)];"
-    "totalPlayTimesMin <- strptime(splitPlayTimesMin,'%M');"        //Get minutes only
+    m_intervals.storeOwners(generation, year, filterVersion, intervals);
+    updatePerfOverlay();
 
-    //Sum all hours, rounded to 2 decimal places
-    "totalPlayTimes <- round((sum(totalPlayTimesMin$min)/60) + sum(as.numeric(splitPlayTimesHour)),2);" ;
+    if (generation == m_intervals.generation() && year == m_year && filterVersion == m_filterVersion
+        && intervalCheck->isChecked())
+        displayOwners();
+}
 
-    return numHoursPlayed;
+void SteamGameStats::pruneIntervalTasks()
+{
+    for (std::vector<std::future<void> >::iterator it = m_intervalTasks.begin(); it != m_intervalTasks.end(); ) {
+        if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            it = m_intervalTasks.erase(it);
+        else
+            ++it;
+    }
 }
 
 void SteamGameStats::generateStatsAndPlot(int comboIndex)
@@ -382,6 +868,7 @@ void SteamGameStats::generateStatsAndPlot(int comboIndex)
     //Make sure that the selected year exists, or that another exception isn't thrown
     try
     {
+        ScopedTimer timer("generateStatsAndPlot");
 
         QString yearStr = yearCombo->itemText(comboIndex);
         int yearInt = yearCombo->itemText(comboIndex).toInt();
@@ -394,16 +881,20 @@ void SteamGameStats::generateStatsAndPlot(int comboIndex)
         //Sets the year, which is used when updating the display
         setSteamYearDataFile(yearInt);
 
-        readFile("Data/" + yearStr + "_SteamStats.csv");   //Read file
-        getStatsByYear();                                  //Get all stats
+        {
+            ScopedTimer readTimer("readFile");
+            readFile(yearDataFile(yearStr));   //Read file
+        }
 
-        estimationBox->setTitle("Game Stats for:    " + QString::number(m_year));  //Display the year in the title
+        watchCurrentFile();
 
-        numGamesLabel->setText(QString::number(getNumGames()));
-        avgPriceLabel->setText("$" + QString::number(getAvgPrice()));
-        maxPriceLabel->setText("$" + QString::number(getMaxPrice()));
-        avgMetaScoreLabel->setText(QString::number(getAvgMetascore()) + "%");
-        totalPlaytimeLabel->setText(QString::number(getTotalPlaytime()) + " hours");
+        //Keep the filter on the new year, fitted to its prices and dates
+        if (m_filterPanel) {
+            m_filterPanel->setTable(*m_dataset.table);
+            setFilter(m_filterPanel->filter());
+        }
+        updateSelection();
+        displayStats();
 
         plotWithSelectedVariables();
 
@@ -412,6 +903,323 @@ void SteamGameStats::generateStatsAndPlot(int comboIndex)
     {
         std::cout << "Exception: " << e.what() << std::endl;
     }
+
+    updatePerfOverlay();
+}
+
+void SteamGameStats::displayCorrelationMatrix(void)
+{
+    try
+    {
+        //Get every year from the cache, they have normally been preloaded already
+        YearTables tables;
+        for (int i = 0; i < yearCombo->count(); ++i) {
+            QString path = dataDirectory() + yearDataFile(yearCombo->itemText(i));
+            tables.push_back(std::make_pair(yearCombo->itemText(i).toInt(), m_cache.get(path.toStdString()).table));
+        }
+
+        //Every plot variable
+        std::vector<GameColumn> columns;
+        for (int i = 0; i < plotVarComboX->count(); ++i)
+            columns.push_back(static_cast<GameColumn>(i));
+
+        CorrelationMatrix matrix;
+        {
+            ScopedTimer timer("correlationMatrix");
+            matrix = CorrelationMatrix::compute(tables, columns, ThreadPool::global());
+        }
+        updatePerfOverlay();
+
+        if (!m_matrixView)
+            m_matrixView = new CorrelationMatrixView();
+        m_matrixView->setMatrix(matrix);
+        m_matrixView->show();
+        m_matrixView->raise();
+    }
+    catch (std::exception &e)
+    {
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+}
+
+void SteamGameStats::displayTrends(void)
+{
+    try
+    {
+        //Only summarize the years that haven't been added yet, the others are kept in m_trends
+        foreach (const QString &file, dataFiles()) {
+            int year = QFileInfo(file).fileName().section('_', 0, 0).toInt();
+            if (year == 0 || m_trends.hasYear(year))
+                continue;
+
+            m_trends.addYear(year, m_cache.get(file.toStdString()).summary);
+        }
+
+        if (!m_trendsView)
+            m_trendsView = new TrendsView();
+        m_trendsView->setTrends(m_trends);
+        m_trendsView->show();
+        m_trendsView->raise();
+    }
+    catch (std::exception &e)
+    {
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+}
+
+void SteamGameStats::displayGameHistory(void)
+{
+    try
+    {
+        //Every year, oldest first. Their names were interned when they were loaded
+        std::vector<JoinYear> years;
+        foreach (const QString &file, dataFiles()) {
+            int year = QFileInfo(file).fileName().section('_', 0, 0).toInt();
+            if (year == 0)
+                continue;
+
+            YearDataset dataset = m_cache.get(file.toStdString());
+            JoinYear joinYear;
+            joinYear.year = year;
+            joinYear.table = dataset.table;
+            joinYear.nameIds = dataset.nameIds;
+            years.push_back(joinYear);
+        }
+        std::sort(years.begin(), years.end(), [](const JoinYear &a, const JoinYear &b) { return a.year < b.year; });
+
+        //Timed here as well as traced, the window shows how long the join took
+        PerfTrace::Clock::time_point start = PerfTrace::Clock::now();
+        std::shared_ptr<const GameJoin> join = std::make_shared<const GameJoin>(years, ThreadPool::global());
+        PerfTrace::Clock::time_point end = PerfTrace::Clock::now();
+        PerfTrace::global().addSpan("joinYears", start, end);
+        updatePerfOverlay();
+
+        if (!m_historyView)
+            m_historyView = new GameHistoryView();
+        m_historyView->setJoin(join, std::chrono::duration<double, std::milli>(end - start).count());
+        m_historyView->show();
+        m_historyView->raise();
+    }
+    catch (std::exception &e)
+    {
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+}
+
+void SteamGameStats::displayFilters(void)
+{
+    if (!m_filterPanel) {
+        m_filterPanel = new FilterPanel();
+        QObject::connect(m_filterPanel, SIGNAL(filterChanged()), this, SLOT(applyFilter()));
+        if (m_dataset.table) {
+            m_filterPanel->setTable(*m_dataset.table);
+            m_filterPanel->setSelectedCount(m_selection ? m_selection->count() : m_dataset.table->size(),
+                                            m_dataset.table->size());
+        }
+    }
+
+    m_filterPanel->show();
+    m_filterPanel->raise();
+}
+
+void SteamGameStats::applyFilter(void)
+{
+    if (!m_dataset.table)
+        return;
+
+    try
+    {
+        ScopedTimer timer("applyFilter");
+
+        GameFilter filter = m_filterPanel->filter();
+        if (filter == m_filter)
+            return;
+
+        //Everything is computed natively from the selection, R is only used by a ggplot
+        setFilter(filter);
+        updateSelection();
+        displayStats();
+        plot(m_plotX, m_plotY);
+
+        //Keep a correlation test that is displayed up to date
+        if (!correlationTestResultLabel->text().isEmpty())
+            displayCorrelationTest();
+    }
+    catch (std::exception &e)
+    {
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+
+    updatePerfOverlay();
+}
+
+void SteamGameStats::setIntervals(bool)
+{
+    if (!m_dataset.table)
+        return;
+
+    try
+    {
+        displayOwners();
+
+        //Keep a correlation test that is displayed up to date
+        if (!correlationTestResultLabel->text().isEmpty())
+            displayCorrelationTest();
+    }
+    catch (std::exception &e)
+    {
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+
+    updatePerfOverlay();
+}
+
+void SteamGameStats::setWatching(bool)
+{
+    watchCurrentFile();
+
+    //Catch up with what was written while the file wasn't watched
+    if (watchCheck->isChecked())
+        m_watchTimer->start();
+}
+
+void SteamGameStats::dataFileChanged(QString)
+{
+    m_watchTimer->start();
+}
+
+void SteamGameStats::updateWatchedFile(void)
+{
+    if (!m_dataset.table || !watchCheck->isChecked())
+        return;
+
+    try
+    {
+        ScopedTimer timer("updateWatchedFile");
+
+        //A file that was replaced rather than written to is no longer watched
+        if (m_watcher->files().isEmpty() && m_watcher->directories().isEmpty() && QFileInfo(m_file).exists())
+            m_watcher->addPath(m_file);
+
+        std::size_t firstRow = m_dataset.table->size();
+        YearDataset dataset;
+        DatasetChange change = m_cache.refresh(m_file.toStdString(), dataset);
+        if (change == DatasetChange::Unchanged)
+            return;
+
+        if (m_trends.hasYear(m_year)) {
+            m_trends.addYear(m_year, dataset.summary);
+            if (m_trendsView)
+                m_trendsView->setTrends(m_trends);
+        }
+
+        //Everything is read again for a rewritten file, as for a year switch
+        if (change == DatasetChange::Reloaded) {
+            m_correlations.clear();
+            m_intervals.clear();
+            generateStatsAndPlot(yearCombo->currentIndex());
+            return;
+        }
+
+        //Only the new rows are looked at: the summary was merged with theirs, the Pearson sums are updated
+        //and the filter is evaluated on them
+        m_dataset = dataset;
+        m_correlations.append(m_year, *m_dataset.table, firstRow);
+        m_intervals.dropYear(m_year);
+
+        std::size_t added = m_dataset.table->size() - firstRow;
+        if (m_selection) {
+            added = m_filterEngine.extend(*m_dataset.table, m_filter);
+            if (added > 0)
+                m_filterVersion = ++m_lastFilterVersion;    //Results of the previous selection no longer apply
+        }
+
+        if (m_filterPanel)
+            m_filterPanel->setSelectedCount(m_selection ? m_selection->count() : m_dataset.table->size(),
+                                            m_dataset.table->size());
+        topGamesPanel->setData(m_dataset.table, m_dataset.index, m_selection);
+        groupByPanel->setData(m_dataset.table, m_selection);
+
+        //Games left out by the filter change nothing that is displayed
+        if (added == 0)
+            return;
+        displayStats();
+
+        //The plot only changes if a new game has both of its values
+        GameColumn x = static_cast<GameColumn>(m_plotX), y = static_cast<GameColumn>(m_plotY);
+        bool plotChanged = false;
+        for (std::size_t row = firstRow; row < m_dataset.table->size() && !plotChanged; ++row)
+            plotChanged = (!m_selection || m_selection->contains(row)) &&
+                          !std::isnan(m_dataset.table->value(x, row)) && !std::isnan(m_dataset.table->value(y, row));
+        if (plotChanged)
+            plot(m_plotX, m_plotY);
+
+        //Keep a correlation test that is displayed up to date
+        if (!correlationTestResultLabel->text().isEmpty())
+            displayCorrelationTest();
+    }
+    catch (std::exception &e)
+    {
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+
+    updatePerfOverlay();
+}
+
+void SteamGameStats::setFilter(const GameFilter &filter)
+{
+    if (filter == m_filter)
+        return;
+
+    m_filter = filter;
+    m_filterVersion = filter.isEmpty() ? 0 : ++m_lastFilterVersion;
+}
+
+void SteamGameStats::updateSelection()
+{
+    m_selection = 0;
+    if (!m_filter.isEmpty()) {
+        ScopedTimer timer("selectRows");
+        m_selection = &m_filterEngine.select(*m_dataset.table, m_filter);
+    }
+
+    if (m_filterPanel)
+        m_filterPanel->setSelectedCount(m_selection ? m_selection->count() : m_dataset.table->size(),
+                                        m_dataset.table->size());
+
+    topGamesPanel->setData(m_dataset.table, m_dataset.index, m_selection);
+    groupByPanel->setData(m_dataset.table, m_selection);
+}
+
+void SteamGameStats::displayStats()
+{
+    getStatsByYear();                                  //Get all stats
+
+    //Display the year in the title, and whether some games are left out
+    estimationBox->setTitle("Game Stats for:    " + QString::number(m_year) + (m_selection ? "  (filtered)" : ""));
+
+    numGamesLabel->setText(QString::number(getNumGames()));
+    avgPriceLabel->setText("$" + QString::number(getAvgPrice()));
+    maxPriceLabel->setText("$" + QString::number(getMaxPrice()));
+    avgMetaScoreLabel->setText(QString::number(getAvgMetascore()) + "%");
+    totalPlaytimeLabel->setText(QString::number(getTotalPlaytime()) + " hours");
+
+    displayOwners();
+}
+
+void SteamGameStats::displayOwners()
+{
+    //Owners in millions, with the range the sampling error of the estimates allows for
+    QString owners = QString::number(getTotalOwners() / 1e6, 'f', 2) + "M";
+    if (intervalCheck->isChecked()) {
+        const OwnerIntervals *intervals = selectedOwnerIntervals();
+        if (intervals)
+            owners += " (" + QString::number(intervals->total.lower / 1e6, 'f', 2) + " to "
+                      + QString::number(intervals->total.upper / 1e6, 'f', 2) + ")" + resampleNote(intervals->total.resamples);
+        else
+            owners += " (...)";
+    }
+    totalOwnersLabel->setText(owners);
 }
 
 int SteamGameStats::getNumGames() const
@@ -439,6 +1247,11 @@ double SteamGameStats::getTotalPlaytime() const
     return m_totalPlaytime;
 }
 
+double SteamGameStats::getTotalOwners() const
+{
+    return m_totalOwners;
+}
+
 double SteamGameStats::getPValue() const
 {
     return m_p_value;
@@ -450,24 +1263,34 @@ double SteamGameStats::getCorrCoefficiant() const
 }
 
 //Author: Eddelbuettel and Romain Francois - Copyright (C) 2011
-void SteamGameStats::filterFile() {
+QByteArray SteamGameStats::filterSvg(const std::string &svg) {
     // cairoDevice creates richer SVG than Qt can display
-    // but per Michaele Lawrence, a simple trick is to s/symbol/g/ which we do here
-    QFile infile(m_tempfile);
-    infile.open(QFile::ReadOnly);
-    QFile outfile(m_svgfile);
-    outfile.open(QFile::WriteOnly | QFile::Truncate);
-
-    QTextStream in(&infile);
-    QTextStream out(&outfile);
-    QRegExp rx1("<symbol");
-    QRegExp rx2("</symbol");
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        line.replace(rx1, "<g"); // so '<symbol' becomes '<g ...'
-        line.replace(rx2, "</g");// and '</symbol becomes '</g'
-        out << line << "\n";
-    }
-    infile.close();
-    outfile.close();
+    // but per Michaele Lawrence, a simple trick is to s/symbol/g/ which we do here,
+    // in one pass over the bytes, jumping from one '<' to the next
+    QByteArray out;
+    out.reserve(static_cast<int>(svg.size()));
+
+    const char *p = svg.data();
+    const char *end = p + svg.size();
+    while (p < end) {
+        const char *tag = static_cast<const char *>(std::memchr(p, '<', end - p));
+        if (!tag) {
+            out.append(p, static_cast<int>(end - p));
+            break;
+        }
+        out.append(p, static_cast<int>(tag - p));
+
+        if (end - tag >= 7 && std::memcmp(tag, "<symbol", 7) == 0) {
+            out.append("<g", 2);       // so '<symbol' becomes '<g ...'
+            p = tag + 7;
+        } else if (end - tag >= 8 && std::memcmp(tag, "</symbol", 8) == 0) {
+            out.append("</g", 3);      // and '</symbol becomes '</g'
+            p = tag + 8;
+        } else {
+            out.append('<');
+            p = tag + 1;
+        }
+    }
+
+    return out;
 }
@@ -10,7 +10,21 @@
 #ifndef SteamGameStats_H
 #define SteamGameStats_H
 
-#include <RInside.h>
+#include "RWorker.h"
+#include "SteamGameTable.h"
+#include "DatasetCache.h"
+#include "Correlation.h"
+#include "Bootstrap.h"
+#include "CorrelationMatrixView.h"
+#include "TrendsView.h"
+#include "GameHistoryView.h"
+#include "FilterPanel.h"
+#include "TopGamesPanel.h"
+#include "GroupByPanel.h"
+#include "GameFilter.h"
+#include "ScatterPlot.h"
+#include "DistributionView.h"
+#include "PerfTrace.h"
 
 #include <QtGui>
 #include <QWidget>
@@ -20,6 +34,7 @@
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QButtonGroup>
+#include <QCheckBox>
 #include <QMainWindow>
 #include <QComboBox>
 #include <QHBoxLayout>
@@ -29,82 +44,185 @@
 #include <QTemporaryFile>
 #include <QSvgWidget>
 #include <QPushButton>
+#include <QProgressBar>
+#include <QStackedWidget>
+#include <QTabWidget>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include <atomic>
+#include <future>
+#include <tuple>
+#include <vector>
+
+//Bootstrap intervals are computed on the thread pool and handed back to the window in queued calls
+Q_DECLARE_METATYPE(ConfidenceInterval)
+Q_DECLARE_METATYPE(OwnerIntervals)
 
 class SteamGameStats : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    SteamGameStats(RInside & R);
+    SteamGameStats(RWorker & R);
     ~SteamGameStats();
 
 private:
 
-    //Enum to store plot variable names
+    //Enum to store plot variable names, in the same order as the first columns of GameColumn
     enum plotVariable {
         Price,
         Userscore,
         Owners,
-        Playtime
+        Playtime,
+        Metascore,
+        OwnersError
     };
 
     void setupDisplay(void);                                // Set up the GUI components
-    void filterFile(void);                                  // modify the richer SVG produced by R
-
-    //Gets the correct data for the plot. Pass paramaters by reference to be able to use global variables
-    void getPlotData(std::string &_VariableStatement, std::string &_VariableName, plotVariable &_axis);
-
-    //Perform a correlation test on two variables (as R commands) from the graph.
-    //Also supply the names of those variables directly, which should be the same as in the one used in R
-    void correlationTest(std::string var1, std::string var2, std::string name1, std::string name2);
+    QString dataDirectory() const;                          // Directory containing the data files
+    static QString findDataDirectory();                     // From --data-dir, STEAMSTATS_DATA_DIR or the default locations
+    QStringList dataFiles() const;                          // Path of every data file, most recent year first
+    QString yearDataFile(const QString &year) const;        // Name of the data file of a year, or of its directory of exports
+    static bool watchRequested();                           // From --watch or STEAMSTATS_WATCH
+    void watchCurrentFile();                                // Watch m_file instead of the previous year, if watching
+    void preloadDataFiles(void);                            // Parse every data file in the background
+    static QByteArray filterSvg(const std::string &svg);    // modify the richer SVG produced by R
+
+    //Gets the correct data for the plot and the name of the variable used in R. Missing values are NaN
+    void getPlotData(std::vector<double> &_values, std::string &_VariableName, plotVariable &_axis);
+
+    //Keep one point per pixel of the ggplot plot, for geom_point
+    static void decimatePlotData(const std::vector<double> &x, const std::vector<double> &y,
+                                 std::vector<double> &xPoints, std::vector<double> &yPoints);
+
+    //Perform a correlation test on two variables from the graph, with the selected method.
+    //Each test is only computed the first time it is needed for a year
+    void correlationTest(plotVariable x_axis, plotVariable y_axis);
+
+    //Bootstrap interval of the correlation of two variables of the selected games, drawing the owners
+    //around their estimates with the '±' error as well. Null until it has been computed on the thread pool,
+    //correlationIntervalReady then displays the test again
+    const ConfidenceInterval *correlationInterval(plotVariable x_axis, plotVariable y_axis);
+
+    //Intervals of the owners of the selected games, in the same way
+    const OwnerIntervals *selectedOwnerIntervals();
+    void displayOwners();             // Show the total owners, with their interval if it is shown
+    void pruneIntervalTasks();        // Forget the interval tasks that are done
+
+    void updatePerfOverlay();         // Show the latest timings and counters, when tracing
+
+    void setFilter(const GameFilter &filter);   // Change m_filter, and its version if it is different
+    void updateSelection();           // Apply m_filter to the table of the year, and show the top selected games
+    void displayStats();              // Show the statistics of the selected games
 
     int getNumGames() const;          // Number of games
     double getAvgPrice() const;       // Average price of all games
     double getMaxPrice() const;       // Max price of all games
     double getAvgMetascore() const;   // Average Metascore
     double getTotalPlaytime() const;  // Total playtime of all games (in hours)
+    double getTotalOwners() const;    // Total owners of all games
     double getPValue() const;         // p-value from the correlation test
     double getCorrCoefficiant() const;// Correlation Coefficient from the correlation test
 
-    std::string getPrice();              //Gets the properly formatted price form the csv file
-    std::string getSelectElementsOfSet(std::string column, bool isFirst); //Gets the properly formatted first or second elements of
-                                                            //a set. If pass true, selects first elements (ex: [(2,1),(3,5)]->[2,3] )
-    std::string getNumberOfHoursPlayed();  //Get the total number of time played, in hours
-
     QSvgWidget *m_svg;          // the SVG device
-    RInside & m_R;              // reference to the R instance passed to constructor
-    QString m_tempfile;         // name of file used by R for plots
-    QString m_svgfile;          // another temp file, this time from Qt
+    ScatterPlotWidget *m_scatter;   // native plot, drawn without R
+    DistributionView *m_distribution;   // histogram and density of the x variable
+    QStackedWidget *plotStack;      // shows m_scatter, m_svg or m_distribution
+    RWorker & m_R;              // reference to the R thread passed to constructor
     int m_year;
+    QString m_dataDirectory;    // directory of the data files, ending with '/'
     QString m_file;             // location of file with Steam data
+    DatasetCache m_cache;       // recently used data files, their stats and plots
+    YearDataset m_dataset;      // parsed contents of m_file
+
+    //Games selected by the filter panel. m_selection is null when every game is selected
+    GameFilter m_filter;
+    FilterEngine m_filterEngine;
+    const RowSelection *m_selection;
+    unsigned m_filterVersion;           // 0 without a filter, otherwise different for every filter applied
+    unsigned m_lastFilterVersion;
 
     int m_numGames;
     double m_avgPrice;
     double m_maxPrice;
     double m_avgMetascore;
     double m_totalPlaytime;
+    double m_totalOwners;
     double m_p_value;
     double m_corrCoeff;
+    CorrelationCache m_correlations;    // correlation tests already computed
+    IntervalCache m_intervals;          // bootstrap intervals already computed
+
+    //Bootstrap intervals being computed. A task only starts if no other interval of its kind was asked for
+    //since, and the window waits for the tasks before it is destroyed
+    std::atomic<unsigned> m_correlationIntervalRequest, m_ownerIntervalRequest;
+    std::tuple<unsigned, int, unsigned, int, int, int> m_requestedCorrelationInterval;  // generation, year, filter, x, y, method
+    std::tuple<unsigned, int, unsigned> m_requestedOwnerIntervals;                      // generation, year, filter
+    std::vector<std::future<void> > m_intervalTasks;
+    YearTrends m_trends;                // summary of every year shown in the trends view
+    plotVariable m_plotX, m_plotY;      // variables of the current plot
+
+    //Plot being rendered by R, only the most recent request is displayed
+    int m_plotRequest;
+    std::string m_plotRequestFile;
+    plotVariable m_plotRequestX, m_plotRequestY;
+    PerfTrace::Clock::time_point m_plotRequestStart;
+    unsigned m_plotRequestFilter;       // only plots of every game are cached
 
     //Labels for each statistic
-    QLabel *numGamesLabel, *avgPriceLabel, *maxPriceLabel, *avgMetaScoreLabel, *totalPlaytimeLabel;
+    QLabel *numGamesLabel, *avgPriceLabel, *maxPriceLabel, *avgMetaScoreLabel, *totalPlaytimeLabel, *totalOwnersLabel;
     QLabel *corrCoefficientLabel, *p_valueLabel, *correlationTestMessageLabel, *correlationTestResultLabel;
 
     //Other UI components
-    QComboBox *yearCombo, *plotVarComboX, *plotVarComboY;
+    QComboBox *yearCombo, *plotVarComboX, *plotVarComboY, *correlationMethodCombo;
+    QComboBox *plotModeCombo;                    //Native plot, ggplot for export quality, or the distribution of x
+    QCheckBox *intervalCheck;                    //Show 95% confidence intervals of the owners and correlation
+    QCheckBox *watchCheck;                       //Follow the data file of the year as new rows are exported
+    QFileSystemWatcher *m_watcher;               //Watches m_file while watchCheck is checked
+    QTimer *m_watchTimer;                        //Waits for a burst of writes to end before reading them
     QGroupBox *estimationBox;
+    TopGamesPanel *topGamesPanel;                //Top games, percentiles and name search, beside the stats
+    GroupByPanel *groupByPanel;                  //Statistics by price tier or release date, in a tab beside them
     QPushButton *correlationButton, *plotButton; //Used to preform a correlation test and to plot
+    QPushButton *correlationMatrixButton;        //Used to test every pair of variables for every year
+    CorrelationMatrixView *m_matrixView;         //Window showing the correlation matrix
+    QPushButton *trendsButton;                   //Used to compare the statistics of every year
+    TrendsView *m_trendsView;                    //Window showing the statistics of every year
+    QPushButton *gamesButton;                    //Used to follow the games across the years
+    GameHistoryView *m_historyView;              //Window showing the games of every year, joined by name
+    QPushButton *filtersButton;                  //Used to select the games included
+    FilterPanel *m_filterPanel;                  //Window with the filters
+    QProgressBar *plotProgress;                  //Shown while R is rendering
+    QLabel *perfLabel;                           //Timings and counters, shown when tracing
 
 private slots:
 
     void setSteamYearDataFile(int year); //Sets the year to selected the correct data file
-    void readFile(QString file);         //Reads file into R
+    void readFile(QString file);         //Reads file into m_dataset, from the cache if possible
     void getStatsByYear();               //Get all statistics based on selected year
     void generateStatsAndPlot(int comboIndex);   //Generate the plot and statistics for the window based on the year selected
     void displayCorrelationTest(void);   //Display the results of the correlation test
+    void displayCorrelationMatrix(void); //Compute and display the correlation of every pair of variables
+    void displayTrends(void);            //Display the statistics of every year
+    void displayGameHistory(void);       //Join every year on the game names and display the games
+    void displayFilters(void);           //Display the filter panel
+    void applyFilter(void);              //Update the statistics, plot and correlation for the filter panel
+    void setIntervals(bool show);        //Show or hide the confidence intervals
+    void correlationIntervalReady(unsigned generation, int year, unsigned filterVersion, int x, int y, int method,
+                                  ConfidenceInterval interval);     //Keep an interval and show it if it is current
+    void ownerIntervalsReady(unsigned generation, int year, unsigned filterVersion, OwnerIntervals intervals);
+    void setWatching(bool watch);        //Start or stop watching the data file of the year
+    void dataFileChanged(QString path);  //Read the changes of the data file once writes have stopped
+    void updateWatchedFile(void);        //Add the new rows of the data file, or reload it if it was rewritten
 
     void plot(plotVariable x_axis, plotVariable y_axis);    // Run a plot of two selected variables, defined in plotVariable
     void plotWithSelectedVariables();       //Used to plot based on the values of both plot variable comboBoxes
+    void setPlotMode(int mode);             //Redraw the current plot natively or with ggplot
+
+    void plotRendered(int id, QString channel, QByteArray svg);    //Display a plot rendered by the R thread
+    void plotFailed(int id, QString channel, QString message);     //Report an error from the R thread
+    void setRBusy(bool busy);                                      //Show or hide the progress bar
 
 
 };
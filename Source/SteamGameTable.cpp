@@ -0,0 +1,510 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// In-memory table of typed columns parsed from a SteamSpy CSV file
+//
+// Author: Francois Stelluti
+//
+
+#include "SteamGameTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const char *gameColumnName(GameColumn column)
+{
+    switch (column)
+    {
+        case GameColumn::Price:
+            return "Price";
+        case GameColumn::Userscore:
+            return "Userscore";
+        case GameColumn::Owners:
+            return "Owners";
+        case GameColumn::Playtime:
+            return "Playtime";
+        case GameColumn::Metascore:
+            return "Metascore";
+        case GameColumn::OwnersError:
+            return "Owners error";
+        case GameColumn::MedianPlaytime:
+            return "Median playtime";
+    }
+
+    return "";
+}
+
+int32_t releaseDay(int year, int month, int day)
+{
+    //Days from civil, counting years from March so that the leap day is the last day of the year
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+void releaseDate(int32_t dayNumber, int &year, int &month, int &day)
+{
+    //Civil from days, the same eras and years starting in March as releaseDay
+    int32_t days = dayNumber + 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthFromMarch = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+    month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+SteamGameTable::SteamGameTable() : m_rows(0), m_names(std::make_shared<std::vector<char> >())
+{
+    m_nameOffsets.push_back(0);
+    updateColumns();
+}
+
+SteamGameTable::SteamGameTable(std::size_t rows, const SteamGameColumns &columns, std::shared_ptr<const void> storage) :
+    m_rows(rows), m_columns(columns), m_storage(storage), m_names(std::make_shared<std::vector<char> >())
+{
+}
+
+SteamGameTable::SteamGameTable(const SteamGameTable &other) :
+    m_rows(other.m_rows), m_columns(other.m_columns), m_storage(other.m_storage),
+    m_price(other.m_price), m_userscore(other.m_userscore), m_metascore(other.m_metascore),
+    m_userscoreMask(other.m_userscoreMask), m_metascoreMask(other.m_metascoreMask),
+    m_owners(other.m_owners), m_ownersError(other.m_ownersError),
+    m_playtime(other.m_playtime), m_medianPlaytime(other.m_medianPlaytime), m_releaseDate(other.m_releaseDate),
+    m_names(std::make_shared<std::vector<char> >(*other.m_names)), m_nameOffsets(other.m_nameOffsets)
+{
+    //A copy of a view shares its storage, a copy of an owning table points at its own vectors
+    if (!m_storage)
+        updateColumns();
+}
+
+SteamGameTable &SteamGameTable::operator=(const SteamGameTable &other)
+{
+    if (this != &other) {
+        SteamGameTable copy(other);
+        m_rows = copy.m_rows;
+        m_storage = copy.m_storage;
+        m_price.swap(copy.m_price);
+        m_userscore.swap(copy.m_userscore);
+        m_metascore.swap(copy.m_metascore);
+        m_userscoreMask.swap(copy.m_userscoreMask);
+        m_metascoreMask.swap(copy.m_metascoreMask);
+        m_owners.swap(copy.m_owners);
+        m_ownersError.swap(copy.m_ownersError);
+        m_playtime.swap(copy.m_playtime);
+        m_medianPlaytime.swap(copy.m_medianPlaytime);
+        m_releaseDate.swap(copy.m_releaseDate);
+        m_names.swap(copy.m_names);
+        m_nameOffsets.swap(copy.m_nameOffsets);
+
+        //Swapping vectors keeps their buffers, so pointers into them are still valid
+        m_columns = copy.m_columns;
+        if (!m_storage)
+            updateColumns();
+    }
+    return *this;
+}
+
+std::size_t SteamGameTable::size() const
+{
+    return m_rows;
+}
+
+void SteamGameTable::clear()
+{
+    //Nothing of a view needs to be kept
+    if (m_storage) {
+        m_storage.reset();
+        m_nameOffsets.assign(1, 0);
+    }
+
+    //std::vector::clear keeps its capacity, so reading a file of a similar size again doesn't allocate
+    unshareNames();
+    m_rows = 0;
+    m_price.clear();
+    m_userscore.clear();
+    m_metascore.clear();
+    m_userscoreMask.clear();
+    m_metascoreMask.clear();
+    m_owners.clear();
+    m_ownersError.clear();
+    m_playtime.clear();
+    m_medianPlaytime.clear();
+    m_releaseDate.clear();
+    m_names->clear();
+    m_nameOffsets.resize(1);
+    updateColumns();
+}
+
+void SteamGameTable::reserve(std::size_t rows, std::size_t nameBytes)
+{
+    detach();
+
+    std::size_t words = (rows + 63) / 64;
+
+    m_price.reserve(rows);
+    m_userscore.reserve(rows);
+    m_metascore.reserve(rows);
+    m_userscoreMask.reserve(words);
+    m_metascoreMask.reserve(words);
+    m_owners.reserve(rows);
+    m_ownersError.reserve(rows);
+    m_playtime.reserve(rows);
+    m_medianPlaytime.reserve(rows);
+    m_releaseDate.reserve(rows);
+    m_nameOffsets.reserve(rows + 1);
+    if (nameBytes > m_names->capacity()) {
+        unshareNames();
+        m_names->reserve(nameBytes);
+    }
+    updateColumns();
+}
+
+bool SteamGameTable::fitsInCapacity(std::size_t rows, std::size_t nameBytes) const
+{
+    if (m_storage || m_names.use_count() > 1)
+        return false;
+
+    std::size_t total = m_rows + rows, words = (total + 63) / 64;
+    return m_price.capacity() >= total && m_userscore.capacity() >= total && m_metascore.capacity() >= total
+        && m_userscoreMask.capacity() >= words && m_metascoreMask.capacity() >= words
+        && m_owners.capacity() >= total && m_ownersError.capacity() >= total
+        && m_playtime.capacity() >= total && m_medianPlaytime.capacity() >= total
+        && m_releaseDate.capacity() >= total && m_nameOffsets.capacity() >= total + 1
+        && m_names->capacity() >= m_names->size() + nameBytes;
+}
+
+void SteamGameTable::appendRow(const SteamGameRow &row)
+{
+    detach();
+
+    //Start a new word of each bitmap every 64 rows
+    if (m_rows % 64 == 0) {
+        m_userscoreMask.push_back(0);
+        m_metascoreMask.push_back(0);
+    }
+
+    uint64_t bit = uint64_t(1) << (m_rows % 64);
+    bool hasUserscore = !std::isnan(row.userscore);
+    bool hasMetascore = !std::isnan(row.metascore);
+
+    if (hasUserscore)
+        m_userscoreMask.back() |= bit;
+    if (hasMetascore)
+        m_metascoreMask.back() |= bit;
+
+    m_price.push_back(row.price);
+    m_userscore.push_back(hasUserscore ? static_cast<uint8_t>(row.userscore + 0.5f) : 0);
+    m_metascore.push_back(hasMetascore ? static_cast<uint8_t>(row.metascore + 0.5f) : 0);
+    m_owners.push_back(row.owners);
+    m_ownersError.push_back(row.ownersError);
+    m_playtime.push_back(row.playtime);
+    m_medianPlaytime.push_back(row.medianPlaytime);
+    m_releaseDate.push_back(row.releaseDate);
+
+    unshareNames();
+    m_names->insert(m_names->end(), row.name, row.name + row.nameLength);
+    m_nameOffsets.push_back(static_cast<uint32_t>(m_names->size()));
+
+    ++m_rows;
+    updateColumns();
+}
+
+void SteamGameTable::resize(std::size_t rows, std::size_t nameBytes)
+{
+    detach();
+
+    std::size_t words = (rows + 63) / 64;
+
+    m_price.resize(rows);
+    m_userscore.resize(rows);
+    m_metascore.resize(rows);
+    m_userscoreMask.resize(words, 0);
+    m_metascoreMask.resize(words, 0);
+    m_owners.resize(rows);
+    m_ownersError.resize(rows);
+    m_playtime.resize(rows);
+    m_medianPlaytime.resize(rows);
+    m_releaseDate.resize(rows);
+    unshareNames();
+    m_names->resize(nameBytes);
+    m_nameOffsets.resize(rows + 1);
+
+    m_rows = rows;
+    updateColumns();
+}
+
+void SteamGameTable::setRow(std::size_t row, std::size_t nameOffset, const SteamGameRow &values)
+{
+    uint64_t bit = uint64_t(1) << (row % 64);
+    bool hasUserscore = !std::isnan(values.userscore);
+    bool hasMetascore = !std::isnan(values.metascore);
+
+    if (hasUserscore)
+        m_userscoreMask[row / 64] |= bit;
+    else
+        m_userscoreMask[row / 64] &= ~bit;
+    if (hasMetascore)
+        m_metascoreMask[row / 64] |= bit;
+    else
+        m_metascoreMask[row / 64] &= ~bit;
+
+    m_price[row] = values.price;
+    m_userscore[row] = hasUserscore ? static_cast<uint8_t>(values.userscore + 0.5f) : 0;
+    m_metascore[row] = hasMetascore ? static_cast<uint8_t>(values.metascore + 0.5f) : 0;
+    m_owners[row] = values.owners;
+    m_ownersError[row] = values.ownersError;
+    m_playtime[row] = values.playtime;
+    m_medianPlaytime[row] = values.medianPlaytime;
+    m_releaseDate[row] = values.releaseDate;
+
+    //Only the end of the name is written, its start is the end of the name of the previous row
+    std::copy(values.name, values.name + values.nameLength, m_names->begin() + nameOffset);
+    m_nameOffsets[row + 1] = static_cast<uint32_t>(nameOffset + values.nameLength);
+}
+
+void SteamGameTable::detach()
+{
+    if (!m_storage)
+        return;
+
+    std::size_t words = (m_rows + 63) / 64;
+    const SteamGameColumns &c = m_columns;
+
+    m_price.assign(c.price, c.price + m_rows);
+    m_userscore.assign(c.userscore, c.userscore + m_rows);
+    m_metascore.assign(c.metascore, c.metascore + m_rows);
+    m_userscoreMask.assign(c.userscoreMask, c.userscoreMask + words);
+    m_metascoreMask.assign(c.metascoreMask, c.metascoreMask + words);
+    m_owners.assign(c.owners, c.owners + m_rows);
+    m_ownersError.assign(c.ownersError, c.ownersError + m_rows);
+    m_playtime.assign(c.playtime, c.playtime + m_rows);
+    m_medianPlaytime.assign(c.medianPlaytime, c.medianPlaytime + m_rows);
+    m_releaseDate.assign(c.releaseDate, c.releaseDate + m_rows);
+    m_names->assign(c.names, c.names + c.nameOffsets[m_rows]);
+    m_nameOffsets.assign(c.nameOffsets, c.nameOffsets + m_rows + 1);
+
+    m_storage.reset();
+    updateColumns();
+}
+
+void SteamGameTable::unshareNames()
+{
+    if (m_names.use_count() > 1) {
+        m_names = std::make_shared<std::vector<char> >(*m_names);
+        m_columns.names = m_names->data();
+    }
+}
+
+void SteamGameTable::updateColumns()
+{
+    m_columns.price = m_price.data();
+    m_columns.userscore = m_userscore.data();
+    m_columns.metascore = m_metascore.data();
+    m_columns.userscoreMask = m_userscoreMask.data();
+    m_columns.metascoreMask = m_metascoreMask.data();
+    m_columns.owners = m_owners.data();
+    m_columns.ownersError = m_ownersError.data();
+    m_columns.playtime = m_playtime.data();
+    m_columns.medianPlaytime = m_medianPlaytime.data();
+    m_columns.releaseDate = m_releaseDate.data();
+    m_columns.names = m_names->data();
+    m_columns.nameOffsets = m_nameOffsets.data();
+}
+
+bool SteamGameTable::isView() const
+{
+    return m_storage != 0;
+}
+
+std::shared_ptr<const std::vector<char> > SteamGameTable::sharedNames() const
+{
+    if (m_storage)
+        return std::shared_ptr<const std::vector<char> >();
+    return m_names;
+}
+
+const SteamGameColumns &SteamGameTable::columns() const
+{
+    return m_columns;
+}
+
+std::size_t SteamGameTable::nameBytes() const
+{
+    return m_columns.nameOffsets[m_rows];
+}
+
+std::size_t SteamGameTable::memoryUsage() const
+{
+    //A view uses exactly the size of its columns
+    if (m_storage) {
+        std::size_t words = (m_rows + 63) / 64;
+        return m_rows * (sizeof(float) + 2 * sizeof(uint8_t) + 4 * sizeof(uint32_t) + sizeof(int32_t))
+             + 2 * words * sizeof(uint64_t) + nameBytes() + (m_rows + 1) * sizeof(uint32_t);
+    }
+
+    return m_price.capacity() * sizeof(float)
+         + (m_userscore.capacity() + m_metascore.capacity()) * sizeof(uint8_t)
+         + (m_userscoreMask.capacity() + m_metascoreMask.capacity()) * sizeof(uint64_t)
+         + (m_owners.capacity() + m_ownersError.capacity()) * sizeof(uint32_t)
+         + (m_playtime.capacity() + m_medianPlaytime.capacity()) * sizeof(uint32_t)
+         + m_releaseDate.capacity() * sizeof(int32_t)
+         + m_names->capacity() + m_nameOffsets.capacity() * sizeof(uint32_t);
+}
+
+const float *SteamGameTable::prices() const
+{
+    return m_columns.price;
+}
+
+const uint8_t *SteamGameTable::userscores() const
+{
+    return m_columns.userscore;
+}
+
+const uint8_t *SteamGameTable::metascores() const
+{
+    return m_columns.metascore;
+}
+
+const uint32_t *SteamGameTable::owners() const
+{
+    return m_columns.owners;
+}
+
+const uint32_t *SteamGameTable::ownersErrors() const
+{
+    return m_columns.ownersError;
+}
+
+const uint32_t *SteamGameTable::playtimes() const
+{
+    return m_columns.playtime;
+}
+
+const uint32_t *SteamGameTable::medianPlaytimes() const
+{
+    return m_columns.medianPlaytime;
+}
+
+const int32_t *SteamGameTable::releaseDates() const
+{
+    return m_columns.releaseDate;
+}
+
+const uint64_t *SteamGameTable::userscoreMask() const
+{
+    return m_columns.userscoreMask;
+}
+
+const uint64_t *SteamGameTable::metascoreMask() const
+{
+    return m_columns.metascoreMask;
+}
+
+bool SteamGameTable::testBit(const uint64_t *mask, std::size_t row)
+{
+    return (mask[row / 64] >> (row % 64)) & 1;
+}
+
+bool SteamGameTable::hasUserscore(std::size_t row) const
+{
+    return testBit(m_columns.userscoreMask, row);
+}
+
+bool SteamGameTable::hasMetascore(std::size_t row) const
+{
+    return testBit(m_columns.metascoreMask, row);
+}
+
+std::string SteamGameTable::gameName(std::size_t row) const
+{
+    const char *names = m_columns.names;
+    return std::string(names + m_columns.nameOffsets[row], names + m_columns.nameOffsets[row + 1]);
+}
+
+SteamGameRow SteamGameTable::row(std::size_t row) const
+{
+    const SteamGameColumns &c = m_columns;
+
+    SteamGameRow values;
+    values.name = c.names + c.nameOffsets[row];
+    values.nameLength = c.nameOffsets[row + 1] - c.nameOffsets[row];
+    values.price = c.price[row];
+    values.userscore = hasUserscore(row) ? c.userscore[row] : std::numeric_limits<float>::quiet_NaN();
+    values.metascore = hasMetascore(row) ? c.metascore[row] : std::numeric_limits<float>::quiet_NaN();
+    values.owners = c.owners[row];
+    values.ownersError = c.ownersError[row];
+    values.playtime = c.playtime[row];
+    values.medianPlaytime = c.medianPlaytime[row];
+    values.releaseDate = c.releaseDate[row];
+    return values;
+}
+
+double SteamGameTable::value(GameColumn column, std::size_t row) const
+{
+    const SteamGameColumns &c = m_columns;
+
+    switch (column)
+    {
+        case GameColumn::Price:
+            return c.price[row];
+        case GameColumn::Userscore:
+            return hasUserscore(row) ? c.userscore[row] : std::numeric_limits<double>::quiet_NaN();
+        case GameColumn::Owners:
+            return c.owners[row];
+        case GameColumn::Playtime:
+            return c.playtime[row];
+        case GameColumn::Metascore:
+            return hasMetascore(row) ? c.metascore[row] : std::numeric_limits<double>::quiet_NaN();
+        case GameColumn::OwnersError:
+            return c.ownersError[row];
+        case GameColumn::MedianPlaytime:
+            return c.medianPlaytime[row];
+    }
+
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+void SteamGameTable::copyColumn(GameColumn column, double *out, double scale, double naValue) const
+{
+    //Loop over the typed column directly rather than calling value() for every row
+    const SteamGameColumns &c = m_columns;
+
+    switch (column)
+    {
+        case GameColumn::Price:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = std::isnan(c.price[i]) ? naValue : c.price[i] * scale;
+            break;
+        case GameColumn::Userscore:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = hasUserscore(i) ? c.userscore[i] * scale : naValue;
+            break;
+        case GameColumn::Owners:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = c.owners[i] * scale;
+            break;
+        case GameColumn::Playtime:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = c.playtime[i] * scale;
+            break;
+        case GameColumn::Metascore:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = hasMetascore(i) ? c.metascore[i] * scale : naValue;
+            break;
+        case GameColumn::OwnersError:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = c.ownersError[i] * scale;
+            break;
+        case GameColumn::MedianPlaytime:
+            for (std::size_t i = 0; i < m_rows; ++i)
+                out[i] = c.medianPlaytime[i] * scale;
+            break;
+    }
+}
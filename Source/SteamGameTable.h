@@ -0,0 +1,166 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// In-memory table of typed columns parsed from a SteamSpy CSV file
+//
+// Author: Francois Stelluti
+//
+
+#ifndef SteamGameTable_H
+#define SteamGameTable_H
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Numeric columns of the table, the first four in the same order as the plot variables
+enum class GameColumn {
+    Price,
+    Userscore,
+    Owners,
+    Playtime,
+    Metascore,
+    OwnersError,
+    MedianPlaytime
+};
+
+const char *gameColumnName(GameColumn column);     //Name of a column, as displayed
+
+//Release dates are stored as days since 1970-01-01, this one means the date couldn't be read
+const int32_t kUnknownReleaseDate = INT32_MIN;
+
+//Day number of a date of the proleptic Gregorian calendar, month and day starting at 1
+int32_t releaseDay(int year, int month, int day);
+
+//Date of a day number, the inverse of releaseDay
+void releaseDate(int32_t dayNumber, int &year, int &month, int &day);
+
+//One parsed row, as passed to SteamGameTable::appendRow. NaN scores mean 'N/A'
+struct SteamGameRow
+{
+    const char *name;
+    std::size_t nameLength;
+    float price;                //Price in dollars, 'Free' is 0
+    float userscore;            //Userscore in percent
+    float metascore;            //Metascore in percent
+    uint32_t owners;            //Estimated number of owners
+    uint32_t ownersError;       //Sampling error of the owner estimate (the '±' part)
+    uint32_t playtime;          //Average playtime, in minutes
+    uint32_t medianPlaytime;    //Median playtime, in minutes
+    int32_t releaseDate;        //Days since 1970-01-01, or kUnknownReleaseDate
+};
+
+//Pointers to the start of every column of a table
+struct SteamGameColumns
+{
+    const float *price;
+    const uint8_t *userscore;
+    const uint8_t *metascore;
+    const uint64_t *userscoreMask;
+    const uint64_t *metascoreMask;
+    const uint32_t *owners;
+    const uint32_t *ownersError;
+    const uint32_t *playtime;
+    const uint32_t *medianPlaytime;
+    const int32_t *releaseDate;
+    const char *names;
+    const uint32_t *nameOffsets;        //rows + 1 offsets into names
+};
+
+//Struct-of-arrays table: every column is stored contiguously with the smallest type that holds it.
+//Scores are percentages stored as bytes, with a bitmap recording which ones are available.
+//A table either owns its columns, or is a view of columns stored elsewhere (e.g. a mapped snapshot),
+//which is copied into the table the first time it is modified
+class SteamGameTable
+{
+public:
+    SteamGameTable();
+
+    //View of existing columns, kept valid for the lifetime of the table by holding on to storage
+    SteamGameTable(std::size_t rows, const SteamGameColumns &columns, std::shared_ptr<const void> storage);
+
+    SteamGameTable(const SteamGameTable &other);
+    SteamGameTable &operator=(const SteamGameTable &other);
+
+    std::size_t size() const;
+    void clear();                               //Remove all rows, keeping the allocated memory
+    void reserve(std::size_t rows, std::size_t nameBytes = 0);
+    void appendRow(const SteamGameRow &row);
+
+    //Whether rows more rows, with nameBytes bytes of names, can be appended without moving any column.
+    //Views of the rows already in the table then stay valid, except for the last word of the score bitmaps
+    bool fitsInCapacity(std::size_t rows, std::size_t nameBytes) const;
+
+    //Grow the table to rows rows and nameBytes bytes of names, the new rows being filled with setRow
+    void resize(std::size_t rows, std::size_t nameBytes);
+
+    //Write a row added by resize, with its name at nameOffset: the names must be back to back in the order
+    //of the rows. Rows can be set from several threads at once, as long as the 64 rows of a word of the
+    //score bitmaps (rows 64k to 64k+63) are all set by the same thread
+    void setRow(std::size_t row, std::size_t nameOffset, const SteamGameRow &values);
+    std::size_t memoryUsage() const;            //Number of bytes used by the columns
+
+    bool isView() const;
+    const SteamGameColumns &columns() const;
+
+    //Names of a table that owns its columns, so that NameDictionary can refer to them rather than copy them.
+    //Null for a view. Names that are shared are copied before the table is modified
+    std::shared_ptr<const std::vector<char> > sharedNames() const;
+    std::size_t nameBytes() const;              //Total length of the game names
+
+    const float *prices() const;
+    const uint8_t *userscores() const;
+    const uint8_t *metascores() const;
+    const uint32_t *owners() const;
+    const uint32_t *ownersErrors() const;
+    const uint32_t *playtimes() const;          //Average playtime, in minutes
+    const uint32_t *medianPlaytimes() const;    //Median playtime, in minutes
+    const int32_t *releaseDates() const;        //Days since 1970-01-01, or kUnknownReleaseDate
+
+    //Bitmaps of the available scores, bit (row % 64) of word (row / 64) is set if the score isn't N/A
+    const uint64_t *userscoreMask() const;
+    const uint64_t *metascoreMask() const;
+    bool hasUserscore(std::size_t row) const;
+    bool hasMetascore(std::size_t row) const;
+
+    std::string gameName(std::size_t row) const;
+
+    //Every value of a row, as it would be passed to appendRow. The name points into the table
+    SteamGameRow row(std::size_t row) const;
+
+    //Value of a numeric column as a double, NaN if it is N/A
+    double value(GameColumn column, std::size_t row) const;
+
+    //Write a whole numeric column to out (which must hold size() values), multiplied by scale.
+    //Missing values are written as naValue
+    void copyColumn(GameColumn column, double *out, double scale, double naValue) const;
+
+private:
+    static bool testBit(const uint64_t *mask, std::size_t row);
+
+    void detach();                  //Copy the columns of a view into the vectors
+    void unshareNames();            //Copy m_names if sharedNames() handed it out
+    void updateColumns();           //Point m_columns at the vectors
+
+    std::size_t m_rows;
+    SteamGameColumns m_columns;
+    std::shared_ptr<const void> m_storage;      //Memory of the columns of a view, null if the table owns them
+
+    std::vector<float> m_price;
+    std::vector<uint8_t> m_userscore;
+    std::vector<uint8_t> m_metascore;
+    std::vector<uint64_t> m_userscoreMask;
+    std::vector<uint64_t> m_metascoreMask;
+    std::vector<uint32_t> m_owners;
+    std::vector<uint32_t> m_ownersError;
+    std::vector<uint32_t> m_playtime;
+    std::vector<uint32_t> m_medianPlaytime;
+    std::vector<int32_t> m_releaseDate;
+
+    //Game names, stored back to back. Row i is [m_nameOffsets[i], m_nameOffsets[i+1])
+    std::shared_ptr<std::vector<char> > m_names;
+    std::vector<uint32_t> m_nameOffsets;
+};
+
+#endif
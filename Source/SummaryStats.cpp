@@ -0,0 +1,393 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Single pass summary statistics over every numeric column of a game table
+//
+// Author: Francois Stelluti
+//
+
+#include "SummaryStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+//The AVX2 kernel is compiled with a function target attribute and picked at run time,
+//so the application itself doesn't need to be built with -mavx2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STEAMSTATS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+//Running sums of one column. Values are shifted by the first value of the column so that
+//the sum of squares stays accurate, the variance is then sumSquares - sum^2 / count
+struct Accumulator {
+    double shift;
+    double sum;
+    double sumSquares;
+    double min;
+    double max;
+    std::size_t count;
+};
+
+inline void addValue(Accumulator &acc, double x)
+{
+    double d = x - acc.shift;
+    acc.sum += d;
+    acc.sumSquares += d * d;
+    if (x < acc.min)
+        acc.min = x;
+    if (x > acc.max)
+        acc.max = x;
+    ++acc.count;
+}
+
+void initAccumulators(const SteamGameTable &table, Accumulator acc[kNumGameColumns])
+{
+    for (int c = 0; c < kNumGameColumns; ++c) {
+        GameColumn column = static_cast<GameColumn>(c);
+
+        //Use the first value present as the shift
+        double shift = 0.0;
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            double x = table.value(column, i);
+            if (!std::isnan(x)) {
+                shift = x;
+                break;
+            }
+        }
+
+        acc[c].shift = shift;
+        acc[c].sum = 0.0;
+        acc[c].sumSquares = 0.0;
+        acc[c].min = kInfinity;
+        acc[c].max = -kInfinity;
+        acc[c].count = 0;
+    }
+}
+
+//Add one row of every column
+inline void addRow(const SteamGameTable &table, const SteamGameColumns &c, std::size_t i, Accumulator acc[kNumGameColumns])
+{
+    if (!std::isnan(c.price[i]))
+        addValue(acc[static_cast<int>(GameColumn::Price)], c.price[i]);
+    if (table.hasUserscore(i))
+        addValue(acc[static_cast<int>(GameColumn::Userscore)], c.userscore[i]);
+    if (table.hasMetascore(i))
+        addValue(acc[static_cast<int>(GameColumn::Metascore)], c.metascore[i]);
+    addValue(acc[static_cast<int>(GameColumn::Owners)], c.owners[i]);
+    addValue(acc[static_cast<int>(GameColumn::OwnersError)], c.ownersError[i]);
+    addValue(acc[static_cast<int>(GameColumn::Playtime)], c.playtime[i]);
+    addValue(acc[static_cast<int>(GameColumn::MedianPlaytime)], c.medianPlaytime[i]);
+}
+
+//Add the rows [begin, end) of every column, one row at a time
+void accumulateScalar(const SteamGameTable &table, std::size_t begin, std::size_t end, Accumulator acc[kNumGameColumns])
+{
+    const SteamGameColumns &columns = table.columns();
+    for (std::size_t i = begin; i < end; ++i)
+        addRow(table, columns, i, acc);
+}
+
+TableSummary finishSummary(const Accumulator acc[kNumGameColumns], std::size_t rows)
+{
+    TableSummary summary;
+    summary.rows = rows;
+
+    for (int c = 0; c < kNumGameColumns; ++c) {
+        ColumnSummary &column = summary.columns[c];
+        column.count = acc[c].count;
+        column.naCount = rows - acc[c].count;
+
+        if (column.count == 0) {
+            column.sum = 0.0;
+            column.min = column.max = column.m2 = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+
+        column.sum = acc[c].sum + acc[c].shift * column.count;
+        column.min = acc[c].min;
+        column.max = acc[c].max;
+        column.m2 = acc[c].sumSquares - acc[c].sum * acc[c].sum / column.count;
+        if (column.m2 < 0.0)
+            column.m2 = 0.0;    //Rounding error when all values are equal
+    }
+
+    return summary;
+}
+
+#ifdef STEAMSTATS_HAVE_AVX2
+
+//Four lanes of an Accumulator
+struct VectorAccumulator {
+    __m256d shift;
+    __m256d sum;
+    __m256d sumSquares;
+    __m256d min;
+    __m256d max;
+    std::size_t count;
+};
+
+__attribute__((target("avx2")))
+inline void addVector(VectorAccumulator &acc, __m256d x, __m256d valid)
+{
+    //Missing lanes add zero to the sums and are replaced by infinities for the min and max
+    __m256d d = _mm256_and_pd(_mm256_sub_pd(x, acc.shift), valid);
+    acc.sum = _mm256_add_pd(acc.sum, d);
+    acc.sumSquares = _mm256_add_pd(acc.sumSquares, _mm256_mul_pd(d, d));
+    acc.min = _mm256_min_pd(acc.min, _mm256_blendv_pd(_mm256_set1_pd(kInfinity), x, valid));
+    acc.max = _mm256_max_pd(acc.max, _mm256_blendv_pd(_mm256_set1_pd(-kInfinity), x, valid));
+    acc.count += __builtin_popcount(_mm256_movemask_pd(valid));
+}
+
+__attribute__((target("avx2")))
+inline void addAllValid(VectorAccumulator &acc, __m256d x)
+{
+    __m256d d = _mm256_sub_pd(x, acc.shift);
+    acc.sum = _mm256_add_pd(acc.sum, d);
+    acc.sumSquares = _mm256_add_pd(acc.sumSquares, _mm256_mul_pd(d, d));
+    acc.min = _mm256_min_pd(acc.min, x);
+    acc.max = _mm256_max_pd(acc.max, x);
+    acc.count += 4;
+}
+
+//Load 4 bytes as doubles
+__attribute__((target("avx2")))
+inline __m256d loadBytes(const uint8_t *p)
+{
+    int32_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(word)));
+}
+
+//Load 4 unsigned 32 bit integers as doubles. There is no unsigned conversion, so
+//values that come out negative get 2^32 added back
+__attribute__((target("avx2")))
+inline __m256d loadUnsigned(const uint32_t *p)
+{
+    __m256d x = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    __m256d negative = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_LT_OQ);
+    return _mm256_add_pd(x, _mm256_and_pd(negative, _mm256_set1_pd(4294967296.0)));
+}
+
+//Turn 4 bits of an N/A bitmap into a lane mask
+__attribute__((target("avx2")))
+inline __m256d maskFromBits(uint64_t bits)
+{
+    const __m256i laneBits = _mm256_set_epi64x(8, 4, 2, 1);
+    __m256i selected = _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(bits)), laneBits);
+    return _mm256_castsi256_pd(_mm256_cmpeq_epi64(selected, laneBits));
+}
+
+//Add the first rows of every column 4 rows at a time, and return the number of rows added
+__attribute__((target("avx2")))
+std::size_t accumulateAvx2(const SteamGameTable &table, Accumulator acc[kNumGameColumns])
+{
+    const float *prices = table.prices();
+    const uint8_t *userscores = table.userscores();
+    const uint8_t *metascores = table.metascores();
+    const uint64_t *userscoreMask = table.userscoreMask();
+    const uint64_t *metascoreMask = table.metascoreMask();
+    const uint32_t *owners = table.owners();
+    const uint32_t *ownersErrors = table.ownersErrors();
+    const uint32_t *playtimes = table.playtimes();
+    const uint32_t *medianPlaytimes = table.medianPlaytimes();
+
+    VectorAccumulator vacc[kNumGameColumns];
+    for (int c = 0; c < kNumGameColumns; ++c) {
+        vacc[c].shift = _mm256_set1_pd(acc[c].shift);
+        vacc[c].sum = _mm256_setzero_pd();
+        vacc[c].sumSquares = _mm256_setzero_pd();
+        vacc[c].min = _mm256_set1_pd(kInfinity);
+        vacc[c].max = _mm256_set1_pd(-kInfinity);
+        vacc[c].count = 0;
+    }
+
+    std::size_t rows = table.size() & ~std::size_t(3);
+    for (std::size_t i = 0; i < rows; i += 4) {
+        __m256d price = _mm256_cvtps_pd(_mm_loadu_ps(prices + i));
+        addVector(vacc[static_cast<int>(GameColumn::Price)], price, _mm256_cmp_pd(price, price, _CMP_ORD_Q));
+
+        //i is a multiple of 4, so the 4 bits never straddle two words of the bitmap
+        uint64_t userscoreBits = (userscoreMask[i / 64] >> (i % 64)) & 0xF;
+        uint64_t metascoreBits = (metascoreMask[i / 64] >> (i % 64)) & 0xF;
+        addVector(vacc[static_cast<int>(GameColumn::Userscore)], loadBytes(userscores + i), maskFromBits(userscoreBits));
+        addVector(vacc[static_cast<int>(GameColumn::Metascore)], loadBytes(metascores + i), maskFromBits(metascoreBits));
+
+        addAllValid(vacc[static_cast<int>(GameColumn::Owners)], loadUnsigned(owners + i));
+        addAllValid(vacc[static_cast<int>(GameColumn::OwnersError)], loadUnsigned(ownersErrors + i));
+        addAllValid(vacc[static_cast<int>(GameColumn::Playtime)], loadUnsigned(playtimes + i));
+        addAllValid(vacc[static_cast<int>(GameColumn::MedianPlaytime)], loadUnsigned(medianPlaytimes + i));
+    }
+
+    //Combine the lanes
+    for (int c = 0; c < kNumGameColumns; ++c) {
+        double sum[4], sumSquares[4], min[4], max[4];
+        _mm256_storeu_pd(sum, vacc[c].sum);
+        _mm256_storeu_pd(sumSquares, vacc[c].sumSquares);
+        _mm256_storeu_pd(min, vacc[c].min);
+        _mm256_storeu_pd(max, vacc[c].max);
+
+        for (int lane = 0; lane < 4; ++lane) {
+            acc[c].sum += sum[lane];
+            acc[c].sumSquares += sumSquares[lane];
+            if (min[lane] < acc[c].min)
+                acc[c].min = min[lane];
+            if (max[lane] > acc[c].max)
+                acc[c].max = max[lane];
+        }
+        acc[c].count += vacc[c].count;
+    }
+
+    return rows;
+}
+
+bool cpuHasAvx2()
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+}
+
+#endif
+
+} // namespace
+
+double roundTo(double value, int digits)
+{
+    if (!std::isfinite(value) || value == 0.0)
+        return value;
+    if (value < 0.0)
+        return -roundTo(-value, digits);
+
+    //nearbyint rounds halves to even in the default rounding mode, as R's rint does
+    if (digits == 0)
+        return std::nearbyint(value);
+
+    //Already exact to that many digits (R's estimate of log10, from the binary exponent)
+    if (0.3010299956639812 * (0.5 + std::logb(value)) + digits > std::numeric_limits<double>::digits10)
+        return value;
+
+    //As R does since 4.0.0: of the two values with the given number of decimals around it, the one nearer to
+    //the value as stored, and on a tie the one with an even last digit. So 0.15, stored a little under,
+    //becomes 0.1, while 0.125 becomes 0.12
+    double scale = std::pow(10.0, digits);
+    double scaled = value * scale;
+    double down = std::floor(scaled);
+    double lower = down / scale, upper = std::ceil(scaled) / scale;
+    double toUpper = upper - value, toLower = value - lower;
+    return toUpper < toLower || (toUpper == toLower && std::fmod(down, 2.0) == 1.0) ? upper : lower;
+}
+
+double ColumnSummary::mean() const
+{
+    return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN();
+}
+
+double ColumnSummary::variance() const
+{
+    return count > 1 ? m2 / (count - 1) : std::numeric_limits<double>::quiet_NaN();
+}
+
+void ColumnSummary::merge(const ColumnSummary &other)
+{
+    naCount += other.naCount;
+    if (other.count == 0)
+        return;
+
+    if (count == 0) {
+        count = other.count;
+        sum = other.sum;
+        min = other.min;
+        max = other.max;
+        m2 = other.m2;
+        return;
+    }
+
+    //Chan et al.: the squared deviations of both sets, plus a term for the difference of their means
+    double delta = other.mean() - mean();
+    double total = static_cast<double>(count + other.count);
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+}
+
+const ColumnSummary &TableSummary::operator[](GameColumn column) const
+{
+    return columns[static_cast<int>(column)];
+}
+
+void TableSummary::merge(const TableSummary &other)
+{
+    rows += other.rows;
+    for (int c = 0; c < kNumGameColumns; ++c)
+        columns[c].merge(other.columns[c]);
+}
+
+TableSummary emptySummary()
+{
+    TableSummary summary;
+    summary.rows = 0;
+
+    for (int c = 0; c < kNumGameColumns; ++c) {
+        ColumnSummary &column = summary.columns[c];
+        column.count = 0;
+        column.naCount = 0;
+        column.sum = 0.0;
+        column.min = column.max = column.m2 = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return summary;
+}
+
+TableSummary summarizeTable(const SteamGameTable &table)
+{
+#ifdef STEAMSTATS_HAVE_AVX2
+    if (cpuHasAvx2()) {
+        Accumulator acc[kNumGameColumns];
+        initAccumulators(table, acc);
+
+        //Vector loop for most of the table, then the scalar loop for the last few rows
+        std::size_t done = accumulateAvx2(table, acc);
+        accumulateScalar(table, done, table.size(), acc);
+        return finishSummary(acc, table.size());
+    }
+#endif
+
+    return summarizeTableScalar(table);
+}
+
+TableSummary summarizeSelection(const SteamGameTable &table, const RowSelection &selection)
+{
+    Accumulator acc[kNumGameColumns];
+    initAccumulators(table, acc);
+
+    //Only visit the set bits, a narrow filter costs little more than the number of rows it selects
+    const SteamGameColumns &columns = table.columns();
+    const uint64_t *words = selection.words();
+    std::size_t numWords = (selection.rows() + 63) / 64;
+    for (std::size_t w = 0; w < numWords; ++w) {
+        if (words[w] == ~uint64_t(0)) {
+            accumulateScalar(table, w * 64, w * 64 + 64, acc);
+            continue;
+        }
+        for (std::size_t j = 0; j < 64; ++j)
+            if ((words[w] >> j) & 1)
+                addRow(table, columns, w * 64 + j, acc);
+    }
+
+    return finishSummary(acc, selection.count());
+}
+
+TableSummary summarizeTableScalar(const SteamGameTable &table)
+{
+    Accumulator acc[kNumGameColumns];
+    initAccumulators(table, acc);
+    accumulateScalar(table, 0, table.size(), acc);
+    return finishSummary(acc, table.size());
+}
@@ -0,0 +1,63 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Single pass summary statistics over every numeric column of a game table
+//
+// Author: Francois Stelluti
+//
+
+#ifndef SummaryStats_H
+#define SummaryStats_H
+
+#include "GameFilter.h"
+#include "SteamGameTable.h"
+
+#include <cstddef>
+
+const int kNumGameColumns = 7;     //Number of values in GameColumn
+
+//Statistics of one column, ignoring missing values
+struct ColumnSummary
+{
+    std::size_t count;      //Number of values present
+    std::size_t naCount;    //Number of missing values
+    double sum;
+    double min;
+    double max;
+    double m2;              //Sum of squared deviations from the mean
+
+    double mean() const;
+    double variance() const;    //Sample variance, the same as R's var()
+
+    //Combine with the summary of other values, giving the summary of both sets of values
+    void merge(const ColumnSummary &other);
+};
+
+struct TableSummary
+{
+    std::size_t rows;
+    ColumnSummary columns[kNumGameColumns];
+
+    const ColumnSummary &operator[](GameColumn column) const;
+
+    //Summary of the rows of both tables, without going through either of them again
+    void merge(const TableSummary &other);
+};
+
+//Summary of a table with no rows, which merging leaves unchanged
+TableSummary emptySummary();
+
+//Round to the given number of decimal places, the same as R's round(): to the nearer of the two candidates,
+//and halves to even
+double roundTo(double value, int digits);
+
+//Compute the summary of every column in one pass over the table.
+//Uses AVX2 when the processor supports it, and a scalar loop otherwise
+TableSummary summarizeTable(const SteamGameTable &table);
+
+//Summary of the rows of a selection of the table
+TableSummary summarizeSelection(const SteamGameTable &table, const RowSelection &selection);
+
+//Same as summarizeTable, but always uses the scalar loop
+TableSummary summarizeTableScalar(const SteamGameTable &table);
+
+#endif
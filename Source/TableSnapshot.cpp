@@ -0,0 +1,331 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Versioned binary snapshot of a parsed table, memory-mapped instead of re-parsing the CSV
+//
+// Author: Francois Stelluti
+//
+
+#include "TableSnapshot.h"
+#include "SteamCsvParser.h"
+#include "CatalogueLoader.h"
+#include "ThreadPool.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QString>
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+const char kSnapshotMagic[8] = {'S', 'T', 'E', 'A', 'M', 'S', 'N', 'P'};
+const uint32_t kByteOrderMark = 0x01020304;     //Reads differently on a machine of the other endianness
+const uint64_t kAlignment = 64;
+
+//Columns in the order they are stored
+enum Section {
+    PriceSection,
+    UserscoreSection,
+    MetascoreSection,
+    UserscoreMaskSection,
+    MetascoreMaskSection,
+    OwnersSection,
+    OwnersErrorSection,
+    PlaytimeSection,
+    MedianPlaytimeSection,
+    ReleaseDateSection,
+    NameOffsetsSection,
+    NamesSection,
+    kNumSections
+};
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint32_t headerSize;
+    uint32_t reserved;
+    uint64_t rows;
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint64_t fileSize;
+    uint64_t checksum;                  //Of everything after the header
+    uint64_t offsets[kNumSections];     //From the start of the file, multiples of kAlignment
+    uint64_t sizes[kNumSections];       //In bytes
+};
+
+uint64_t alignUp(uint64_t offset)
+{
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+//FNV-1a over 64-bit words rather than bytes, so that checking a mapped snapshot stays cheap
+class SnapshotChecksum
+{
+public:
+    SnapshotChecksum() : m_hash(14695981039346656037ULL), m_pendingBytes(0) {}
+
+    void add(const char *data, std::size_t n)
+    {
+        while (n > 0 && m_pendingBytes > 0) {
+            addPending(*data++);
+            --n;
+        }
+        for (; n >= 8; data += 8, n -= 8) {
+            uint64_t word;
+            std::memcpy(&word, data, 8);
+            mix(word);
+        }
+        while (n > 0) {
+            addPending(*data++);
+            --n;
+        }
+    }
+
+    uint64_t value() const
+    {
+        return m_hash;
+    }
+
+private:
+    void mix(uint64_t word)
+    {
+        m_hash = (m_hash ^ word) * 1099511628211ULL;
+    }
+
+    void addPending(char byte)
+    {
+        m_pending[m_pendingBytes++] = byte;
+        if (m_pendingBytes == 8) {
+            uint64_t word;
+            std::memcpy(&word, m_pending, 8);
+            mix(word);
+            m_pendingBytes = 0;
+        }
+    }
+
+    uint64_t m_hash;
+    char m_pending[8];
+    int m_pendingBytes;
+};
+
+} // namespace
+
+bool snapshotSource(const std::string &csvPath, SnapshotSource &source)
+{
+    QFileInfo info(QString::fromStdString(csvPath));
+    if (!info.exists())
+        return false;
+
+    source.size = static_cast<uint64_t>(info.size());
+    source.modified = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+std::string snapshotPath(const std::string &csvPath)
+{
+    const std::string extension = ".csv";
+    if (csvPath.size() >= extension.size() &&
+        csvPath.compare(csvPath.size() - extension.size(), extension.size(), extension) == 0)
+        return csvPath.substr(0, csvPath.size() - extension.size()) + ".snapshot";
+
+    return csvPath + ".snapshot";
+}
+
+void writeSnapshot(const std::string &path, const SteamGameTable &table, const SnapshotSource &source)
+{
+    const SteamGameColumns &columns = table.columns();
+    uint64_t rows = table.size();
+    uint64_t words = (rows + 63) / 64;
+
+    const char *data[kNumSections] = {
+        reinterpret_cast<const char *>(columns.price),
+        reinterpret_cast<const char *>(columns.userscore),
+        reinterpret_cast<const char *>(columns.metascore),
+        reinterpret_cast<const char *>(columns.userscoreMask),
+        reinterpret_cast<const char *>(columns.metascoreMask),
+        reinterpret_cast<const char *>(columns.owners),
+        reinterpret_cast<const char *>(columns.ownersError),
+        reinterpret_cast<const char *>(columns.playtime),
+        reinterpret_cast<const char *>(columns.medianPlaytime),
+        reinterpret_cast<const char *>(columns.releaseDate),
+        reinterpret_cast<const char *>(columns.nameOffsets),
+        columns.names
+    };
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.rows = rows;
+    header.sourceSize = source.size;
+    header.sourceModified = source.modified;
+    header.sizes[PriceSection] = rows * sizeof(float);
+    header.sizes[UserscoreSection] = rows * sizeof(uint8_t);
+    header.sizes[MetascoreSection] = rows * sizeof(uint8_t);
+    header.sizes[UserscoreMaskSection] = words * sizeof(uint64_t);
+    header.sizes[MetascoreMaskSection] = words * sizeof(uint64_t);
+    header.sizes[OwnersSection] = rows * sizeof(uint32_t);
+    header.sizes[OwnersErrorSection] = rows * sizeof(uint32_t);
+    header.sizes[PlaytimeSection] = rows * sizeof(uint32_t);
+    header.sizes[MedianPlaytimeSection] = rows * sizeof(uint32_t);
+    header.sizes[ReleaseDateSection] = rows * sizeof(int32_t);
+    header.sizes[NameOffsetsSection] = (rows + 1) * sizeof(uint32_t);
+    header.sizes[NamesSection] = table.nameBytes();
+
+    uint64_t offset = alignUp(sizeof(SnapshotHeader));
+    for (int i = 0; i < kNumSections; ++i) {
+        header.offsets[i] = offset;
+        offset = alignUp(offset + header.sizes[i]);
+    }
+    header.fileSize = offset;
+
+    //Write to a temporary file that replaces the snapshot on commit, so a reader never maps half a file
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly))
+        throw std::runtime_error("Unable to write " + path);
+
+    const char zeros[kAlignment] = {};
+    SnapshotChecksum checksum;
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+    uint64_t position = sizeof(header);
+
+    for (int i = 0; i < kNumSections && ok; ++i) {
+        uint64_t padding = header.offsets[i] - position;
+        ok = file.write(zeros, padding) == static_cast<qint64>(padding)
+          && file.write(data[i], header.sizes[i]) == static_cast<qint64>(header.sizes[i]);
+        if (i > 0)
+            checksum.add(zeros, padding);      //The checksum starts at the first section
+        checksum.add(data[i], header.sizes[i]);
+        position = header.offsets[i] + header.sizes[i];
+    }
+
+    uint64_t padding = header.fileSize - position;
+    ok = ok && file.write(zeros, padding) == static_cast<qint64>(padding);
+    checksum.add(zeros, padding);
+
+    //Now that the checksum is known, rewrite the header
+    header.checksum = checksum.value();
+    ok = ok && file.seek(0) && file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+
+    if (!ok || !file.commit())
+        throw std::runtime_error("Unable to write " + path);
+}
+
+std::shared_ptr<const SteamGameTable> mapSnapshot(const std::string &path, const SnapshotSource *source)
+{
+    std::shared_ptr<const SteamGameTable> none;
+
+    //The mapping lasts as long as the QFile, which is kept alive by the table
+    std::shared_ptr<QFile> file = std::make_shared<QFile>(QString::fromStdString(path));
+    if (!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(sizeof(SnapshotHeader)))
+        return none;
+
+    uint64_t fileSize = static_cast<uint64_t>(file->size());
+    const char *data = reinterpret_cast<const char *>(file->map(0, file->size()));
+    if (!data)
+        return none;
+
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 || header.version != kSnapshotVersion ||
+        header.byteOrderMark != kByteOrderMark || header.headerSize != sizeof(SnapshotHeader) ||
+        header.fileSize != fileSize)
+        return none;
+
+    if (source && (header.sourceSize != source->size || header.sourceModified != source->modified))
+        return none;
+
+    //Every section must be aligned, inside the file, and of the size its column needs
+    uint64_t rows = header.rows;
+    uint64_t words = (rows + 63) / 64;
+    uint64_t expected[kNumSections] = {
+        rows * sizeof(float), rows, rows, words * sizeof(uint64_t), words * sizeof(uint64_t),
+        rows * sizeof(uint32_t), rows * sizeof(uint32_t), rows * sizeof(uint32_t), rows * sizeof(uint32_t),
+        rows * sizeof(int32_t), (rows + 1) * sizeof(uint32_t), header.sizes[NamesSection]
+    };
+    for (int i = 0; i < kNumSections; ++i) {
+        if (header.sizes[i] != expected[i] || header.offsets[i] % kAlignment != 0 ||
+            header.offsets[i] > fileSize || header.sizes[i] > fileSize - header.offsets[i])
+            return none;
+    }
+
+    uint64_t payload = alignUp(sizeof(SnapshotHeader));
+    SnapshotChecksum checksum;
+    checksum.add(data + payload, fileSize - payload);
+    if (checksum.value() != header.checksum)
+        return none;
+
+    SteamGameColumns columns;
+    columns.price = reinterpret_cast<const float *>(data + header.offsets[PriceSection]);
+    columns.userscore = reinterpret_cast<const uint8_t *>(data + header.offsets[UserscoreSection]);
+    columns.metascore = reinterpret_cast<const uint8_t *>(data + header.offsets[MetascoreSection]);
+    columns.userscoreMask = reinterpret_cast<const uint64_t *>(data + header.offsets[UserscoreMaskSection]);
+    columns.metascoreMask = reinterpret_cast<const uint64_t *>(data + header.offsets[MetascoreMaskSection]);
+    columns.owners = reinterpret_cast<const uint32_t *>(data + header.offsets[OwnersSection]);
+    columns.ownersError = reinterpret_cast<const uint32_t *>(data + header.offsets[OwnersErrorSection]);
+    columns.playtime = reinterpret_cast<const uint32_t *>(data + header.offsets[PlaytimeSection]);
+    columns.medianPlaytime = reinterpret_cast<const uint32_t *>(data + header.offsets[MedianPlaytimeSection]);
+    columns.releaseDate = reinterpret_cast<const int32_t *>(data + header.offsets[ReleaseDateSection]);
+    columns.nameOffsets = reinterpret_cast<const uint32_t *>(data + header.offsets[NameOffsetsSection]);
+    columns.names = data + header.offsets[NamesSection];
+
+    if (columns.nameOffsets[0] != 0 || columns.nameOffsets[rows] != header.sizes[NamesSection])
+        return none;
+
+    return std::make_shared<SteamGameTable>(static_cast<std::size_t>(rows), columns, file);
+}
+
+std::shared_ptr<const SteamGameTable> loadTable(const std::string &csvPath, SnapshotSource *readSource)
+{
+    if (readSource)
+        readSource->size = readSource->modified = 0;
+
+    //Exports split across files are parsed and merged in parallel each time, there is no single CSV to stamp
+    if (isCataloguePath(csvPath)) {
+        std::vector<std::string> files = catalogueFiles(csvPath);
+        if (files.empty())
+            throw std::runtime_error("No data files in " + csvPath);
+        return loadCatalogue(files, ThreadPool::global());
+    }
+
+    SnapshotSource source;
+    bool hasCsv = snapshotSource(csvPath, source);
+    std::string snapshot = snapshotPath(csvPath);
+
+    std::shared_ptr<const SteamGameTable> mapped = mapSnapshot(snapshot, hasCsv ? &source : 0);
+    if (mapped) {
+        if (readSource && hasCsv)
+            *readSource = source;
+        return mapped;
+    }
+
+    //Missing or stale snapshot: parse the CSV, and write the snapshot for next time
+    std::shared_ptr<SteamGameTable> table = std::make_shared<SteamGameTable>();
+    SteamCsvParser parser;
+    parser.parseFile(csvPath, *table);
+
+    //The CSV may have been written to while it was parsed, then what was read isn't known
+    SnapshotSource parsed;
+    if (readSource && hasCsv && snapshotSource(csvPath, parsed) && parsed.size == source.size &&
+        parsed.modified == source.modified)
+        *readSource = source;
+
+    try {
+        writeSnapshot(snapshot, *table, source);
+    }
+    catch (std::exception &e) {
+        std::cout << e.what() << ", the CSV will be parsed again next time" << std::endl;
+    }
+
+    return table;
+}
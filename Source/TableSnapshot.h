@@ -0,0 +1,49 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Versioned binary snapshot of a parsed table, memory-mapped instead of re-parsing the CSV
+//
+// Author: Francois Stelluti
+//
+
+#ifndef TableSnapshot_H
+#define TableSnapshot_H
+
+#include "SteamGameTable.h"
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+//Bumped whenever the layout of a snapshot changes, older snapshots are then ignored and rewritten
+const uint32_t kSnapshotVersion = 2;
+
+//Size and modification time of the CSV a snapshot was written from, used to detect stale snapshots
+struct SnapshotSource
+{
+    uint64_t size;
+    int64_t modified;           //Milliseconds since the epoch
+};
+
+//Stamp of a CSV file, or false if it doesn't exist
+bool snapshotSource(const std::string &csvPath, SnapshotSource &source);
+
+//Snapshot of a CSV file, stored next to it: Data/2015_SteamStats.csv has Data/2015_SteamStats.snapshot
+std::string snapshotPath(const std::string &csvPath);
+
+//Write the columns of a table, 64-byte aligned, after a header holding the version, the source stamp,
+//the offset of every column and a checksum. The file is replaced atomically. Throws std::runtime_error
+void writeSnapshot(const std::string &path, const SteamGameTable &table, const SnapshotSource &source);
+
+//Map a snapshot and return a table viewing its columns, without copying or converting anything.
+//Returns null if the file is missing, of another version, fails its checksum, or (if source isn't null)
+//was written from a different version of the CSV
+std::shared_ptr<const SteamGameTable> mapSnapshot(const std::string &path, const SnapshotSource *source);
+
+//Table of a CSV file: mapped from its snapshot if it is up to date, otherwise parsed from the CSV
+//and written to a new snapshot. A snapshot without its CSV is used as is. A directory or a wildcard
+//pattern is loaded as a catalogue of exports (see loadCatalogue), without a snapshot.
+//If readSource isn't null, it is set to the stamp of the CSV the table holds, or to zeros if that isn't known.
+//Throws std::runtime_error if nothing can be read
+std::shared_ptr<const SteamGameTable> loadTable(const std::string &csvPath, SnapshotSource *readSource = 0);
+
+#endif
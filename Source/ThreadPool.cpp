@@ -0,0 +1,130 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Fixed size pool of worker threads for parallel computations
+//
+// Author: Francois Stelluti
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(std::size_t numThreads) : m_stopping(false)
+{
+    for (std::size_t i = 0; i < numThreads; ++i)
+        m_workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        m_workers[i].join();
+}
+
+std::size_t ThreadPool::size() const
+{
+    return m_workers.size();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &body)
+{
+    if (count == 0)
+        return;
+
+    //Shared by the caller and the helper tasks, which may still be queued after the loop is done
+    struct Loop {
+        std::function<void(std::size_t)> body;
+        std::size_t count;
+        std::atomic<std::size_t> next;
+        std::atomic<std::size_t> done;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+
+    std::shared_ptr<Loop> loop = std::make_shared<Loop>();
+    loop->body = body;
+    loop->count = count;
+    loop->next = 0;
+    loop->done = 0;
+
+    std::function<void()> run = [loop]() {
+        std::size_t i;
+        while ((i = loop->next++) < loop->count) {
+            try {
+                loop->body(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                if (!loop->error)
+                    loop->error = std::current_exception();
+            }
+
+            if (++loop->done == loop->count) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    //The calling thread takes part too, so a parallelFor inside a task can't deadlock the pool
+    std::size_t helpers = std::min(m_workers.size(), count - 1);
+    for (std::size_t i = 0; i < helpers; ++i)
+        enqueue(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    while (loop->done < loop->count)
+        loop->finished.wait(lock);
+
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
+
+ThreadPool &ThreadPool::global()
+{
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    //Without workers, tasks run on the thread that submits them
+    if (m_workers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(task);
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stopping && m_tasks.empty())
+                m_taskAvailable.wait(lock);
+
+            //Finish the queued tasks before stopping
+            if (m_tasks.empty())
+                return;
+
+            task = m_tasks.front();
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
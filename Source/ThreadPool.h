@@ -0,0 +1,58 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Fixed size pool of worker threads for parallel computations
+//
+// Author: Francois Stelluti
+//
+
+#ifndef ThreadPool_H
+#define ThreadPool_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t numThreads);     //0 runs everything on the calling thread
+    ~ThreadPool();                  //Waits for the queued tasks to finish
+
+    std::size_t size() const;       //Number of worker threads
+
+    //Queue a task and get a future for its result
+    template <typename Function>
+    std::future<typename std::result_of<Function()>::type> submit(Function function)
+    {
+        typedef typename std::result_of<Function()>::type Result;
+        std::shared_ptr<std::packaged_task<Result()> > task = std::make_shared<std::packaged_task<Result()> >(function);
+        std::future<Result> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    //Run body(i) for every i in [0, count) on the pool and the calling thread, and wait for all of them.
+    //The first exception thrown by body is rethrown here
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)> &body);
+
+    //Pool shared by the whole application, with one thread per core
+    static ThreadPool &global();
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()> > m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    bool m_stopping;
+};
+
+#endif
@@ -0,0 +1,151 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Table of the top games of the selected year by any column, their percentiles, and a name search
+//
+// Author: Francois Stelluti
+//
+
+#include "TopGamesPanel.h"
+#include "PerfTrace.h"
+#include "SummaryStats.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+#include <cmath>
+
+namespace {
+
+//Percentiles shown below the controls
+const double kPercentiles[] = {0.1, 0.25, 0.5, 0.75, 0.9};
+const char *kPercentileNames[] = {"10%", "25%", "Median", "75%", "90%"};
+
+} // namespace
+
+TopGamesPanel::TopGamesPanel(QWidget *parent) : QGroupBox("Top Games", parent), m_selection(0)
+{
+    columnCombo = new QComboBox();
+    orderCombo = new QComboBox();
+    countSpin = new QSpinBox();
+    searchEdit = new QLineEdit();
+    percentileLabel = new QLabel();
+    gamesTable = new QTableWidget(0, 3);
+
+    //Every numeric column, in the same order as GameColumn
+    for (int c = 0; c < kNumGameColumns; ++c)
+        columnCombo->addItem(gameColumnName(static_cast<GameColumn>(c)));
+    columnCombo->setCurrentIndex(static_cast<int>(GameColumn::Owners));
+
+    orderCombo->addItem("Highest");
+    orderCombo->addItem("Lowest");
+
+    countSpin->setRange(1, 1000);
+    countSpin->setValue(50);
+
+    searchEdit->setPlaceholderText("Find a game by name");
+    searchEdit->setClearButtonEnabled(true);
+
+    percentileLabel->setWordWrap(true);
+
+    //Read only table of the games, with the rank, the name and the value of the column
+    gamesTable->setHorizontalHeaderLabels(QStringList() << "#" << "Game" << "Value");
+    gamesTable->verticalHeader()->hide();
+    gamesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    gamesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    gamesTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    gamesTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    gamesTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+
+    QHBoxLayout *queryLayout = new QHBoxLayout();
+    queryLayout->addWidget(orderCombo);
+    queryLayout->addWidget(countSpin);
+    queryLayout->addWidget(columnCombo);
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addLayout(queryLayout);
+    layout->addWidget(searchEdit);
+    layout->addWidget(percentileLabel);
+    layout->addWidget(gamesTable);
+    setLayout(layout);
+    setFixedWidth(340);
+
+    //Run the query again whenever a control changes
+    QObject::connect(columnCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    QObject::connect(orderCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    QObject::connect(countSpin, SIGNAL(valueChanged(int)), this, SLOT(refresh()));
+    QObject::connect(searchEdit, SIGNAL(textChanged(QString)), this, SLOT(refresh()));
+}
+
+void TopGamesPanel::setData(std::shared_ptr<const SteamGameTable> table, std::shared_ptr<const GameIndex> index,
+                            const RowSelection *selection)
+{
+    m_table = table;
+    m_index = index;
+    m_selection = selection;
+    refresh();
+}
+
+void TopGamesPanel::refresh(void)
+{
+    if (!m_table || !m_index)
+        return;
+
+    ScopedTimer timer("topGames");
+
+    GameColumn column = static_cast<GameColumn>(columnCombo->currentIndex());
+    std::size_t count = static_cast<std::size_t>(countSpin->value());
+
+    //Percentiles of the selected games
+    QString percentiles;
+    for (std::size_t i = 0; i < sizeof(kPercentiles) / sizeof(kPercentiles[0]); ++i) {
+        double value = m_index->percentile(*m_table, column, kPercentiles[i], m_selection);
+        percentiles += QString(i ? "   " : "") + kPercentileNames[i] + ": " + formatValue(column, value);
+    }
+    percentileLabel->setText(percentiles);
+
+    //Games whose name contains the search text, or the top games by the column
+    QString search = searchEdit->text().trimmed();
+    if (!search.isEmpty())
+        m_index->findName(*m_table, search.toStdString(), count, m_selection, m_rows);
+    else
+        m_index->topRows(*m_table, column, count, orderCombo->currentIndex() == 0, m_selection, m_rows);
+
+    gamesTable->setHorizontalHeaderItem(2, new QTableWidgetItem(gameColumnName(column)));
+    gamesTable->setRowCount(static_cast<int>(m_rows.size()));
+    for (std::size_t i = 0; i < m_rows.size(); ++i) {
+        int row = static_cast<int>(i);
+        QTableWidgetItem *value = new QTableWidgetItem(formatValue(column, m_table->value(column, m_rows[i])));
+        value->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+        gamesTable->setItem(row, 0, new QTableWidgetItem(QString::number(i + 1)));
+        gamesTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(m_table->gameName(m_rows[i]))));
+        gamesTable->setItem(row, 2, value);
+    }
+}
+
+QString TopGamesPanel::formatValue(GameColumn column, double value)
+{
+    if (std::isnan(value))
+        return "N/A";
+
+    switch (column)
+    {
+        case GameColumn::Price:
+            return "$" + QString::number(value, 'f', 2);
+        case GameColumn::Userscore:
+        case GameColumn::Metascore:
+            return QString::number(value, 'f', 0) + "%";
+        case GameColumn::Playtime:
+        case GameColumn::MedianPlaytime: {
+            //Minutes, shown as hours and minutes like SteamSpy does
+            long minutes = std::lround(value);
+            return QString("%1:%2").arg(minutes / 60).arg(minutes % 60, 2, 10, QChar('0'));
+        }
+        case GameColumn::Owners:
+        case GameColumn::OwnersError:
+            break;
+    }
+
+    return QString::number(value, 'f', 0);
+}
@@ -0,0 +1,59 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Table of the top games of the selected year by any column, their percentiles, and a name search
+//
+// Author: Francois Stelluti
+//
+
+#ifndef TopGamesPanel_H
+#define TopGamesPanel_H
+
+#include "GameFilter.h"
+#include "GameIndex.h"
+#include "SteamGameTable.h"
+
+#include <QComboBox>
+#include <QGroupBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QTableWidget>
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+//Every query is answered from the index of the year, so changing a control never goes through the table
+class TopGamesPanel : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    explicit TopGamesPanel(QWidget *parent = 0);
+
+    //Show the games of a year, only those in the selection if there is one.
+    //The selection must stay valid until the next call
+    void setData(std::shared_ptr<const SteamGameTable> table, std::shared_ptr<const GameIndex> index,
+                 const RowSelection *selection);
+
+    //Value of a column as SteamSpy shows it, N/A for a missing value
+    static QString formatValue(GameColumn column, double value);
+
+private slots:
+    void refresh(void);             //Run the query of the controls and fill the table
+
+private:
+    std::shared_ptr<const SteamGameTable> m_table;
+    std::shared_ptr<const GameIndex> m_index;
+    const RowSelection *m_selection;
+    std::vector<uint32_t> m_rows;   //Rows shown, kept between queries
+
+    QComboBox *columnCombo;         //In the same order as GameColumn
+    QComboBox *orderCombo;          //Highest or lowest values first
+    QSpinBox *countSpin;
+    QLineEdit *searchEdit;          //When not empty, the games whose name contains it are shown instead
+    QLabel *percentileLabel;
+    QTableWidget *gamesTable;
+};
+
+#endif
@@ -0,0 +1,142 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window showing how the statistics of the games change from year to year
+//
+// Author: Francois Stelluti
+//
+
+#include "TrendsView.h"
+
+#include <QGridLayout>
+#include <QPainter>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+
+TrendChart::TrendChart(const QString &title, QWidget *parent) : QWidget(parent), m_title(title)
+{
+    setMinimumSize(220, 160);
+}
+
+void TrendChart::setSeries(const std::vector<int> &years, const std::vector<double> &values)
+{
+    m_years = years;
+    m_values = values;
+    update();
+}
+
+void TrendChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+
+    int lineHeight = fontMetrics().height();
+    painter.drawText(QRect(0, 0, width(), lineHeight + 4), Qt::AlignCenter, m_title);
+
+    //Range of the values, ignoring years where the statistic isn't available
+    double lo = 0.0, hi = 0.0;
+    bool any = false;
+    for (std::size_t i = 0; i < m_values.size(); ++i) {
+        if (std::isnan(m_values[i]))
+            continue;
+        lo = any ? std::min(lo, m_values[i]) : m_values[i];
+        hi = any ? std::max(hi, m_values[i]) : m_values[i];
+        any = true;
+    }
+    if (!any)
+        return;
+    if (hi <= lo) {
+        lo -= 1.0;
+        hi += 1.0;
+    }
+
+    QRect panel = rect().adjusted(10, lineHeight + 8, -10, -lineHeight - 6);
+    painter.fillRect(panel, QColor(235, 235, 235));
+
+    //Evenly spaced years, so that a missing year shows as a gap in the x axis labels
+    std::size_t n = m_years.size();
+    std::vector<QPointF> points(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double fx = n > 1 ? double(i) / (n - 1) : 0.5;
+        double fy = std::isnan(m_values[i]) ? 0.0 : (m_values[i] - lo) / (hi - lo);
+        points[i] = QPointF(panel.left() + 20 + fx * (panel.width() - 40), panel.bottom() - 10 - fy * (panel.height() - 30));
+        painter.drawText(QRectF(points[i].x() - 30, panel.bottom() + 2, 60, lineHeight), Qt::AlignCenter,
+                         QString::number(m_years[i]));
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen(QColor(51, 102, 255), 2.0));
+    for (std::size_t i = 1; i < n; ++i)
+        if (!std::isnan(m_values[i - 1]) && !std::isnan(m_values[i]))
+            painter.drawLine(points[i - 1], points[i]);
+
+    //Points, labelled with their value
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::isnan(m_values[i]))
+            continue;
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(51, 102, 255));
+        painter.drawEllipse(points[i], 3.0, 3.0);
+        painter.setPen(Qt::black);
+        painter.drawText(QRectF(points[i].x() - 50, points[i].y() - lineHeight - 4, 100, lineHeight),
+                         Qt::AlignCenter, QString::number(m_values[i], 'g', 6));
+    }
+}
+
+TrendsView::TrendsView(QWidget *parent) : QWidget(parent)
+{
+    setWindowTitle("Trends");
+
+    avgPriceChart = new TrendChart("Average Price");
+    maxPriceChart = new TrendChart("Maximum Price");
+    avgMetascoreChart = new TrendChart("Average Metascore");
+    totalPlaytimeChart = new TrendChart("Total Playtime (hours)");
+    totalOwnersChart = new TrendChart("Total Owners");
+    numGamesChart = new TrendChart("Number of Games");
+    combinedLabel = new QLabel();
+
+    QGridLayout *charts = new QGridLayout();
+    charts->addWidget(avgPriceChart, 0, 0);
+    charts->addWidget(maxPriceChart, 0, 1);
+    charts->addWidget(avgMetascoreChart, 0, 2);
+    charts->addWidget(totalPlaytimeChart, 1, 0);
+    charts->addWidget(totalOwnersChart, 1, 1);
+    charts->addWidget(numGamesChart, 1, 2);
+
+    QVBoxLayout *outer = new QVBoxLayout();
+    outer->addLayout(charts);
+    outer->addWidget(combinedLabel);
+    setLayout(outer);
+}
+
+void TrendsView::setTrends(const YearTrends &trends)
+{
+    std::vector<YearTrend> years = trends.trends();
+
+    std::vector<int> labels;
+    std::vector<double> avgPrice, maxPrice, avgMetascore, totalPlaytime, totalOwners, numGames;
+    for (std::size_t i = 0; i < years.size(); ++i) {
+        labels.push_back(years[i].year);
+        avgPrice.push_back(years[i].stats.avgPrice);
+        maxPrice.push_back(years[i].stats.maxPrice);
+        avgMetascore.push_back(years[i].stats.avgMetascore);
+        totalPlaytime.push_back(years[i].stats.totalPlaytime);
+        totalOwners.push_back(years[i].totalOwners);
+        numGames.push_back(years[i].stats.numGames);
+    }
+
+    avgPriceChart->setSeries(labels, avgPrice);
+    maxPriceChart->setSeries(labels, maxPrice);
+    avgMetascoreChart->setSeries(labels, avgMetascore);
+    totalPlaytimeChart->setSeries(labels, totalPlaytime);
+    totalOwnersChart->setSeries(labels, totalOwners);
+    numGamesChart->setSeries(labels, numGames);
+
+    //Every year together, from the merged summaries
+    YearStats all = computeYearStats(trends.combined());
+    combinedLabel->setText(QString("All years: %1 games, average price %2, maximum price %3, average Metascore %4, "
+                                   "total playtime %5 hours")
+                           .arg(all.numGames).arg(all.avgPrice).arg(all.maxPrice).arg(all.avgMetascore)
+                           .arg(all.totalPlaytime, 0, 'f', 2));
+}
@@ -0,0 +1,53 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Window showing how the statistics of the games change from year to year
+//
+// Author: Francois Stelluti
+//
+
+#ifndef TrendsView_H
+#define TrendsView_H
+
+#include "YearTrends.h"
+
+#include <QLabel>
+#include <QString>
+#include <QWidget>
+
+#include <vector>
+
+//Line chart of one statistic against the year
+class TrendChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TrendChart(const QString &title, QWidget *parent = 0);
+
+    void setSeries(const std::vector<int> &years, const std::vector<double> &values);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    QString m_title;
+    std::vector<int> m_years;
+    std::vector<double> m_values;
+};
+
+class TrendsView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TrendsView(QWidget *parent = 0);
+
+    void setTrends(const YearTrends &trends);
+
+private:
+    TrendChart *avgPriceChart, *maxPriceChart, *avgMetascoreChart;
+    TrendChart *totalPlaytimeChart, *totalOwnersChart, *numGamesChart;
+    QLabel *combinedLabel;          //Statistics of all the years together
+};
+
+#endif
@@ -0,0 +1,21 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Summary statistics shown in the 'Game Stats' panel for one year of data
+//
+// Author: Francois Stelluti
+//
+
+#include "YearStats.h"
+
+YearStats computeYearStats(const TableSummary &summary)
+{
+    //Store the results, rounded to 2 decimal places
+    YearStats stats;
+    stats.numGames = static_cast<int>(summary.rows);
+    stats.avgPrice = roundTo(summary[GameColumn::Price].mean(), 2);
+    stats.maxPrice = roundTo(summary[GameColumn::Price].max, 2);
+    stats.avgMetascore = roundTo(summary[GameColumn::Metascore].mean(), 2);    //N/A's are ignored
+    stats.totalPlaytime = roundTo(summary[GameColumn::Playtime].sum / 60.0, 2);    //Playtime is stored in minutes
+
+    return stats;
+}
@@ -0,0 +1,26 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Summary statistics shown in the 'Game Stats' panel for one year of data
+//
+// Author: Francois Stelluti
+//
+
+#ifndef YearStats_H
+#define YearStats_H
+
+#include "SummaryStats.h"
+
+//All values are rounded to 2 decimal places, as displayed
+struct YearStats
+{
+    int numGames;           // Number of games
+    double avgPrice;        // Average price of all games
+    double maxPrice;        // Max price of all games
+    double avgMetascore;    // Average Metascore, ignoring N/A's
+    double totalPlaytime;   // Total playtime of all games (in hours)
+};
+
+//Get the displayed statistics from the summary of the table
+YearStats computeYearStats(const TableSummary &summary);
+
+#endif
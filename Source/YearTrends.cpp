@@ -0,0 +1,56 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Statistics of every year of data, combined from per-year partial summaries
+//
+// Author: Francois Stelluti
+//
+
+#include "YearTrends.h"
+
+YearTrend computeYearTrend(int year, const TableSummary &summary)
+{
+    YearTrend trend;
+    trend.year = year;
+    trend.stats = computeYearStats(summary);
+    trend.totalOwners = summary[GameColumn::Owners].sum;
+    trend.avgOwners = roundTo(summary[GameColumn::Owners].mean(), 2);
+    return trend;
+}
+
+YearTrends::YearTrends() : m_combined(emptySummary())
+{
+}
+
+bool YearTrends::hasYear(int year) const
+{
+    return m_years.count(year) > 0;
+}
+
+void YearTrends::addYear(int year, const TableSummary &summary)
+{
+    bool replaced = hasYear(year);
+    m_years[year] = summary;
+
+    if (!replaced) {
+        m_combined.merge(summary);
+        return;
+    }
+
+    //A summary can't be taken out of a merge, so merge the stored summaries again. The tables aren't needed
+    m_combined = emptySummary();
+    for (std::map<int, TableSummary>::const_iterator it = m_years.begin(); it != m_years.end(); ++it)
+        m_combined.merge(it->second);
+}
+
+std::vector<YearTrend> YearTrends::trends() const
+{
+    std::vector<YearTrend> trends;
+    for (std::map<int, TableSummary>::const_iterator it = m_years.begin(); it != m_years.end(); ++it)
+        trends.push_back(computeYearTrend(it->first, it->second));
+    return trends;
+}
+
+const TableSummary &YearTrends::combined() const
+{
+    return m_combined;
+}
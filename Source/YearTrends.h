@@ -0,0 +1,46 @@
+//
+// A C++ GUI application that analyses and displays gaming statistics from Steam using R and Rinside
+// Statistics of every year of data, combined from per-year partial summaries
+//
+// Author: Francois Stelluti
+//
+
+#ifndef YearTrends_H
+#define YearTrends_H
+
+#include "SummaryStats.h"
+#include "YearStats.h"
+
+#include <map>
+#include <vector>
+
+//Statistics of one year, as shown in the trends view
+struct YearTrend
+{
+    int year;
+    YearStats stats;
+    double totalOwners;     //Sum of the owner estimates
+    double avgOwners;       //Average owners per game
+};
+
+YearTrend computeYearTrend(int year, const TableSummary &summary);
+
+//Keeps the summary of each year, and the merge of all of them. Adding a year only merges its summary
+//into the combined one, no other year is summarized again
+class YearTrends
+{
+public:
+    YearTrends();
+
+    bool hasYear(int year) const;
+    void addYear(int year, const TableSummary &summary);    //Replaces the year if it was already added
+
+    std::vector<YearTrend> trends() const;                  //In increasing year order
+    const TableSummary &combined() const;                   //Summary of every year together
+
+private:
+    std::map<int, TableSummary> m_years;
+    TableSummary m_combined;
+};
+
+#endif
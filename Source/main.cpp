@@ -9,13 +9,66 @@
 
 #include <QApplication>
 #include "SteamGameStats.h"
+#include "BatchMode.h"
+#include "PerfTrace.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+//File to write the Chrome trace to, from --trace=<file>, --trace <file> or STEAMSTATS_TRACE.
+//--perf-overlay only shows the timings in the window
+std::string traceFile(int argc, char *argv[], bool &enabled)
+{
+    enabled = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--trace=", 8) == 0) {
+            enabled = true;
+            return argv[i] + 8;
+        }
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            enabled = true;
+            return argv[i + 1];
+        }
+        if (std::strcmp(argv[i], "--perf-overlay") == 0)
+            enabled = true;
+    }
+
+    const char *env = std::getenv("STEAMSTATS_TRACE");
+    if (env && *env) {
+        enabled = true;
+        return env;
+    }
+    return std::string();
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
-    RInside R(argc, argv);  		// create an embedded R instance
+    //Batch mode needs neither a window nor R
+    if (isBatchMode(argc, argv))
+        return runBatch(argc, argv);
+
+    //Timings are only recorded when asked for, so that they cost nothing otherwise
+    bool tracing = false;
+    std::string trace = traceFile(argc, argv, tracing);
+    PerfTrace::global().setEnabled(tracing);
+    PerfTrace::global().setThreadName("GUI");
+
+    RWorker R(argc, argv);  		// create an embedded R instance, on its own thread
+    R.start();
 
     QApplication app(argc, argv);
-    SteamGameStats steamGameStats(R);		// pass R instance by reference
+    SteamGameStats steamGameStats(R);		// pass R thread by reference
+
+    int result = app.exec();
+    R.stop();
 
-    return app.exec();
+    if (!trace.empty() && !PerfTrace::global().writeChromeTrace(trace))
+        std::cout << "Unable to write the trace to " << trace << std::endl;
+    return result;
 }